@@ -0,0 +1,297 @@
+#include "BarnesHut.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  //21 bits per axis in a Morton code
+  const int maxLevel = 21;
+
+  const unsigned long walkChunkSize = 256;
+  const unsigned long sortChunkSize = 1 << 14;
+}
+
+const std::uint32_t BarnesHut::leafCapacity;
+
+BarnesHut::BarnesHut(ThreadPool & threadPool, float openingAngle, float softening):
+  threadPool_ (threadPool),
+  openingAngle_ {openingAngle},
+  softening_ {softening},
+  interactionsCount_ {0}
+  {
+  }
+
+  void BarnesHut::accelerations(Bodies & bodies)
+  {
+    interactionsCount_ = 0;
+    if (bodies.size() == 0)
+    {
+      return;
+    }
+
+    build(bodies);
+
+    const float theta2 = openingAngle_ * openingAngle_;
+    const float epsilon2 = softening_ * softening_;
+    std::atomic<unsigned long long> interactionsCount {0};
+
+    threadPool_.parallelFor(codes_.size(), walkChunkSize, [&] (unsigned long begin, unsigned long end, unsigned long) {
+      unsigned long long interactions = 0;
+
+      //The deepest walk keeps at most 7 siblings per level
+      std::uint32_t stack[8 * (maxLevel + 1)];
+
+      for (unsigned long i=begin; i < end; i++)
+      {
+        const float px = x_[i];
+        const float py = y_[i];
+        const float pz = z_[i];
+        float ax = 0;
+        float ay = 0;
+        float az = 0;
+
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0)
+        {
+          const Node & node = nodes_[stack[--top]];
+
+          float dx = node.centerOfMass[0] - px;
+          float dy = node.centerOfMass[1] - py;
+          float dz = node.centerOfMass[2] - pz;
+          float distance2 = dx * dx + dy * dy + dz * dz;
+
+          if (node.size * node.size < theta2 * distance2 && (i < node.begin || i >= node.end))
+          {
+            //Far enough: the whole node at its centre of mass
+            float r2 = distance2 + epsilon2;
+            float inverse = 1 / std::sqrt(r2);
+            float s = node.mass * inverse * inverse * inverse;
+            ax += s * dx;
+            ay += s * dy;
+            az += s * dz;
+            interactions++;
+          }
+          else if (node.childrenCount == 0)
+          {
+            for (std::uint32_t j=node.begin; j < node.end; j++)
+            {
+              if (j == i)
+              {
+                continue;
+              }
+
+              float ex = x_[j] - px;
+              float ey = y_[j] - py;
+              float ez = z_[j] - pz;
+              float r2 = ex * ex + ey * ey + ez * ez + epsilon2;
+              float inverse = 1 / std::sqrt(r2);
+              float s = mass_[j] * inverse * inverse * inverse;
+              ax += s * ex;
+              ay += s * ey;
+              az += s * ez;
+            }
+            interactions += node.end - node.begin;
+          }
+          else
+          {
+            for (std::uint32_t c=0; c < node.childrenCount; c++)
+            {
+              stack[top++] = node.firstChild + c;
+            }
+          }
+        }
+
+        std::uint32_t body = codes_[i].second;
+        bodies.ax[body] = ax;
+        bodies.ay[body] = ay;
+        bodies.az[body] = az;
+      }
+
+      interactionsCount += interactions;
+    });
+
+    interactionsCount_ = interactionsCount;
+  }
+
+  void BarnesHut::build(Bodies const & bodies)
+  {
+    const unsigned long n = bodies.size();
+    assert(n <= std::numeric_limits<std::uint32_t>::max());
+
+    //Bounding cube, reduced per chunk
+    const unsigned long chunksCount = (n + sortChunkSize - 1) / sortChunkSize;
+    std::vector<float> chunkBounds(6 * chunksCount);
+    threadPool_.parallelFor(n, sortChunkSize, [&] (unsigned long begin, unsigned long end, unsigned long chunk) {
+      float* bounds = &chunkBounds[6 * chunk];
+      bounds[0] = bounds[3] = bodies.x[begin];
+      bounds[1] = bounds[4] = bodies.y[begin];
+      bounds[2] = bounds[5] = bodies.z[begin];
+      for (unsigned long i=begin; i < end; i++)
+      {
+        bounds[0] = std::min(bounds[0], bodies.x[i]);
+        bounds[1] = std::min(bounds[1], bodies.y[i]);
+        bounds[2] = std::min(bounds[2], bodies.z[i]);
+        bounds[3] = std::max(bounds[3], bodies.x[i]);
+        bounds[4] = std::max(bounds[4], bodies.y[i]);
+        bounds[5] = std::max(bounds[5], bodies.z[i]);
+      }
+    });
+
+    float lower[3];
+    float upper[3];
+    for (int axis=0; axis < 3; axis++)
+    {
+      lower[axis] = chunkBounds[axis];
+      upper[axis] = chunkBounds[3 + axis];
+      for (unsigned long chunk=1; chunk < chunksCount; chunk++)
+      {
+        lower[axis] = std::min(lower[axis], chunkBounds[6 * chunk + axis]);
+        upper[axis] = std::max(upper[axis], chunkBounds[6 * chunk + 3 + axis]);
+      }
+    }
+
+    float rootSize = std::max(std::max(upper[0] - lower[0], upper[1] - lower[1]), upper[2] - lower[2]);
+    rootSize = std::max(rootSize, std::numeric_limits<float>::min());
+
+    //Morton codes on 21 bits per axis
+    const float scale = ((1 << maxLevel) - 1) / rootSize;
+    codes_.resize(n);
+    threadPool_.parallelFor(n, sortChunkSize, [&] (unsigned long begin, unsigned long end, unsigned long) {
+      for (unsigned long i=begin; i < end; i++)
+      {
+        int qx = static_cast<int>((bodies.x[i] - lower[0]) * scale);
+        int qy = static_cast<int>((bodies.y[i] - lower[1]) * scale);
+        int qz = static_cast<int>((bodies.z[i] - lower[2]) * scale);
+        codes_[i] = std::make_pair(Morton::encode(qx, qy, qz), static_cast<std::uint32_t>(i));
+      }
+    });
+
+    std::sort(codes_.begin(), codes_.end());
+
+    x_.resize(n);
+    y_.resize(n);
+    z_.resize(n);
+    mass_.resize(n);
+    threadPool_.parallelFor(n, sortChunkSize, [&] (unsigned long begin, unsigned long end, unsigned long) {
+      for (unsigned long i=begin; i < end; i++)
+      {
+        std::uint32_t body = codes_[i].second;
+        x_[i] = bodies.x[body];
+        y_[i] = bodies.y[body];
+        z_[i] = bodies.z[body];
+        mass_[i] = bodies.mass[body];
+      }
+    });
+
+    nodes_.clear();
+    nodes_.resize(1);
+    buildNode(0, 0, n, 0, rootSize);
+  }
+
+  void BarnesHut::buildNode(std::uint32_t index, std::uint32_t begin, std::uint32_t end, int level, float size)
+  {
+    if (end - begin <= leafCapacity || level == maxLevel)
+    {
+      Node & node = nodes_[index];
+      node.size = size;
+      node.firstChild = 0;
+      node.childrenCount = 0;
+      node.begin = begin;
+      node.end = end;
+
+      double mass = 0;
+      double center[3] = {0, 0, 0};
+      for (std::uint32_t i=begin; i < end; i++)
+      {
+        mass += mass_[i];
+        center[0] += double(mass_[i]) * x_[i];
+        center[1] += double(mass_[i]) * y_[i];
+        center[2] += double(mass_[i]) * z_[i];
+      }
+
+      node.mass = mass;
+      for (int axis=0; axis < 3; axis++)
+      {
+        node.centerOfMass[axis] = mass > 0 ? center[axis] / mass : 0;
+      }
+      return;
+    }
+
+    //The bodies are sorted, so the octant of the level, 3 bits of the code, splits the range in up to 8 ranges
+    const int shift = 3 * (maxLevel - 1 - level);
+    std::uint32_t bounds[9];
+    std::uint32_t childrenCount = 0;
+    std::uint32_t first = begin;
+    while (first < end)
+    {
+      Morton::Code octant = codes_[first].first >> shift & 7;
+      auto last = std::partition_point(codes_.begin() + first, codes_.begin() + end,
+      [shift, octant] (std::pair<Morton::Code, std::uint32_t> const & code) { return (code.first >> shift & 7) == octant; });
+
+      bounds[childrenCount++] = first;
+      first = last - codes_.begin();
+    }
+    bounds[childrenCount] = end;
+
+    //The children are consecutive; the array may grow, so the node is only accessed by index
+    const std::uint32_t firstChild = nodes_.size();
+    nodes_.resize(nodes_.size() + childrenCount);
+
+    double mass = 0;
+    double center[3] = {0, 0, 0};
+    for (std::uint32_t c=0; c < childrenCount; c++)
+    {
+      buildNode(firstChild + c, bounds[c], bounds[c + 1], level + 1, size / 2);
+
+      const Node & child = nodes_[firstChild + c];
+      mass += child.mass;
+      for (int axis=0; axis < 3; axis++)
+      {
+        center[axis] += double(child.mass) * child.centerOfMass[axis];
+      }
+    }
+
+    Node & node = nodes_[index];
+    node.size = size;
+    node.firstChild = firstChild;
+    node.childrenCount = childrenCount;
+    node.begin = begin;
+    node.end = end;
+    node.mass = mass;
+    for (int axis=0; axis < 3; axis++)
+    {
+      node.centerOfMass[axis] = mass > 0 ? center[axis] / mass : 0;
+    }
+  }
+
+  unsigned long long BarnesHut::interactionsCount() const
+  {
+    return interactionsCount_;
+  }
+
+  std::string BarnesHut::name() const
+  {
+    return "Barnes-Hut";
+  }
+
+  float BarnesHut::openingAngle() const
+  {
+    return openingAngle_;
+  }
+
+  void BarnesHut::setOpeningAngle(float openingAngle)
+  {
+    openingAngle_ = openingAngle;
+  }
+
+  unsigned long BarnesHut::nodesCount() const
+  {
+    return nodes_.size();
+  }
@@ -0,0 +1,113 @@
+#ifndef BARNESHUT_H
+#define BARNESHUT_H
+
+/** @file
+* @brief Barnes-Hut gravity solver
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include "NBody.h"
+#include "Include/Octree/morton.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+* @brief The BarnesHut class
+* @details Computes the accelerations in O(N log N). The bodies are sorted in Morton order inside their bounding cube
+* and an octree is built over the sorted array: each node covers a range of bodies and caches their total mass and
+* centre of mass. A node seen from a body under an angle smaller than the opening angle (size / distance < theta) acts
+* as a single body at its centre of mass, else its children are opened; the leaves, of a few bodies, are summed
+* directly. The tree is rebuilt at every call, the bodies having moved.
+* Units: G = 1. The interactions are softened, 1 / (r^2 + epsilon^2)^(3/2), so that close encounters do not blow up.
+* The tree is a pointer free array of nodes, unlike Octree: the bodies move continuously and the nodes need their
+* aggregates, not a value per cell. The walks of the bodies are split on the thread pool, in Morton order so that
+* neighbouring bodies, which open the same nodes, run on the same thread.
+*/
+class BarnesHut : public GravitySolver
+{
+public:
+  /**
+  * @param threadPool The threads the tree walks are split on
+  * @param openingAngle theta: 0 is the exact sum, 0.5 is the usual tradeoff, above 1 the error grows fast
+  * @param softening epsilon, in length units
+  */
+  BarnesHut(ThreadPool & threadPool, float openingAngle = 0.5f, float softening = 0.05f);
+
+  void accelerations(Bodies & bodies);
+
+  unsigned long long interactionsCount() const;
+
+  std::string name() const;
+
+  float openingAngle() const;
+  void setOpeningAngle(float openingAngle);
+
+  /**
+  * @brief Gives the number of nodes of the last tree
+  */
+  unsigned long nodesCount() const;
+
+private:
+  /**
+  * @brief A node of the tree
+  * @details The children of a node are consecutive in the array. A leaf has no children and covers at most
+  * leafCapacity bodies, or bodies which share a Morton code.
+  */
+  struct Node
+  {
+    float centerOfMass[3];
+    float mass;
+
+    /**
+    * @brief The edge of the cube of the node
+    */
+    float size;
+
+    std::uint32_t firstChild;
+    std::uint32_t childrenCount;
+
+    /**
+    * @brief The range of the node in the sorted bodies
+    */
+    std::uint32_t begin;
+    std::uint32_t end;
+  };
+
+  static const std::uint32_t leafCapacity = 8;
+
+  /**
+  * @brief Sorts the bodies in Morton order and builds the tree
+  */
+  void build(Bodies const & bodies);
+
+  /**
+  * @brief Fills the given node with the bodies [begin, end) and builds its subtree
+  * @param level The depth of the node, the root is 0
+  */
+  void buildNode(std::uint32_t index, std::uint32_t begin, std::uint32_t end, int level, float size);
+
+  ThreadPool & threadPool_;
+
+  float openingAngle_;
+  float softening_;
+
+  std::vector<Node> nodes_;
+
+  /**
+  * @brief The Morton codes of the bodies in their bounding cube with their index, sorted
+  */
+  std::vector<std::pair<Morton::Code, std::uint32_t>> codes_;
+
+  /**
+  * @brief The positions and masses of the bodies in Morton order, for locality in the leaves
+  */
+  std::vector<float> x_, y_, z_, mass_;
+
+  unsigned long long interactionsCount_;
+};
+
+#endif // BARNESHUT_H
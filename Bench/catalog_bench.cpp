@@ -0,0 +1,179 @@
+/** @file
+* @brief Throughput of the CSV star catalog loading
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+* @details Usage: catalog_bench [file.csv] [--rows=N] [--threads=T] [--min_time=seconds]
+* Loads the given catalog, or else a synthetic one of N rows (2000000 by default) laid out like an export of the Gaia
+* archive, written to catalog_bench.csv, repeating the loading for at least the given time. Prints the throughput in
+* MB/s and in stars per second and, for the synthetic catalog, the largest relative error of the positions against a
+* conversion in double precision.
+*/
+
+#include "StarCatalog.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+  * @brief Writes a synthetic catalog: every 20th parallax is missing and every 50th magnitude
+  * @return The expected positions, 3 per star, in the order of the file
+  */
+  std::vector<double> writeCatalog(std::string const & file, unsigned long rowsCount)
+  {
+    const double degree = 3.14159265358979323846 / 180;
+
+    std::FILE* out = std::fopen(file.c_str(), "w");
+    if (!out)
+    {
+      throw std::runtime_error("catalog_bench: cannot write " + file);
+    }
+
+    std::mt19937_64 generator(rowsCount);
+    std::uniform_real_distribution<double> ra(0, 360);
+    std::uniform_real_distribution<double> sinDec(-1, 1);
+    std::lognormal_distribution<double> parallax(0, 1);
+    std::normal_distribution<double> magnitude(17, 2);
+
+    std::vector<double> expected;
+    expected.reserve(3 * rowsCount);
+
+    std::fprintf(out, "source_id,ra,dec,parallax,parallax_error,pmra,pmdec,phot_g_mean_mag\n");
+    for (unsigned long i=0; i < rowsCount; i++)
+    {
+      double a = ra(generator);
+      double d = std::asin(sinDec(generator)) / degree;
+      double p = parallax(generator);
+      double m = magnitude(generator);
+
+      std::fprintf(out, "%lu,%.15f,%.15f,", 4295806720ul + 7 * i, a, d);
+      if (i % 20 == 19)
+      {
+        std::fprintf(out, ",");
+      }
+      else
+      {
+        std::fprintf(out, "%.16g,", p);
+        double distance = 1000 / p;
+        expected.push_back(distance * std::cos(d * degree) * std::sin(a * degree));
+        expected.push_back(distance * std::sin(d * degree));
+        expected.push_back(distance * std::cos(d * degree) * std::cos(a * degree));
+      }
+      std::fprintf(out, "%.6g,%.6g,%.6g,", 0.01 * p, a - 180, d);
+      if (i % 50 != 49)
+      {
+        std::fprintf(out, "%.6f", m);
+      }
+      std::fprintf(out, "\n");
+    }
+
+    std::fclose(out);
+    return expected;
+  }
+
+  double maxRelativeError(Stars const & stars, std::vector<double> const & expected)
+  {
+    if (stars.size() * 3 != expected.size())
+    {
+      return INFINITY;
+    }
+
+    double maxError = 0;
+    for (unsigned long i=0; i < stars.size(); i++)
+    {
+      double ex = stars.x[i] - expected[3 * i];
+      double ey = stars.y[i] - expected[3 * i + 1];
+      double ez = stars.z[i] - expected[3 * i + 2];
+      double norm = std::sqrt(expected[3 * i] * expected[3 * i] + expected[3 * i + 1] * expected[3 * i + 1]
+      + expected[3 * i + 2] * expected[3 * i + 2]);
+      maxError = std::max(maxError, std::sqrt(ex * ex + ey * ey + ez * ez) / norm);
+    }
+
+    return maxError;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::string file;
+  unsigned long rowsCount = 2000000;
+  unsigned threadsCount = 0;
+  double minTime = 2;
+
+  for (int i=1; i < argc; i++)
+  {
+    if (std::strncmp(argv[i], "--rows=", 7) == 0)
+    {
+      rowsCount = std::strtoul(argv[i] + 7, nullptr, 10);
+    }
+    else if (std::strncmp(argv[i], "--threads=", 10) == 0)
+    {
+      threadsCount = std::strtoul(argv[i] + 10, nullptr, 10);
+    }
+    else if (std::strncmp(argv[i], "--min_time=", 11) == 0)
+    {
+      minTime = std::atof(argv[i] + 11);
+    }
+    else
+    {
+      file = argv[i];
+    }
+  }
+
+  std::vector<double> expected;
+  if (file.empty())
+  {
+    file = "catalog_bench.csv";
+    expected = writeCatalog(file, rowsCount);
+  }
+
+  ThreadPool threadPool(threadsCount);
+
+  unsigned long loadsCount = 0;
+  double elapsed = 0;
+  double error = 0;
+  auto start = Clock::now();
+  while (elapsed < minTime || loadsCount == 0)
+  {
+    StarCatalog catalog(file, threadPool);
+    loadsCount++;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (loadsCount == 1)
+    {
+      std::printf("%s: %.1f MB, %lu rows, %lu stars, %lu rows skipped\n", file.c_str(), catalog.fileBytes() / 1e6,
+      catalog.rowsCount(), catalog.stars().size(), catalog.skippedRowsCount());
+      if (!expected.empty())
+      {
+        error = maxRelativeError(catalog.stars(), expected);
+      }
+    }
+
+    if (elapsed >= minTime)
+    {
+      double seconds = elapsed / loadsCount;
+      std::printf("%u threads: %10.3f ms %10.1f MB/s %10.2f Mstars/s", threadPool.threadsCount(), 1e3 * seconds,
+      catalog.fileBytes() / seconds / 1e6, catalog.stars().size() / seconds / 1e6);
+      if (!expected.empty())
+      {
+        std::printf(" %10.2e max relative error", error);
+      }
+      std::printf("\n");
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/** @file
+* @brief Round trip of an octree through Octree::writeBinary() and MappedOctree::convertBinary()
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+* @details Usage: mapped_octree_check [size] [points] [lookups]
+* Fills an octree with random points for the aggregate sizes 1 and 2, writes it with Octree::writeBinary(), converts
+* it to mapped_octree_check.bin with MappedOctree::convertBinary() and maps the file. Checks that the file is the one
+* MappedOctree::write() gives, then compares at() on every point and on random indices, and visitBox() on random boxes,
+* against the source octree. Returns 1 on the first mismatch.
+*/
+
+#include "Octree/mappedoctree.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+typedef std::vector<std::tuple<int, int, int, int>> Cells;
+
+template <typename Tree>
+static Cells visitBox(Tree const & tree, int x0, int y0, int z0, int x1, int y1, int z1)
+{
+  Cells cells;
+  tree.visitBox(x0, y0, z0, x1, y1, z1, [&cells] (int x, int y, int z, int value)
+  {
+    cells.emplace_back(x, y, z, value);
+  });
+  //The trees do not visit the aggregates in the same order
+  std::sort(cells.begin(), cells.end());
+  return cells;
+}
+
+template <int AS>
+static bool check(int size, unsigned long pointsCount, unsigned long lookupsCount)
+{
+  const std::string file = "mapped_octree_check.bin";
+
+  std::default_random_engine generator(AS);
+  std::uniform_int_distribution<> distribution(0, size - 1);
+
+  Cells points;
+  points.reserve(pointsCount);
+  for (unsigned long i=0; i < pointsCount; i++)
+  {
+    points.emplace_back(distribution(generator), distribution(generator), distribution(generator), i + 1);
+  }
+
+  Octree<int, AS> octree(size);
+  octree.buildFromPoints(points.begin(), points.end());
+
+  std::stringstream binary;
+  octree.writeBinary(binary);
+  {
+    std::ofstream out(file, std::ios::binary);
+    MappedOctree<int, AS>::convertBinary(binary, out);
+    if (!out)
+    {
+      std::cerr << "AS=" << AS << ": cannot write " << file << std::endl;
+      return false;
+    }
+  }
+
+  std::ostringstream written;
+  MappedOctree<int, AS>::write(octree, written);
+  std::ifstream in(file, std::ios::binary);
+  std::string converted((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (converted != written.str())
+  {
+    std::cerr << "AS=" << AS << ": convertBinary() and write() differ" << std::endl;
+    return false;
+  }
+
+  MappedOctree<int, AS> mapped(file);
+  std::cout << "AS=" << AS << ": octree of size " << size << ", " << pointsCount << " points, " << mapped.nodes()
+  << " nodes, " << mapped.bytes() / 1024 << " KiB mapped" << std::endl;
+
+  if (mapped.size() != octree.size() || mapped.emptyValue() != octree.emptyValue())
+  {
+    std::cerr << "AS=" << AS << ": the size or the empty value differs" << std::endl;
+    return false;
+  }
+
+  //Every point, then random indices, mostly empty
+  for (unsigned long i=0; i < pointsCount + lookupsCount; i++)
+  {
+    int x, y, z;
+    if (i < pointsCount)
+    {
+      std::tie(x, y, z, std::ignore) = points[i];
+    }
+    else
+    {
+      x = distribution(generator);
+      y = distribution(generator);
+      z = distribution(generator);
+    }
+
+    if (mapped.at(x, y, z) != octree.at(x, y, z))
+    {
+      std::cerr << "AS=" << AS << ": at(" << x << ", " << y << ", " << z << ") is " << mapped.at(x, y, z)
+      << " instead of " << octree.at(x, y, z) << std::endl;
+      return false;
+    }
+  }
+
+  //The whole tree, then random boxes, empty ones included
+  for (int i=0; i < 64; i++)
+  {
+    int x0 = 0, y0 = 0, z0 = 0, x1 = size, y1 = size, z1 = size;
+    if (i > 0)
+    {
+      std::tie(x0, x1) = std::minmax(distribution(generator), distribution(generator));
+      std::tie(y0, y1) = std::minmax(distribution(generator), distribution(generator));
+      std::tie(z0, z1) = std::minmax(distribution(generator), distribution(generator));
+    }
+
+    if (visitBox(mapped, x0, y0, z0, x1, y1, z1) != visitBox(octree, x0, y0, z0, x1, y1, z1))
+    {
+      std::cerr << "AS=" << AS << ": visitBox(" << x0 << ", " << y0 << ", " << z0 << ", " << x1 << ", " << y1 << ", "
+      << z1 << ") differs" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  int size = argc > 1 ? std::atoi(argv[1]) : 256;
+  unsigned long pointsCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+  unsigned long lookupsCount = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000000;
+
+  try
+  {
+    if (!check<1>(size, pointsCount, lookupsCount) || !check<2>(size, pointsCount, lookupsCount))
+    {
+      return 1;
+    }
+  }
+  catch (std::exception const & exception)
+  {
+    std::cerr << exception.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << "The mapped octrees match their source" << std::endl;
+  return 0;
+}
@@ -0,0 +1,176 @@
+/** @file
+* @brief Throughput and accuracy of the gravity solvers
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+* @details Usage: nbody_bench [bodies...] [--threads=T] [--min_time=seconds]
+* Computes the accelerations of a random cluster of 1024, 4096 and 16384 bodies (by default) with DirectSummation for
+* each instruction set the CPU supports, and with BarnesHut for comparison. One line per solver and number of bodies
+* with the time per call, the interactions per second and the largest relative error of the accelerations against a
+* direct summation in double precision (on the first 512 bodies).
+*/
+
+#include "BarnesHut.h"
+#include "DirectSummation.h"
+#include "NBody.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  const float softening = 0.05f;
+
+  //Bodies checked against the reference
+  const unsigned long checkedCount = 512;
+
+  /**
+  * @brief Generates the bodies: a gaussian cluster of unit radius and unit total mass
+  */
+  Bodies generateBodies(unsigned long bodiesCount)
+  {
+    std::mt19937 generator(bodiesCount);
+    std::normal_distribution<float> position(0, 1);
+
+    Bodies bodies;
+    bodies.resize(bodiesCount);
+    for (unsigned long i=0; i < bodiesCount; i++)
+    {
+      bodies.x[i] = position(generator);
+      bodies.y[i] = position(generator);
+      bodies.z[i] = position(generator);
+      bodies.mass[i] = 1.0f / bodiesCount;
+    }
+
+    return bodies;
+  }
+
+  /**
+  * @brief Computes the accelerations of the first bodies in double precision
+  */
+  std::vector<double> reference(Bodies const & bodies, unsigned long count)
+  {
+    std::vector<double> accelerations(3 * count, 0);
+    for (unsigned long i=0; i < count; i++)
+    {
+      for (unsigned long j=0; j < bodies.size(); j++)
+      {
+        double dx = double(bodies.x[j]) - bodies.x[i];
+        double dy = double(bodies.y[j]) - bodies.y[i];
+        double dz = double(bodies.z[j]) - bodies.z[i];
+        double r2 = dx * dx + dy * dy + dz * dz + double(softening) * softening;
+        double s = bodies.mass[j] / (r2 * std::sqrt(r2));
+        accelerations[3 * i] += s * dx;
+        accelerations[3 * i + 1] += s * dy;
+        accelerations[3 * i + 2] += s * dz;
+      }
+    }
+
+    return accelerations;
+  }
+
+  double maxRelativeError(Bodies const & bodies, std::vector<double> const & expected)
+  {
+    double maxError = 0;
+    for (unsigned long i=0; i < expected.size() / 3; i++)
+    {
+      double ex = bodies.ax[i] - expected[3 * i];
+      double ey = bodies.ay[i] - expected[3 * i + 1];
+      double ez = bodies.az[i] - expected[3 * i + 2];
+      double norm = std::sqrt(expected[3 * i] * expected[3 * i] + expected[3 * i + 1] * expected[3 * i + 1]
+      + expected[3 * i + 2] * expected[3 * i + 2]);
+      maxError = std::max(maxError, std::sqrt(ex * ex + ey * ey + ez * ez) / norm);
+    }
+
+    return maxError;
+  }
+
+  /**
+  * @brief Times the solver on the bodies, repeating the calls for at least the given time
+  */
+  void run(GravitySolver & solver, Bodies & bodies, std::vector<double> const & expected, double minTime)
+  {
+    solver.accelerations(bodies);
+    double error = maxRelativeError(bodies, expected);
+
+    unsigned long callsCount = 0;
+    unsigned long long interactionsCount = 0;
+    double elapsed = 0;
+    auto start = Clock::now();
+    while (elapsed < minTime)
+    {
+      solver.accelerations(bodies);
+      interactionsCount += solver.interactionsCount();
+      callsCount++;
+      elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    std::printf("%-32s %8lu %12.3f ms %10.3f Ginteractions/s %10.2e max relative error\n", solver.name().c_str(),
+    bodies.size(), 1e3 * elapsed / callsCount, interactionsCount / elapsed / 1e9, error);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<unsigned long> sizes;
+  unsigned threadsCount = 0;
+  double minTime = 0.5;
+
+  for (int i=1; i < argc; i++)
+  {
+    if (std::strncmp(argv[i], "--threads=", 10) == 0)
+    {
+      threadsCount = std::strtoul(argv[i] + 10, nullptr, 10);
+    }
+    else if (std::strncmp(argv[i], "--min_time=", 11) == 0)
+    {
+      minTime = std::atof(argv[i] + 11);
+    }
+    else
+    {
+      sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+  }
+
+  if (sizes.empty())
+  {
+    sizes = {1024, 4096, 16384};
+  }
+
+  ThreadPool threadPool(threadsCount);
+  std::printf("%u threads, best instruction set: %s\n", threadPool.threadsCount(),
+  DirectSummation::toString(DirectSummation::bestInstructionSet()).c_str());
+
+  for (unsigned long bodiesCount : sizes)
+  {
+    Bodies bodies = generateBodies(bodiesCount);
+    std::vector<double> expected = reference(bodies, std::min(bodiesCount, checkedCount));
+
+    DirectSummation direct(threadPool, softening);
+    for (DirectSummation::InstructionSet instructionSet : {DirectSummation::Scalar, DirectSummation::AVX2, DirectSummation::AVX512})
+    {
+      if (instructionSet > DirectSummation::bestInstructionSet())
+      {
+        continue;
+      }
+
+      direct.setInstructionSet(instructionSet);
+      run(direct, bodies, expected, minTime);
+    }
+
+    BarnesHut barnesHut(threadPool, 0.5f, softening);
+    run(barnesHut, bodies, expected, minTime);
+  }
+
+  return 0;
+}
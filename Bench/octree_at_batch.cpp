@@ -0,0 +1,101 @@
+/** @file
+* @brief Microbenchmark of Octree::atBatch() against the scalar Octree::at()
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+* @details Usage: octree_at_batch [size] [points] [lookups]
+* Fills an octree with random points and looks up random indices, half of them occupied, with both methods.
+*/
+
+#include "Octree/octree.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double nanoseconds(Clock::duration duration)
+{
+  return std::chrono::duration<double, std::nano>(duration).count();
+}
+
+int main(int argc, char* argv[])
+{
+  int size = argc > 1 ? std::atoi(argv[1]) : 1024;
+  unsigned long pointsCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+  unsigned long lookupsCount = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4000000;
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<> distribution(0, size - 1);
+
+  std::vector<std::tuple<int, int, int, int>> points;
+  points.reserve(pointsCount);
+  for (unsigned long i=0; i < pointsCount; i++)
+  {
+    points.emplace_back(distribution(generator), distribution(generator), distribution(generator), i + 1);
+  }
+
+  Octree<int> octree(size);
+  octree.buildFromPoints(points.begin(), points.end());
+
+  //Half of the lookups hit a point, the other half random indices, mostly empty
+  std::vector<int> xs(lookupsCount);
+  std::vector<int> ys(lookupsCount);
+  std::vector<int> zs(lookupsCount);
+  std::uniform_int_distribution<unsigned long> pointDistribution(0, pointsCount - 1);
+  for (unsigned long i=0; i < lookupsCount; i++)
+  {
+    if (i % 2 && pointsCount)
+    {
+      const auto & point = points[pointDistribution(generator)];
+      xs[i] = std::get<0>(point);
+      ys[i] = std::get<1>(point);
+      zs[i] = std::get<2>(point);
+    }
+    else
+    {
+      xs[i] = distribution(generator);
+      ys[i] = distribution(generator);
+      zs[i] = distribution(generator);
+    }
+  }
+
+  std::cout << "Octree of size " << size << ", " << pointsCount << " points, " << octree.nodes() << " nodes, "
+  << octree.bytes() / (1024 * 1024) << " MiB" << std::endl;
+
+  //Scalar
+  long long scalarSum = 0;
+  auto start = Clock::now();
+  for (unsigned long i=0; i < lookupsCount; i++)
+  {
+    scalarSum += octree.at(xs[i], ys[i], zs[i]);
+  }
+  double scalarTime = nanoseconds(Clock::now() - start);
+
+  //Batched, the results are read afterwards like the scalar lookups
+  std::vector<const int*> results(lookupsCount);
+  long long batchSum = 0;
+  start = Clock::now();
+  octree.atBatch(xs.data(), ys.data(), zs.data(), lookupsCount, results.data());
+  for (unsigned long i=0; i < lookupsCount; i++)
+  {
+    batchSum += *results[i];
+  }
+  double batchTime = nanoseconds(Clock::now() - start);
+
+  if (scalarSum != batchSum)
+  {
+    std::cerr << "Error: the batched lookups differ from the scalar ones" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "at():      " << scalarTime / lookupsCount << " ns/lookup" << std::endl;
+  std::cout << "atBatch(): " << batchTime / lookupsCount << " ns/lookup" << std::endl;
+  std::cout << "Speedup:   " << scalarTime / batchTime << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,362 @@
+/** @file
+* @brief Microbenchmarks of the Octree operations
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+* @details Usage: octree_bench [--filter=regex] [--points=N] [--min_time=seconds]
+* Measures at(), operator(), set(), erase(), relocate(), zSlice(), writeBinary(), readBinary(), bytes() and nodes(), and
+* the erase() and set() pairs relocate() replaces, for the sizes
+* 64 to 4096, uniform and clustered fills and the aggregate sizes 1, 2, 4 and 8. The output follows Google Benchmark: one
+* line per benchmark named operation/size:S/fill:F/AS:A with the time per operation, the number of operations timed and
+* the counters, bytes/object being the memory footprint of the octree divided by the number of objects it holds.
+*/
+
+#include "Octree/octree.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+  * @brief The command line options
+  */
+  struct Options
+  {
+    std::regex filter {".*"};
+    unsigned long pointsCount {1 << 20};
+    double minTime {0.2};
+  };
+
+  enum Fill { Uniform, Clustered };
+
+  typedef std::tuple<int, int, int, float> Point;
+
+  /**
+  * @brief Generates the objects of a benchmark
+  * @details Uniform: random indices over the whole cube. Clustered: gaussian clusters of 1/64th of the size around 64
+  * random centers, i.e. dense regions and mostly empty space like a star catalog. At most 1 object per 8 cells.
+  */
+  std::vector<Point> generatePoints(int size, Fill fill, unsigned long pointsCount)
+  {
+    double cells = std::pow(static_cast<double>(size), 3);
+    pointsCount = std::min<unsigned long>(pointsCount, cells / 8);
+
+    std::default_random_engine generator(size);
+    std::uniform_int_distribution<> uniform(0, size - 1);
+    std::uniform_real_distribution<float> values(1, 2);
+
+    std::vector<Point> points;
+    points.reserve(pointsCount);
+
+    if (fill == Uniform)
+    {
+      for (unsigned long i=0; i < pointsCount; i++)
+      {
+        points.emplace_back(uniform(generator), uniform(generator), uniform(generator), values(generator));
+      }
+    }
+    else
+    {
+      const int clustersCount = 64;
+      std::vector<int> centers;
+      for (int i=0; i < 3 * clustersCount; i++)
+      {
+        centers.push_back(uniform(generator));
+      }
+
+      std::normal_distribution<double> spread(0, std::max(size / 64.0, 1.0));
+      std::uniform_int_distribution<> cluster(0, clustersCount - 1);
+      auto coordinate = [&] (int center) {
+        return std::min(std::max(static_cast<int>(std::lround(center + spread(generator))), 0), size - 1);
+      };
+
+      for (unsigned long i=0; i < pointsCount; i++)
+      {
+        const int* center = &centers[3 * cluster(generator)];
+        int x = coordinate(center[0]);
+        int y = coordinate(center[1]);
+        int z = coordinate(center[2]);
+        points.emplace_back(x, y, z, values(generator));
+      }
+    }
+
+    return points;
+  }
+
+  /**
+  * @brief Runs a benchmark and prints its line
+  * @details The body times the operations itself, so that it can prepare them untimed, and returns the duration. It is
+  * run until the total duration reaches the minimum time, like Google Benchmark.
+  * @param name The name of the benchmark, skipped if it does not match the filter
+  * @param operationsCount The number of operations timed per run of the body
+  * @param body The benchmark
+  * @param counters The counters printed after the timing, e.g. "bytes/object=12.3"
+  */
+  void run(Options const & options, std::string const & name, unsigned long operationsCount,
+           std::function<Clock::duration()> const & body, std::string const & counters = "")
+  {
+    if (!std::regex_search(name, options.filter) || operationsCount == 0)
+    {
+      return;
+    }
+
+    Clock::duration total {0};
+    unsigned long runsCount = 0;
+    do
+    {
+      total += body();
+      runsCount++;
+    }
+    while (std::chrono::duration<double>(total).count() < options.minTime);
+
+    double nsPerOperation = std::chrono::duration<double, std::nano>(total).count() / (runsCount * operationsCount);
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-44s %14.1f ns %12lu", name.c_str(), nsPerOperation,
+                  runsCount * operationsCount);
+    std::cout << line << (counters.empty() ? "" : " " + counters) << std::endl;
+  }
+
+  template <int AS>
+  void benchmark(Options const & options, int size, Fill fill)
+  {
+    std::ostringstream suffixStream;
+    suffixStream << "/size:" << size << "/fill:" << (fill == Uniform ? "uniform" : "clustered") << "/AS:" << AS;
+    std::string suffix = suffixStream.str();
+
+    //Nothing to do if no benchmark of this configuration is selected
+    bool selected = false;
+    for (std::string operation : {"at", "operator()", "set", "erase", "relocate", "erase_set", "zSlice", "writeBinary",
+                                  "readBinary", "bytes", "nodes"})
+    {
+      selected = selected || std::regex_search(operation + suffix, options.filter);
+    }
+    if (!selected)
+    {
+      return;
+    }
+
+    const std::vector<Point> points = generatePoints(size, fill, options.pointsCount);
+
+    Octree<float, AS> octree(size);
+    octree.buildFromPoints(points.begin(), points.end());
+
+    unsigned long objectsCount = 0;
+    octree.visitBox(0, 0, 0, size, size, size, [&objectsCount] (int, int, int, float) { objectsCount++; });
+
+    //Lookups: half on objects, half random, mostly empty
+    std::default_random_engine generator(size + AS);
+    std::uniform_int_distribution<> uniform(0, size - 1);
+    std::uniform_int_distribution<unsigned long> point(0, points.size() - 1);
+    std::vector<std::tuple<int, int, int>> lookups(points.size());
+    for (unsigned long i=0; i < lookups.size(); i++)
+    {
+      if (i % 2)
+      {
+        const Point & p = points[point(generator)];
+        lookups[i] = std::make_tuple(std::get<0>(p), std::get<1>(p), std::get<2>(p));
+      }
+      else
+      {
+        lookups[i] = std::make_tuple(uniform(generator), uniform(generator), uniform(generator));
+      }
+    }
+
+    //Keeps the results alive so that the lookups are not optimized out
+    volatile float sink = 0;
+
+    run(options, "at" + suffix, lookups.size(), [&] () {
+      float sum = 0;
+      auto start = Clock::now();
+      for (const auto & l : lookups)
+      {
+        sum += octree.at(std::get<0>(l), std::get<1>(l), std::get<2>(l));
+      }
+      auto duration = Clock::now() - start;
+      sink = sum;
+      return duration;
+    });
+
+    //Writes through the reference on existing objects, no allocation
+    run(options, "operator()" + suffix, points.size(), [&] () {
+      auto start = Clock::now();
+      for (const auto & p : points)
+      {
+        octree(std::get<0>(p), std::get<1>(p), std::get<2>(p)) = std::get<3>(p);
+      }
+      return Clock::now() - start;
+    });
+
+    //Inserts all the objects one by one in an empty octree
+    run(options, "set" + suffix, points.size(), [&] () {
+      Octree<float, AS> tmp(size);
+      auto start = Clock::now();
+      for (const auto & p : points)
+      {
+        tmp.set(std::get<0>(p), std::get<1>(p), std::get<2>(p), std::get<3>(p));
+      }
+      return Clock::now() - start;
+    });
+
+    //Erases all the objects, down to the empty octree
+    run(options, "erase" + suffix, points.size(), [&] () {
+      Octree<float, AS> tmp(octree);
+      auto start = Clock::now();
+      for (const auto & p : points)
+      {
+        tmp.erase(std::get<0>(p), std::get<1>(p), std::get<2>(p));
+      }
+      return Clock::now() - start;
+    });
+
+    //Every object whose next cell along x is free moves into it, like the objects of a simulation step
+    typedef std::array<int, 3> Index;
+    std::vector<std::tuple<float, Index, Index>> moves;
+    octree.visitBox(0, 0, 0, size - 1, size, size, [&octree, &moves] (int x, int y, int z, float value) {
+      if (octree.at(x + 1, y, z) == octree.emptyValue())
+      {
+        moves.emplace_back(value, Index {{x, y, z}}, Index {{x + 1, y, z}});
+      }
+    });
+    //In the order of the objects, not of the cells
+    std::shuffle(moves.begin(), moves.end(), generator);
+
+    run(options, "relocate" + suffix, moves.size(), [&] () {
+      Octree<float, AS> tmp(octree);
+      auto start = Clock::now();
+      tmp.relocate(moves.begin(), moves.end());
+      return Clock::now() - start;
+    });
+
+    run(options, "erase_set" + suffix, moves.size(), [&] () {
+      Octree<float, AS> tmp(octree);
+      auto start = Clock::now();
+      for (const auto & m : moves)
+      {
+        tmp.erase(std::get<1>(m)[0], std::get<1>(m)[1], std::get<1>(m)[2]);
+        tmp.set(std::get<2>(m)[0], std::get<2>(m)[1], std::get<2>(m)[2], std::get<0>(m));
+      }
+      return Clock::now() - start;
+    });
+
+    //A few slices, each is size^2 values
+    const int slicesCount = 4;
+    run(options, "zSlice" + suffix, slicesCount, [&] () {
+      float sum = 0;
+      auto start = Clock::now();
+      for (int i=0; i < slicesCount; i++)
+      {
+        sum += octree.zSlice((2 * i + 1) * size / (2 * slicesCount))(0, 0);
+      }
+      auto duration = Clock::now() - start;
+      sink = sum;
+      return duration;
+    });
+
+    //Per object, through a memory stream
+    std::string binary;
+    {
+      std::ostringstream out;
+      octree.writeBinary(out);
+      binary = out.str();
+    }
+
+    std::ostringstream binaryCounters;
+    binaryCounters << "file_bytes/object=" << static_cast<double>(binary.size()) / objectsCount;
+    run(options, "writeBinary" + suffix, objectsCount, [&] () {
+      std::ostringstream out;
+      auto start = Clock::now();
+      octree.writeBinary(out);
+      return Clock::now() - start;
+    }, binaryCounters.str());
+
+    run(options, "readBinary" + suffix, objectsCount, [&] () {
+      std::istringstream in(binary);
+      Octree<float, AS> tmp(1);
+      auto start = Clock::now();
+      tmp.readBinary(in);
+      return Clock::now() - start;
+    });
+
+    //Full traversals, timed per call
+    unsigned long bytes = octree.bytes();
+    int nodesCount = octree.nodes();
+
+    std::ostringstream counters;
+    counters << "bytes/object=" << static_cast<double>(bytes) / objectsCount << " objects=" << objectsCount;
+    run(options, "bytes" + suffix, 1, [&] () {
+      auto start = Clock::now();
+      bytes = octree.bytes();
+      return Clock::now() - start;
+    }, counters.str());
+
+    std::ostringstream nodesCounters;
+    nodesCounters << "nodes=" << nodesCount << " nodes/object=" << static_cast<double>(nodesCount) / objectsCount;
+    run(options, "nodes" + suffix, 1, [&] () {
+      auto start = Clock::now();
+      nodesCount = octree.nodes();
+      return Clock::now() - start;
+    }, nodesCounters.str());
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+
+  for (int i=1; i < argc; i++)
+  {
+    std::string argument = argv[i];
+    std::string value = argument.substr(argument.find('=') + 1);
+
+    if (argument.compare(0, 9, "--filter=") == 0)
+    {
+      options.filter = std::regex(value);
+    }
+    else if (argument.compare(0, 9, "--points=") == 0)
+    {
+      options.pointsCount = std::strtoul(value.c_str(), nullptr, 10);
+    }
+    else if (argument.compare(0, 11, "--min_time=") == 0)
+    {
+      options.minTime = std::atof(value.c_str());
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--filter=regex] [--points=N] [--min_time=seconds]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  char header[256];
+  std::snprintf(header, sizeof(header), "%-44s %17s %12s", "Benchmark", "Time/op", "Operations");
+  std::cout << header << std::endl << std::string(76, '-') << std::endl;
+
+  for (int size : {64, 256, 1024, 4096})
+  {
+    for (Fill fill : {Uniform, Clustered})
+    {
+      benchmark<1>(options, size, fill);
+      benchmark<2>(options, size, fill);
+      benchmark<4>(options, size, fill);
+      benchmark<8>(options, size, fill);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
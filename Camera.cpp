@@ -2,6 +2,7 @@
 #include "Utils.h"
 #include "Include/glm/gtx/transform.hpp"
 #include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
 #include "Include/glm/gtc/type_ptr.hpp"
 
 
@@ -28,7 +29,7 @@ Camera::Camera(glm::vec3 const & position, glm::vec3 const & eyeTarget, glm::vec
 
   void Camera::orientate(float xRel, float yRel)
   {
-    spdlog::get("console")->debug() << "Orientate: xRel = " << xRel << ", yRel = " << yRel;
+    LOG_DEBUG("Orientate: xRel = " << xRel << ", yRel = " << yRel);
 
     phi_ += - yRel * sensibility_;
     theta_ += - xRel * sensibility_;
@@ -72,9 +73,9 @@ Camera::Camera(glm::vec3 const & position, glm::vec3 const & eyeTarget, glm::vec
     return input_;
   }
 
-  void Camera::move(glm::vec3 const & clampMin, glm::vec3 const & clampMax)
+  void Camera::move(glm::vec3 const & clampMin, glm::vec3 const & clampMax, float elapsed)
   {
-    movePosition();
+    movePosition(elapsed);
     Utils::clamp(position_, clampMin, clampMax);
     moveOrientation();
 
@@ -95,16 +96,16 @@ Camera::Camera(glm::vec3 const & position, glm::vec3 const & eyeTarget, glm::vec
       {
         float x = input_.mouseXRel();
         float y = input_.mouseYRel();
-        spdlog::get("console")->debug() << "Oculus is moving (debug): x = " << x << ", y = " << y;
+        LOG_DEBUG("Oculus is moving (debug): x = " << x << ", y = " << y);
 
         orientate(x, y);
       }
       else
       {
-        spdlog::get("console")->debug() << "dAngle x: " << input_.oculus()->dAngles().x;
+        LOG_DEBUG("dAngle x: " << input_.oculus()->dAngles().x);
         float xRad = Utils::radToDegree(input_.oculus()->dAngles().x);
         float yRad = Utils::radToDegree(input_.oculus()->dAngles().y);
-        spdlog::get("console")->info()  << "Oculus is moving (real): xRad = " << xRad << ", yRad = " << yRad;
+        LOG_INFO("Oculus is moving (real): xRad = " << xRad << ", yRad = " << yRad);
 
         orientate( - xRad, - yRad);
       }
@@ -112,37 +113,38 @@ Camera::Camera(glm::vec3 const & position, glm::vec3 const & eyeTarget, glm::vec
 
     if (oldOrientation != orientation_)
     {
-      spdlog::get("console")->debug() << "Move camera orientation from "
-      << Utils::toString(oldOrientation) << " to " << Utils::toString(orientation_);
+      LOG_DEBUG("Move camera orientation from "
+      << Utils::toString(oldOrientation) << " to " << Utils::toString(orientation_));
     }
   }
 
-  void Camera::movePosition()
+  void Camera::movePosition(float elapsed)
   {
     glm::vec3 oldPosition = position_;
+    float distance = speed_ * elapsed;
 
     if (input_.isKeyboardKeyDown(SDL_SCANCODE_UP) || input_.isKeyboardKeyDown(SDL_SCANCODE_Z))
     {
-      position_ += orientation_ * speed_;
+      position_ += orientation_ * distance;
     }
     if (input_.isKeyboardKeyDown(SDL_SCANCODE_DOWN) || input_.isKeyboardKeyDown(SDL_SCANCODE_S))
     {
-      position_ += - orientation_ * speed_;
+      position_ += - orientation_ * distance;
     }
     if (input_.isKeyboardKeyDown(SDL_SCANCODE_LEFT) || input_.isKeyboardKeyDown(SDL_SCANCODE_Q))
     {
-      position_ += lateralMove_ * speed_;
+      position_ += lateralMove_ * distance;
     }
     if (input_.isKeyboardKeyDown(SDL_SCANCODE_RIGHT) || input_.isKeyboardKeyDown(SDL_SCANCODE_D))
     {
-      position_ += - lateralMove_ * speed_;
+      position_ += - lateralMove_ * distance;
     }
 
     if (oldPosition != position_)
     {
 
-      spdlog::get("console")->debug() << "Move camera position from "
-      << Utils::toString(oldPosition) << " to " << Utils::toString(position_);
+      LOG_DEBUG("Move camera position from "
+      << Utils::toString(oldPosition) << " to " << Utils::toString(position_));
     }
   }
 
@@ -150,7 +152,7 @@ Camera::Camera(glm::vec3 const & position, glm::vec3 const & eyeTarget, glm::vec
   {
     modelview = glm::lookAt(position_, eyeTarget_, verticalAxis_);
 
-    spdlog::get("console")->debug() << "Camera look at " << Utils::toString(modelview);
+    LOG_DEBUG("Camera look at " << Utils::toString(modelview));
   }
 
   void Camera::setEyeTarget()
@@ -192,7 +194,7 @@ Camera::Camera(glm::vec3 const & position, glm::vec3 const & eyeTarget, glm::vec
     phi_ = Utils::radToDegree(phi_);
     theta_ = Utils::radToDegree(theta_);
 
-    spdlog::get("console")->debug() << "Camera set eye target: phi = " << phi_ << ", theta = " << theta_;
+    LOG_DEBUG("Camera set eye target: phi = " << phi_ << ", theta = " << theta_);
   }
 
   void Camera::setPosition(glm::vec3 position)
@@ -242,7 +244,7 @@ Camera::Camera(glm::vec3 const & position, glm::vec3 const & eyeTarget, glm::vec
   {
     eyeTarget_ = position_ + orientation_;
 
-    spdlog::get("console")->debug() << "Update eye target: " << Utils::toString(eyeTarget_);
+    LOG_DEBUG("Update eye target: " << Utils::toString(eyeTarget_));
   }
   float Camera::phi() const
   {
@@ -28,7 +28,8 @@ public:
   * @param eyeTarget The position of the point the camera points to, i.e is looking at
   * @param verticalAxis The vertical axis we choose to use. Typically it is y, so the value of this argument would be (0, 1, 0)
   * @param sensibility The sensibility of the camera, i.e by how much the camera rotates when we move the mouse
-  * @param speed The speed of the camera, i.e by how much the camera moves when we hit the corresponding keyboard keys
+  * @param speed The speed of the camera, i.e by how much the camera moves per second when we hold the corresponding
+  * keyboard keys
   */
   Camera(glm::vec3 const & position, glm::vec3 const & eyeTarget, glm::vec3 const & verticalAxis, float sensibility, float speed, Input const & input);
 
@@ -48,8 +49,9 @@ public:
   * @brief Moves the camera depending on the user inputs and clamps the position
   * @param clampMin The minimum clamp value
   * @param clampMax The maximum clamp value
+  * @param elapsed The time since the last move, in seconds
   */
-  void move(glm::vec3 const & clampMin, glm::vec3 const & clampMax);
+  void move(glm::vec3 const & clampMin, glm::vec3 const & clampMax, float elapsed);
 
   /**
   * @brief Makes the camera look at a given point described by the modelview matrix
@@ -59,8 +61,10 @@ public:
 
   /**
   * @brief Moves the camera position depending on the user inputs
+  * @details The distance only depends on the time elapsed, not on the frame rate
+  * @param elapsed The time since the last move, in seconds
   */
-  void movePosition();
+  void movePosition(float elapsed);
 
   /**
   * @brief Changes the camera orientation depending on the user inputs
@@ -137,7 +141,7 @@ protected:
   float sensibility_;
 
   /**
-  * @brief The speed of the camera movement
+  * @brief The speed of the camera movement, per second
   */
   float speed_;
 };
@@ -0,0 +1,39 @@
+#include "CameraUniforms.h"
+#include "GLState.h"
+#include "Include/glm/gtc/type_ptr.hpp"
+
+CameraUniforms::CameraUniforms():
+  UBOId_ {0},
+  updatesCount_ {0}
+  {
+    //std140: 2 column major mat4, 64 bytes each, no padding
+    glGenBuffers(1, &UBOId_);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBOId_);
+    glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), 0, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, Shader::cameraBinding, UBOId_);
+  }
+
+  CameraUniforms::~CameraUniforms()
+  {
+    if (glIsBuffer(UBOId_))
+    {
+      GLState::deleteBuffer(UBOId_);
+    }
+  }
+
+  void CameraUniforms::update(glm::mat4 const & projection, glm::mat4 const & view)
+  {
+    glBindBuffer(GL_UNIFORM_BUFFER, UBOId_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(projection));
+    glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(view));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    updatesCount_++;
+  }
+
+  unsigned long CameraUniforms::updatesCount() const
+  {
+    return updatesCount_;
+  }
@@ -0,0 +1,53 @@
+#ifndef CAMERAUNIFORMS_H
+#define CAMERAUNIFORMS_H
+
+/** @file
+* @brief Uniform buffer of the camera matrices
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include "Include/glm/glm.hpp"
+#include "Shader.h"
+
+/**
+* @brief The CameraUniforms class
+* @details Holds the view and projection matrices in a uniform buffer object, bound to the Camera block of every shader
+* program (see Shader::cameraBinding). It is written once per frame, once per eye in Oculus mode, instead of uploading
+* both matrices for every object drawn.
+*/
+class CameraUniforms
+{
+public:
+  /**
+  * @brief Creates the uniform buffer and binds it to the Camera block binding point
+  */
+  CameraUniforms();
+  ~CameraUniforms();
+
+  CameraUniforms(CameraUniforms const &) = delete;
+  CameraUniforms & operator=(CameraUniforms const &) = delete;
+
+  /**
+  * @brief Writes the matrices of the frame
+  * @param projection The OpenGL projection matrix
+  * @param view The OpenGL view matrix
+  */
+  void update(glm::mat4 const & projection, glm::mat4 const & view);
+
+  /**
+  * @brief Gives the number of times the matrices were written since the start
+  */
+  unsigned long updatesCount() const;
+
+private:
+  /**
+  * @brief The OpenGL id of the uniform buffer
+  */
+  GLuint UBOId_;
+
+  unsigned long updatesCount_;
+};
+
+#endif // CAMERAUNIFORMS_H
@@ -1,8 +1,9 @@
 #include "Utils.h"
 #include "Crate.h"
+#include "InstancedRenderer.h"
 #include "Include/glm/gtx/transform.hpp"
 #include "Include/glm/gtc/type_ptr.hpp"
-#include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
 
 Crate::Crate(float x, float y, float z, float size, std::string const & vertexShader, std::string const & fragmentShader, std::string const & textureFile):
   Cube(x, y, z, size, vertexShader, fragmentShader),
@@ -30,7 +31,7 @@ Crate::Crate(float x, float y, float z, float size, std::string const & vertexSh
       0, 0,   1, 0,   1, 1,     // Face 6
       0, 0,   0, 1,   1, 1};    // Face 6
 
-      load();
+      //The VBO & VAO are only created if the crate is drawn on its own, see draw()
     }
 
     Crate::Crate(int x, int y, int z, float size, std::string const & texture):
@@ -42,29 +43,35 @@ Crate::Crate(float x, float y, float z, float size, std::string const & vertexSh
       {
       }
 
-      void Crate::draw(glm::mat4 &projection, glm::mat4 &modelview)
+      void Crate::draw()
       {
-        modelview = glm::translate(modelview, position_);
+        if (!VAOId_)
+        {
+          load();
+        }
 
-        glUseProgram(shader_->programID());
+        //Left bound afterwards: the next crate usually uses the same program and texture, see GLState
+        shader_->use();
 
-        glBindVertexArray(VAOId_);
+        GLState::bindVertexArray(VAOId_);
 
-        glUniformMatrix4fv(glGetUniformLocation(shader_->programID(), "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniformMatrix4fv(glGetUniformLocation(shader_->programID(), "modelview"), 1, GL_FALSE, glm::value_ptr(modelview));
+        glUniformMatrix4fv(modelLocation_, 1, GL_FALSE, glm::value_ptr(glm::translate(position_)));
 
-        glBindTexture(GL_TEXTURE_2D, texture_->id());
+        texture_->bind();
 
         glDrawArrays(GL_TRIANGLES, 0, 36);
+      }
 
-        glBindTexture(GL_TEXTURE_2D, 0);
-
-        glBindVertexArray(0);
-
-        glUseProgram(0);
+      bool Crate::enqueue(InstancedRenderer & renderer)
+      {
+        renderer.add(texture_->id(), position_, size_);
 
-        modelview = glm::translate(modelview, - position_);
+        return true;
+      }
 
+      glm::vec3 Crate::color() const
+      {
+        return texture_->averageColor();
       }
 
       void Crate::load()
@@ -72,11 +79,11 @@ Crate::Crate(float x, float y, float z, float size, std::string const & vertexSh
         //VBO
         if (glIsBuffer(VBOId_))
         {
-          glDeleteBuffers(1, &VBOId_);
+          GLState::deleteBuffer(VBOId_);
         }
 
         glGenBuffers(1, &VBOId_);
-        glBindBuffer(GL_ARRAY_BUFFER, VBOId_);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBOId_);
 
         glBufferData(GL_ARRAY_BUFFER, nbVerticesBytes() + nbTextureBytes(), 0, GL_STATIC_DRAW);
 
@@ -84,18 +91,18 @@ Crate::Crate(float x, float y, float z, float size, std::string const & vertexSh
         glBufferSubData(GL_ARRAY_BUFFER, 0, nbVerticesBytes(), vertices_.data());
         glBufferSubData(GL_ARRAY_BUFFER, nbVerticesBytes(), nbTextureBytes(), textureCoord_.data());
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 
         //VAO
         if (glIsVertexArray(VAOId_))
         {
-          glDeleteVertexArrays(1, &VAOId_);
+          GLState::deleteVertexArray(VAOId_);
         }
 
         glGenVertexArrays(1, &VAOId_);
-        glBindVertexArray(VAOId_);
+        GLState::bindVertexArray(VAOId_);
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBOId_);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBOId_);
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0,  BUFFER_OFFSET(0));
         glEnableVertexAttribArray(0);
@@ -103,9 +110,9 @@ Crate::Crate(float x, float y, float z, float size, std::string const & vertexSh
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0,  BUFFER_OFFSET(nbVerticesBytes()));
         glEnableVertexAttribArray(2);
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 
-        glBindVertexArray(0);
+        GLState::bindVertexArray(0);
       }
 
       int Crate::nbTextureBytes()
@@ -115,6 +122,6 @@ Crate::Crate(float x, float y, float z, float size, std::string const & vertexSh
 
       void Crate::print()
       {
-        spdlog::get("console")->debug() << "Crate:  texture name = " << texture_->file()
-        << ", texture id = " << texture_->id();
+        LOG_DEBUG("Crate:  texture name = " << texture_->file()
+        << ", texture id = " << texture_->id());
       }
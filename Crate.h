@@ -24,7 +24,19 @@ public:
   Crate(float x, float y, float z, float size, std::string const & vertexShader, std::string const & fragmentShader, std::string const & texture);
   Crate(int x, int y, int z, float size, std::string const & texture);
   virtual ~Crate();
-  void draw(glm::mat4 &projection, glm::mat4 &modelview);
+  void draw();
+
+  /**
+  * @brief Queues the crate in the instanced renderer, with its position, size and texture
+  * @return Always true
+  */
+  bool enqueue(InstancedRenderer & renderer);
+
+  /**
+  * @brief Gives the mean colour of the texture of the crate
+  */
+  glm::vec3 color() const;
+
   void load();
 
   /**
@@ -2,7 +2,7 @@
 #include "Cube.h"
 #include "Include/glm/gtx/transform.hpp"
 #include "Include/glm/gtc/type_ptr.hpp"
-#include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
 
 #include <algorithm>
 #include <chrono>
@@ -10,10 +10,11 @@
 using namespace std;
 
 Cube::Cube(float x, float y, float z, float size, std::string const & vertexShader, std::string const & fragmentShader):
-  GraphicObject(x, y, z, size, vertexShader, fragmentShader)
+  GraphicObject(x, y, z, size)
   {
-
-    shader_->load();
+    //Shared shader pool
+    shader_ = ShaderFactory::createShader(vertexShader, fragmentShader);
+    modelLocation_ = shader_->uniformLocation("model");
 
     //A B C D anti clockwise with A facing x axis +, E top, F bottom
     vertices_ = {
@@ -64,9 +65,8 @@ Cube::Cube(float x, float y, float z, float size, std::string const & vertexShad
 
     auto endCubeColors = std::chrono::high_resolution_clock::now();
 
-    spdlog::get("console")->debug() << "Cube colors part took "
-    << chrono::duration_cast<std::chrono::microseconds>(endCubeColors - startCubeColors).count() << " micros";
-    load();
+    LOG_DEBUG("Cube colors part took "
+    << chrono::duration_cast<std::chrono::microseconds>(endCubeColors - startCubeColors).count() << " micros");
   }
 
   Cube::Cube(int x, int y, int z, float size):
@@ -83,26 +83,26 @@ Cube::Cube(float x, float y, float z, float size, std::string const & vertexShad
       //VBO
       if (glIsBuffer(VBOId_))
       {
-        glDeleteBuffers(1, &VBOId_);
+        GLState::deleteBuffer(VBOId_);
       }
 
       glGenBuffers(1, &VBOId_);
-      glBindBuffer(GL_ARRAY_BUFFER, VBOId_);
+      GLState::bindBuffer(GL_ARRAY_BUFFER, VBOId_);
 
       glBufferData(GL_ARRAY_BUFFER, nbVerticesBytes() + nbColorsBytes(), 0, GL_STATIC_DRAW);
       glBufferSubData(GL_ARRAY_BUFFER, 0, nbVerticesBytes(), vertices_.data());
       glBufferSubData(GL_ARRAY_BUFFER, nbVerticesBytes(), nbColorsBytes(), colors_.data());
 
-      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 
       //VAO
       if (glIsVertexArray(VAOId_))
-      glDeleteVertexArrays(1, &VAOId_);
+      GLState::deleteVertexArray(VAOId_);
 
       glGenVertexArrays(1, &VAOId_);
-      glBindVertexArray(VAOId_);
+      GLState::bindVertexArray(VAOId_);
 
-      glBindBuffer(GL_ARRAY_BUFFER, VBOId_);
+      GLState::bindBuffer(GL_ARRAY_BUFFER, VBOId_);
       //Vertices
       glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(0));
       glEnableVertexAttribArray(0);
@@ -111,26 +111,24 @@ Cube::Cube(float x, float y, float z, float size, std::string const & vertexShad
       glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(nbVerticesBytes()));
       glEnableVertexAttribArray(1);
 
-      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 
-      glBindVertexArray(0);
+      GLState::bindVertexArray(0);
     }
 
-    void Cube::draw(glm::mat4 &projection, glm::mat4 &modelview)
+    void Cube::draw()
     {
-      modelview = glm::translate(modelview, position_);
-      glUseProgram(shader_->programID());
-
-      glBindVertexArray(VBOId_);
-
-      glUniformMatrix4fv(glGetUniformLocation(shader_->programID(), "modelview"), 1, GL_FALSE, glm::value_ptr(modelview));
-      glUniformMatrix4fv(glGetUniformLocation(shader_->programID(), "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+      if (!VAOId_)
+      {
+        load();
+      }
 
-      glDrawArrays(GL_TRIANGLES, 0, vertices_.size());
+      //Left bound afterwards: the next cube usually uses the same program, see GLState
+      shader_->use();
 
-      glBindVertexArray(0);
+      GLState::bindVertexArray(VAOId_);
 
-      glUseProgram(0);
+      glUniformMatrix4fv(modelLocation_, 1, GL_FALSE, glm::value_ptr(glm::translate(position_)));
 
-      modelview = glm::translate(modelview, - position_);
+      glDrawArrays(GL_TRIANGLES, 0, vertices_.size() / 3);
     }
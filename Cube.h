@@ -23,10 +23,11 @@ public:
   Cube(float x, float y, float z, float size, std::string const & vertexShader, std::string const & fragmentShader);
   Cube(int x, int y, int z, float size);
   virtual ~Cube();
-  void draw(glm::mat4 &projection, glm::mat4 &modelview);
+  void draw();
 
   /**
   * @brief Creates the OpenGL resources (VBO & VAO) and sends the data to the graphic card
+  * @details It is called on the first draw, so objects drawn through an InstancedRenderer never create them
   */
   virtual void load();
 
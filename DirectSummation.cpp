@@ -0,0 +1,329 @@
+#include "DirectSummation.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DIRECTSUMMATION_X86
+#endif
+
+namespace
+{
+  //Targets per task of the thread pool, a multiple of the widest vector
+  const unsigned long blockSize = 256;
+
+  //Sources per tile: x, y, z and mass take 16 KiB, half of a L1 cache
+  const unsigned long tileSize = 1024;
+
+  //The arrays are padded to a multiple of the widest pass
+  const unsigned long padding = 32;
+
+  /**
+  * @brief The arrays of a kernel call
+  */
+  struct Arrays
+  {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* mass;
+    float* ax;
+    float* ay;
+    float* az;
+  };
+
+  /**
+  * @brief Adds to the targets [begin, end) the accelerations due to all the sources
+  * @details The accelerations of the targets are accumulated in a tile after the other
+  */
+  void scalarBlock(Arrays const & a, unsigned long begin, unsigned long end, unsigned long count, float epsilon2)
+  {
+    for (unsigned long tile=0; tile < count; tile += tileSize)
+    {
+      const unsigned long tileEnd = std::min(count, tile + tileSize);
+
+      for (unsigned long i=begin; i < end; i++)
+      {
+        float ax = a.ax[i];
+        float ay = a.ay[i];
+        float az = a.az[i];
+
+        for (unsigned long j=tile; j < tileEnd; j++)
+        {
+          float dx = a.x[j] - a.x[i];
+          float dy = a.y[j] - a.y[i];
+          float dz = a.z[j] - a.z[i];
+          float r2 = dx * dx + dy * dy + dz * dz + epsilon2;
+          float inverse = 1 / std::sqrt(r2);
+          float s = a.mass[j] * inverse * inverse * inverse;
+          ax += s * dx;
+          ay += s * dy;
+          az += s * dz;
+        }
+
+        a.ax[i] = ax;
+        a.ay[i] = ay;
+        a.az[i] = az;
+      }
+    }
+  }
+
+#ifdef DIRECTSUMMATION_X86
+  /**
+  * @brief scalarBlock() with 8 targets per vector, 16 per pass
+  */
+  __attribute__((target("avx2,fma")))
+  void avx2Block(Arrays const & a, unsigned long begin, unsigned long end, unsigned long count, float epsilon2)
+  {
+    const __m256 epsilon2s = _mm256_set1_ps(epsilon2);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 threeHalves = _mm256_set1_ps(1.5f);
+
+    for (unsigned long tile=0; tile < count; tile += tileSize)
+    {
+      const unsigned long tileEnd = std::min(count, tile + tileSize);
+
+      //2 vectors of targets per pass, so that the 2 chains of accumulations overlap
+      for (unsigned long i=begin; i < end; i += 16)
+      {
+        const __m256 px0 = _mm256_loadu_ps(a.x + i);
+        const __m256 py0 = _mm256_loadu_ps(a.y + i);
+        const __m256 pz0 = _mm256_loadu_ps(a.z + i);
+        const __m256 px1 = _mm256_loadu_ps(a.x + i + 8);
+        const __m256 py1 = _mm256_loadu_ps(a.y + i + 8);
+        const __m256 pz1 = _mm256_loadu_ps(a.z + i + 8);
+        __m256 ax0 = _mm256_loadu_ps(a.ax + i);
+        __m256 ay0 = _mm256_loadu_ps(a.ay + i);
+        __m256 az0 = _mm256_loadu_ps(a.az + i);
+        __m256 ax1 = _mm256_loadu_ps(a.ax + i + 8);
+        __m256 ay1 = _mm256_loadu_ps(a.ay + i + 8);
+        __m256 az1 = _mm256_loadu_ps(a.az + i + 8);
+
+        for (unsigned long j=tile; j < tileEnd; j++)
+        {
+          const __m256 sx = _mm256_set1_ps(a.x[j]);
+          const __m256 sy = _mm256_set1_ps(a.y[j]);
+          const __m256 sz = _mm256_set1_ps(a.z[j]);
+          const __m256 mass = _mm256_set1_ps(a.mass[j]);
+
+          __m256 dx0 = _mm256_sub_ps(sx, px0);
+          __m256 dy0 = _mm256_sub_ps(sy, py0);
+          __m256 dz0 = _mm256_sub_ps(sz, pz0);
+          __m256 dx1 = _mm256_sub_ps(sx, px1);
+          __m256 dy1 = _mm256_sub_ps(sy, py1);
+          __m256 dz1 = _mm256_sub_ps(sz, pz1);
+          __m256 r20 = _mm256_fmadd_ps(dx0, dx0, _mm256_fmadd_ps(dy0, dy0, _mm256_fmadd_ps(dz0, dz0, epsilon2s)));
+          __m256 r21 = _mm256_fmadd_ps(dx1, dx1, _mm256_fmadd_ps(dy1, dy1, _mm256_fmadd_ps(dz1, dz1, epsilon2s)));
+
+          //12 bits estimate, 1 Newton-Raphson step: y (3/2 - r2 y^2 / 2)
+          __m256 inverse0 = _mm256_rsqrt_ps(r20);
+          __m256 inverse1 = _mm256_rsqrt_ps(r21);
+          inverse0 = _mm256_mul_ps(inverse0, _mm256_fnmadd_ps(_mm256_mul_ps(half, r20), _mm256_mul_ps(inverse0, inverse0), threeHalves));
+          inverse1 = _mm256_mul_ps(inverse1, _mm256_fnmadd_ps(_mm256_mul_ps(half, r21), _mm256_mul_ps(inverse1, inverse1), threeHalves));
+
+          __m256 s0 = _mm256_mul_ps(mass, _mm256_mul_ps(inverse0, _mm256_mul_ps(inverse0, inverse0)));
+          __m256 s1 = _mm256_mul_ps(mass, _mm256_mul_ps(inverse1, _mm256_mul_ps(inverse1, inverse1)));
+          ax0 = _mm256_fmadd_ps(s0, dx0, ax0);
+          ay0 = _mm256_fmadd_ps(s0, dy0, ay0);
+          az0 = _mm256_fmadd_ps(s0, dz0, az0);
+          ax1 = _mm256_fmadd_ps(s1, dx1, ax1);
+          ay1 = _mm256_fmadd_ps(s1, dy1, ay1);
+          az1 = _mm256_fmadd_ps(s1, dz1, az1);
+        }
+
+        _mm256_storeu_ps(a.ax + i, ax0);
+        _mm256_storeu_ps(a.ay + i, ay0);
+        _mm256_storeu_ps(a.az + i, az0);
+        _mm256_storeu_ps(a.ax + i + 8, ax1);
+        _mm256_storeu_ps(a.ay + i + 8, ay1);
+        _mm256_storeu_ps(a.az + i + 8, az1);
+      }
+    }
+  }
+
+  /**
+  * @brief scalarBlock() with 16 targets per vector, 32 per pass
+  */
+  __attribute__((target("avx512f")))
+  void avx512Block(Arrays const & a, unsigned long begin, unsigned long end, unsigned long count, float epsilon2)
+  {
+    const __m512 epsilon2s = _mm512_set1_ps(epsilon2);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 threeHalves = _mm512_set1_ps(1.5f);
+
+    for (unsigned long tile=0; tile < count; tile += tileSize)
+    {
+      const unsigned long tileEnd = std::min(count, tile + tileSize);
+
+      //2 vectors of targets per pass, so that the 2 chains of accumulations overlap
+      for (unsigned long i=begin; i < end; i += 32)
+      {
+        const __m512 px0 = _mm512_loadu_ps(a.x + i);
+        const __m512 py0 = _mm512_loadu_ps(a.y + i);
+        const __m512 pz0 = _mm512_loadu_ps(a.z + i);
+        const __m512 px1 = _mm512_loadu_ps(a.x + i + 16);
+        const __m512 py1 = _mm512_loadu_ps(a.y + i + 16);
+        const __m512 pz1 = _mm512_loadu_ps(a.z + i + 16);
+        __m512 ax0 = _mm512_loadu_ps(a.ax + i);
+        __m512 ay0 = _mm512_loadu_ps(a.ay + i);
+        __m512 az0 = _mm512_loadu_ps(a.az + i);
+        __m512 ax1 = _mm512_loadu_ps(a.ax + i + 16);
+        __m512 ay1 = _mm512_loadu_ps(a.ay + i + 16);
+        __m512 az1 = _mm512_loadu_ps(a.az + i + 16);
+
+        for (unsigned long j=tile; j < tileEnd; j++)
+        {
+          const __m512 sx = _mm512_set1_ps(a.x[j]);
+          const __m512 sy = _mm512_set1_ps(a.y[j]);
+          const __m512 sz = _mm512_set1_ps(a.z[j]);
+          const __m512 mass = _mm512_set1_ps(a.mass[j]);
+
+          __m512 dx0 = _mm512_sub_ps(sx, px0);
+          __m512 dy0 = _mm512_sub_ps(sy, py0);
+          __m512 dz0 = _mm512_sub_ps(sz, pz0);
+          __m512 dx1 = _mm512_sub_ps(sx, px1);
+          __m512 dy1 = _mm512_sub_ps(sy, py1);
+          __m512 dz1 = _mm512_sub_ps(sz, pz1);
+          __m512 r20 = _mm512_fmadd_ps(dx0, dx0, _mm512_fmadd_ps(dy0, dy0, _mm512_fmadd_ps(dz0, dz0, epsilon2s)));
+          __m512 r21 = _mm512_fmadd_ps(dx1, dx1, _mm512_fmadd_ps(dy1, dy1, _mm512_fmadd_ps(dz1, dz1, epsilon2s)));
+
+          //14 bits estimate, 1 Newton-Raphson step: y (3/2 - r2 y^2 / 2)
+          __m512 inverse0 = _mm512_maskz_rsqrt14_ps(0xFFFF, r20);
+          __m512 inverse1 = _mm512_maskz_rsqrt14_ps(0xFFFF, r21);
+          inverse0 = _mm512_mul_ps(inverse0, _mm512_fnmadd_ps(_mm512_mul_ps(half, r20), _mm512_mul_ps(inverse0, inverse0), threeHalves));
+          inverse1 = _mm512_mul_ps(inverse1, _mm512_fnmadd_ps(_mm512_mul_ps(half, r21), _mm512_mul_ps(inverse1, inverse1), threeHalves));
+
+          __m512 s0 = _mm512_mul_ps(mass, _mm512_mul_ps(inverse0, _mm512_mul_ps(inverse0, inverse0)));
+          __m512 s1 = _mm512_mul_ps(mass, _mm512_mul_ps(inverse1, _mm512_mul_ps(inverse1, inverse1)));
+          ax0 = _mm512_fmadd_ps(s0, dx0, ax0);
+          ay0 = _mm512_fmadd_ps(s0, dy0, ay0);
+          az0 = _mm512_fmadd_ps(s0, dz0, az0);
+          ax1 = _mm512_fmadd_ps(s1, dx1, ax1);
+          ay1 = _mm512_fmadd_ps(s1, dy1, ay1);
+          az1 = _mm512_fmadd_ps(s1, dz1, az1);
+        }
+
+        _mm512_storeu_ps(a.ax + i, ax0);
+        _mm512_storeu_ps(a.ay + i, ay0);
+        _mm512_storeu_ps(a.az + i, az0);
+        _mm512_storeu_ps(a.ax + i + 16, ax1);
+        _mm512_storeu_ps(a.ay + i + 16, ay1);
+        _mm512_storeu_ps(a.az + i + 16, az1);
+      }
+    }
+  }
+
+#endif
+}
+
+DirectSummation::DirectSummation(ThreadPool & threadPool, float softening):
+  threadPool_ (threadPool),
+  softening_ {softening},
+  instructionSet_ {bestInstructionSet()},
+  interactionsCount_ {0}
+  {
+    assert(softening_ > 0);
+  }
+
+  void DirectSummation::accelerations(Bodies & bodies)
+  {
+    const unsigned long n = bodies.size();
+    const unsigned long count = (n + padding - 1) / padding * padding;
+
+    //Padded with massless bodies at the origin, which attract nothing
+    x_.assign(count, 0);
+    y_.assign(count, 0);
+    z_.assign(count, 0);
+    mass_.assign(count, 0);
+    std::copy(bodies.x.begin(), bodies.x.end(), x_.begin());
+    std::copy(bodies.y.begin(), bodies.y.end(), y_.begin());
+    std::copy(bodies.z.begin(), bodies.z.end(), z_.begin());
+    std::copy(bodies.mass.begin(), bodies.mass.end(), mass_.begin());
+
+    ax_.assign(count, 0);
+    ay_.assign(count, 0);
+    az_.assign(count, 0);
+
+    Arrays arrays {x_.data(), y_.data(), z_.data(), mass_.data(), ax_.data(), ay_.data(), az_.data()};
+    const float epsilon2 = softening_ * softening_;
+    const InstructionSet instructionSet = instructionSet_;
+
+    threadPool_.parallelFor(count, blockSize, [&arrays, count, epsilon2, instructionSet] (unsigned long begin, unsigned long end, unsigned long) {
+      switch (instructionSet)
+      {
+#ifdef DIRECTSUMMATION_X86
+        case AVX512:
+        avx512Block(arrays, begin, end, count, epsilon2);
+        break;
+
+        case AVX2:
+        avx2Block(arrays, begin, end, count, epsilon2);
+        break;
+#endif
+
+        default:
+        scalarBlock(arrays, begin, end, count, epsilon2);
+      }
+    });
+
+    std::copy(ax_.begin(), ax_.begin() + n, bodies.ax.begin());
+    std::copy(ay_.begin(), ay_.begin() + n, bodies.ay.begin());
+    std::copy(az_.begin(), az_.begin() + n, bodies.az.begin());
+
+    interactionsCount_ = static_cast<unsigned long long>(n) * n;
+  }
+
+  unsigned long long DirectSummation::interactionsCount() const
+  {
+    return interactionsCount_;
+  }
+
+  std::string DirectSummation::name() const
+  {
+    return "Direct summation (" + toString(instructionSet_) + ")";
+  }
+
+  DirectSummation::InstructionSet DirectSummation::instructionSet() const
+  {
+    return instructionSet_;
+  }
+
+  void DirectSummation::setInstructionSet(InstructionSet instructionSet)
+  {
+    instructionSet_ = std::min(instructionSet, bestInstructionSet());
+  }
+
+  DirectSummation::InstructionSet DirectSummation::bestInstructionSet()
+  {
+#ifdef DIRECTSUMMATION_X86
+    if (__builtin_cpu_supports("avx512f"))
+    {
+      return AVX512;
+    }
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+      return AVX2;
+    }
+#endif
+
+    return Scalar;
+  }
+
+  std::string DirectSummation::toString(InstructionSet instructionSet)
+  {
+    switch (instructionSet)
+    {
+      case AVX512:
+      return "AVX-512";
+
+      case AVX2:
+      return "AVX2";
+
+      default:
+      return "scalar";
+    }
+  }
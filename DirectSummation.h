@@ -0,0 +1,80 @@
+#ifndef DIRECTSUMMATION_H
+#define DIRECTSUMMATION_H
+
+/** @file
+* @brief Direct summation gravity solver
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include "NBody.h"
+
+#include <vector>
+
+/**
+* @brief The DirectSummation class
+* @details Computes the exact accelerations in O(N^2), every body attracting every other one: the engine of the small
+* clusters, up to about 20000 bodies, and the reference the approximate solvers like BarnesHut are checked against.
+* The kernel works on structure of arrays copies of the positions and masses, padded with massless bodies. It computes
+* 8 (AVX2) or 16 (AVX-512) targets at a time against 1 source broadcast in every lane, with the inverse square root of
+* the CPU refined by 1 Newton-Raphson step, to about 1e-7 relative. The instruction set is chosen at run time.
+* The targets are split in blocks on the thread pool and the sources in tiles which stay in L1 while a block goes
+* through them.
+* Units: G = 1. The interactions are softened, 1 / (r^2 + epsilon^2)^(3/2), and the softening must not be 0: the
+* interaction of a body with itself is then 0 instead of being skipped.
+*/
+class DirectSummation : public GravitySolver
+{
+public:
+  enum InstructionSet
+  {
+    Scalar,
+    AVX2,
+    AVX512
+  };
+
+  /**
+  * @param threadPool The threads the blocks of targets are split on
+  * @param softening epsilon, in length units, strictly positive
+  */
+  DirectSummation(ThreadPool & threadPool, float softening = 0.05f);
+
+  void accelerations(Bodies & bodies);
+
+  unsigned long long interactionsCount() const;
+
+  std::string name() const;
+
+  InstructionSet instructionSet() const;
+
+  /**
+  * @brief Chooses the instruction set of the kernel, e.g. to compare them
+  * @details Falls back to the best one the CPU supports if it does not support the given one
+  */
+  void setInstructionSet(InstructionSet instructionSet);
+
+  /**
+  * @brief Gives the widest instruction set the CPU supports
+  */
+  static InstructionSet bestInstructionSet();
+
+  static std::string toString(InstructionSet instructionSet);
+
+private:
+  ThreadPool & threadPool_;
+
+  float softening_;
+
+  InstructionSet instructionSet_;
+
+  /**
+  * @brief The padded copies of the positions and masses, and the accelerations of the kernel
+  */
+  std::vector<float> x_, y_, z_, mass_;
+  std::vector<float> ax_, ay_, az_;
+
+  unsigned long long interactionsCount_;
+};
+
+#endif // DIRECTSUMMATION_H
@@ -0,0 +1,213 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+FrameTimeHistogram::FrameTimeHistogram()
+{
+  reset();
+}
+
+void FrameTimeHistogram::reset()
+{
+  counts_.fill(0);
+  count_ = 0;
+  min_ = std::numeric_limits<std::uint64_t>::max();
+  max_ = 0;
+  total_ = 0;
+}
+
+int FrameTimeHistogram::bucketIndex(std::uint64_t value)
+{
+  value = std::min(value, (std::uint64_t(1) << maxExponent) - 1);
+
+  //The first buckets are exact
+  if (value < subBucketsCount)
+  {
+    return static_cast<int>(value);
+  }
+
+  //Position of the highest bit, then the next subBucketsBits bits select the sub-bucket
+  int exponent = 63 - __builtin_clzll(value);
+  int shift = exponent - subBucketsBits;
+  int subBucket = static_cast<int>((value >> shift) & (subBucketsCount - 1));
+
+  return (shift + 1) * subBucketsCount + subBucket;
+}
+
+std::uint64_t FrameTimeHistogram::bucketUpperBound(int index)
+{
+  if (index < subBucketsCount)
+  {
+    return index;
+  }
+
+  int shift = index / subBucketsCount - 1;
+  std::uint64_t subBucket = index % subBucketsCount;
+
+  return ((subBucketsCount + subBucket + 1) << shift) - 1;
+}
+
+void FrameTimeHistogram::record(std::uint64_t nanoseconds)
+{
+  counts_[bucketIndex(nanoseconds)]++;
+  count_++;
+  min_ = std::min(min_, nanoseconds);
+  max_ = std::max(max_, nanoseconds);
+  total_ += nanoseconds;
+}
+
+std::uint64_t FrameTimeHistogram::valueAtPercentile(double percentile) const
+{
+  if (count_ == 0)
+  {
+    return 0;
+  }
+
+  //Nearest rank
+  std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(percentile / 100 * count_));
+  rank = std::max<std::uint64_t>(rank, 1);
+
+  std::uint64_t seen = 0;
+  for (int i = 0; i < bucketsCount; i++)
+  {
+    seen += counts_[i];
+    if (seen >= rank)
+    {
+      //The exact max is known, no need to round it up
+      return std::min(bucketUpperBound(i), max_);
+    }
+  }
+
+  return max_;
+}
+
+std::uint64_t FrameTimeHistogram::countAbove(std::uint64_t nanoseconds) const
+{
+  std::uint64_t above = 0;
+  for (int i = bucketIndex(nanoseconds) + 1; i < bucketsCount; i++)
+  {
+    above += counts_[i];
+  }
+
+  return above;
+}
+
+std::uint64_t FrameTimeHistogram::count() const
+{
+  return count_;
+}
+
+std::uint64_t FrameTimeHistogram::min() const
+{
+  return count_ ? min_ : 0;
+}
+
+std::uint64_t FrameTimeHistogram::max() const
+{
+  return max_;
+}
+
+double FrameTimeHistogram::mean() const
+{
+  return count_ ? static_cast<double>(total_) / count_ : 0;
+}
+
+FrameStats::FrameStats(Clock::duration budget, unsigned long rollingFramesCount):
+  budget_ {static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(budget).count())},
+  rollingFramesCount_ {std::max(rollingFramesCount, 1ul)},
+  totalOverBudget_ {0},
+  currentOverBudget_ {0},
+  rolling_ (summarize(FrameTimeHistogram(), 0))
+  {
+  }
+
+  bool FrameStats::record(Clock::duration frameTime)
+  {
+    std::uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(frameTime).count();
+
+    total_.record(nanoseconds);
+    current_.record(nanoseconds);
+    if (nanoseconds > budget_)
+    {
+      totalOverBudget_++;
+      currentOverBudget_++;
+    }
+
+    if (current_.count() < rollingFramesCount_)
+    {
+      return false;
+    }
+
+    rolling_ = summarize(current_, currentOverBudget_);
+    current_.reset();
+    currentOverBudget_ = 0;
+
+    return true;
+  }
+
+  FrameStats::Summary FrameStats::summary() const
+  {
+    return summarize(total_, totalOverBudget_);
+  }
+
+  FrameStats::Summary FrameStats::rollingSummary() const
+  {
+    return rolling_;
+  }
+
+  FrameStats::Clock::duration FrameStats::budget() const
+  {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(budget_));
+  }
+
+  FrameStats::Summary FrameStats::summarize(FrameTimeHistogram const & histogram, std::uint64_t overBudget) const
+  {
+    const double ms = 1e-6;
+
+    Summary summary;
+    summary.frames = histogram.count();
+    summary.mean = histogram.mean() * ms;
+    summary.min = histogram.min() * ms;
+    summary.p50 = histogram.valueAtPercentile(50) * ms;
+    summary.p90 = histogram.valueAtPercentile(90) * ms;
+    summary.p99 = histogram.valueAtPercentile(99) * ms;
+    summary.p999 = histogram.valueAtPercentile(99.9) * ms;
+    summary.max = histogram.max() * ms;
+    summary.overBudget = overBudget;
+
+    return summary;
+  }
+
+  std::string FrameStats::toString(Summary const & summary)
+  {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2)
+    << summary.frames << " frames, p50 " << summary.p50 << " ms, p90 " << summary.p90
+    << " ms, p99 " << summary.p99 << " ms, p99.9 " << summary.p999 << " ms, max " << summary.max
+    << " ms, " << summary.overBudget << " over budget";
+
+    return out.str();
+  }
+
+  std::string FrameStats::toJSON(Summary const & summary)
+  {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(4)
+    << "{\n"
+    << "  \"frames\": " << summary.frames << ",\n"
+    << "  \"mean_ms\": " << summary.mean << ",\n"
+    << "  \"min_ms\": " << summary.min << ",\n"
+    << "  \"p50_ms\": " << summary.p50 << ",\n"
+    << "  \"p90_ms\": " << summary.p90 << ",\n"
+    << "  \"p99_ms\": " << summary.p99 << ",\n"
+    << "  \"p99_9_ms\": " << summary.p999 << ",\n"
+    << "  \"max_ms\": " << summary.max << ",\n"
+    << "  \"over_budget\": " << summary.overBudget << "\n"
+    << "}";
+
+    return out.str();
+  }
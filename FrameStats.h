@@ -0,0 +1,172 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+/** @file
+* @brief Frame time recorder reporting percentiles
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+* @brief The FrameTimeHistogram class
+* @details Fixed size histogram of durations in nanoseconds with log-linear buckets, in the spirit of HdrHistogram:
+* each power of two is split in 128 linear sub-buckets, so any recorded value is known within 1% whatever its
+* magnitude, from 1 ns to 18 minutes. Recording is O(1) and never allocates.
+*/
+class FrameTimeHistogram
+{
+public:
+  FrameTimeHistogram();
+
+  /**
+  * @brief Records a duration
+  * @param nanoseconds The duration in nanoseconds
+  */
+  void record(std::uint64_t nanoseconds);
+
+  /**
+  * @brief Empties the histogram
+  */
+  void reset();
+
+  /**
+  * @brief Gives the value at the given percentile
+  * @param percentile The percentile, between 0 and 100
+  * @return The upper bound of the bucket containing the percentile, in nanoseconds, 0 if empty
+  */
+  std::uint64_t valueAtPercentile(double percentile) const;
+
+  /**
+  * @brief Gives the number of recorded values above a threshold, at bucket resolution
+  * @details The values in the bucket of the threshold are not counted, so the result is a lower bound: the values up
+  * to 1% above the threshold may be missing
+  * @param nanoseconds The threshold in nanoseconds
+  */
+  std::uint64_t countAbove(std::uint64_t nanoseconds) const;
+
+  std::uint64_t count() const;
+  std::uint64_t min() const;
+  std::uint64_t max() const;
+  double mean() const;
+
+private:
+  /**
+  * @brief log2 of the number of sub-buckets per power of two
+  */
+  static const int subBucketsBits = 7;
+  static const int subBucketsCount = 1 << subBucketsBits;
+
+  /**
+  * @brief Values are clamped to 2^maxExponent nanoseconds
+  */
+  static const int maxExponent = 40;
+  static const int bucketsCount = (maxExponent - subBucketsBits + 2) * subBucketsCount;
+
+  static int bucketIndex(std::uint64_t value);
+  static std::uint64_t bucketUpperBound(int index);
+
+  std::array<std::uint64_t, bucketsCount> counts_;
+  std::uint64_t count_;
+  std::uint64_t min_;
+  std::uint64_t max_;
+
+  /**
+  * @brief The exact sum of the recorded values, for the mean
+  */
+  std::uint64_t total_;
+};
+
+/**
+* @brief The FrameStats class
+* @details Records the frame times of the whole run and of a rolling window of the last frames, and summarizes them
+* with percentiles rather than a mean, which hides the stutter.
+*/
+class FrameStats
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+  * @brief The summary of a set of frames, durations in milliseconds
+  */
+  struct Summary
+  {
+    std::uint64_t frames;
+    double mean;
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
+    std::uint64_t overBudget;
+  };
+
+  /**
+  * @brief Constructor
+  * @param budget The frame time budget, 1/60 s by default
+  * @param rollingFramesCount The number of frames of the rolling window
+  */
+  FrameStats(Clock::duration budget = std::chrono::microseconds(16667), unsigned long rollingFramesCount = 120);
+
+  /**
+  * @brief Records the time of a frame
+  * @return true if the rolling window was just completed, i.e rollingSummary() has new values
+  */
+  bool record(Clock::duration frameTime);
+
+  /**
+  * @brief Summarizes all the frames recorded so far
+  */
+  Summary summary() const;
+
+  /**
+  * @brief Summarizes the last completed rolling window
+  */
+  Summary rollingSummary() const;
+
+  /**
+  * @brief Formats a summary in one line
+  */
+  static std::string toString(Summary const & summary);
+
+  /**
+  * @brief Formats a summary as a JSON object, one key per line
+  */
+  static std::string toJSON(Summary const & summary);
+
+  Clock::duration budget() const;
+
+private:
+  Summary summarize(FrameTimeHistogram const & histogram, std::uint64_t overBudget) const;
+
+  std::uint64_t budget_;
+  unsigned long rollingFramesCount_;
+
+  FrameTimeHistogram total_;
+
+  /**
+  * @brief The rolling window being filled
+  */
+  FrameTimeHistogram current_;
+
+  /**
+  * @brief The exact numbers of frames over budget of total_ and current_, which the histograms only give at bucket
+  * resolution
+  */
+  std::uint64_t totalOverBudget_;
+  std::uint64_t currentOverBudget_;
+
+  /**
+  * @brief The summary of the last completed rolling window
+  */
+  Summary rolling_;
+};
+
+#endif // FRAMESTATS_H
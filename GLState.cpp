@@ -0,0 +1,151 @@
+#include "GLState.h"
+
+const GLuint GLState::unknown;
+
+GLuint GLState::program_ = GLState::unknown;
+GLuint GLState::vertexArray_ = GLState::unknown;
+GLuint GLState::arrayBuffer_ = GLState::unknown;
+GLuint GLState::texture2D_ = GLState::unknown;
+
+unsigned long GLState::issuedCount_ = 0;
+unsigned long GLState::elidedCount_ = 0;
+unsigned long GLState::lastIssuedCount_ = 0;
+unsigned long GLState::lastElidedCount_ = 0;
+unsigned long long GLState::totalIssuedCount_ = 0;
+unsigned long long GLState::totalElidedCount_ = 0;
+
+bool GLState::change(GLuint & bound, GLuint value)
+{
+  if (bound == value)
+  {
+    elidedCount_++;
+    totalElidedCount_++;
+    return false;
+  }
+
+  bound = value;
+  issuedCount_++;
+  totalIssuedCount_++;
+  return true;
+}
+
+void GLState::useProgram(GLuint program)
+{
+  if (change(program_, program))
+  {
+    glUseProgram(program);
+  }
+}
+
+void GLState::bindVertexArray(GLuint vertexArray)
+{
+  if (change(vertexArray_, vertexArray))
+  {
+    glBindVertexArray(vertexArray);
+  }
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+  if (target != GL_ARRAY_BUFFER)
+  {
+    issuedCount_++;
+    totalIssuedCount_++;
+    glBindBuffer(target, buffer);
+  }
+  else if (change(arrayBuffer_, buffer))
+  {
+    glBindBuffer(target, buffer);
+  }
+}
+
+void GLState::bindTexture(GLenum target, GLuint texture)
+{
+  if (target != GL_TEXTURE_2D)
+  {
+    issuedCount_++;
+    totalIssuedCount_++;
+    glBindTexture(target, texture);
+  }
+  else if (change(texture2D_, texture))
+  {
+    glBindTexture(target, texture);
+  }
+}
+
+void GLState::deleteProgram(GLuint program)
+{
+  //A program in use is only deleted once it is no longer used, forget it anyway
+  if (program_ == program)
+  {
+    program_ = unknown;
+  }
+
+  glDeleteProgram(program);
+}
+
+void GLState::deleteVertexArray(GLuint vertexArray)
+{
+  if (vertexArray_ == vertexArray)
+  {
+    vertexArray_ = 0;
+  }
+
+  glDeleteVertexArrays(1, &vertexArray);
+}
+
+void GLState::deleteBuffer(GLuint buffer)
+{
+  if (arrayBuffer_ == buffer)
+  {
+    arrayBuffer_ = 0;
+  }
+
+  glDeleteBuffers(1, &buffer);
+}
+
+void GLState::deleteTexture(GLuint texture)
+{
+  if (texture2D_ == texture)
+  {
+    texture2D_ = 0;
+  }
+
+  glDeleteTextures(1, &texture);
+}
+
+void GLState::invalidate()
+{
+  program_ = unknown;
+  vertexArray_ = unknown;
+  arrayBuffer_ = unknown;
+  texture2D_ = unknown;
+}
+
+void GLState::newFrame()
+{
+  lastIssuedCount_ = issuedCount_;
+  lastElidedCount_ = elidedCount_;
+  issuedCount_ = 0;
+  elidedCount_ = 0;
+}
+
+unsigned long GLState::issuedCount()
+{
+  return lastIssuedCount_;
+}
+
+unsigned long GLState::elidedCount()
+{
+  return lastElidedCount_;
+}
+
+unsigned long long GLState::totalIssuedCount()
+{
+  return totalIssuedCount_;
+}
+
+unsigned long long GLState::totalElidedCount()
+{
+  return totalElidedCount_;
+}
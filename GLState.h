@@ -0,0 +1,111 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+/** @file
+* @brief Cache of the OpenGL bindings
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include "Shader.h"
+
+/**
+* @brief The GLState class
+* @details Remembers the program, vertex array, array buffer and 2D texture currently bound and skips the binds which
+* would not change them, so that consecutive draws with the same program and texture only cost their draw call. Every
+* bind of these 4 bindings must go through it, else the cache no longer matches the driver: after code which binds on
+* its own (e.g. the Oculus SDK), call invalidate().
+* The deletions go through it as well, since OpenGL unbinds a deleted object and may give its id to a new one.
+* Like the TextureFactory, it is a single static instance, for the single OpenGL context of the application.
+*/
+class GLState
+{
+public:
+  static void useProgram(GLuint program);
+  static void bindVertexArray(GLuint vertexArray);
+
+  /**
+  * @brief Binds a buffer
+  * @details Only GL_ARRAY_BUFFER is cached, the other targets are always bound
+  */
+  static void bindBuffer(GLenum target, GLuint buffer);
+
+  /**
+  * @brief Binds a texture to the texture unit 0
+  * @details Only GL_TEXTURE_2D is cached, the other targets are always bound
+  */
+  static void bindTexture(GLenum target, GLuint texture);
+
+  static void deleteProgram(GLuint program);
+  static void deleteVertexArray(GLuint vertexArray);
+  static void deleteBuffer(GLuint buffer);
+  static void deleteTexture(GLuint texture);
+
+  /**
+  * @brief Forgets the cached bindings, the next bind of each is issued whatever its value
+  */
+  static void invalidate();
+
+  /**
+  * @brief Starts the counters of a new frame
+  * @details The counters of the frame which ends are kept until the next call
+  */
+  static void newFrame();
+
+  /**
+  * @brief Gives the number of binds sent to OpenGL during the last frame
+  */
+  static unsigned long issuedCount();
+
+  /**
+  * @brief Gives the number of binds skipped during the last frame because they would not change anything
+  */
+  static unsigned long elidedCount();
+
+  /**
+  * @brief Gives the number of binds sent to OpenGL since the start
+  */
+  static unsigned long long totalIssuedCount();
+
+  /**
+  * @brief Gives the number of binds skipped since the start
+  */
+  static unsigned long long totalElidedCount();
+
+private:
+  /**
+  * @brief Counts a bind and tells whether it has to be issued
+  * @param bound The cached binding, updated to the new value
+  * @param value The new value
+  * @return true if the binding changes
+  */
+  static bool change(GLuint & bound, GLuint value);
+
+  /**
+  * @brief The value of a binding that is not known
+  */
+  static const GLuint unknown = ~0u;
+
+  static GLuint program_;
+  static GLuint vertexArray_;
+  static GLuint arrayBuffer_;
+  static GLuint texture2D_;
+
+  /**
+  * @brief The counters of the current frame
+  */
+  static unsigned long issuedCount_;
+  static unsigned long elidedCount_;
+
+  /**
+  * @brief The counters of the last complete frame
+  */
+  static unsigned long lastIssuedCount_;
+  static unsigned long lastElidedCount_;
+
+  static unsigned long long totalIssuedCount_;
+  static unsigned long long totalElidedCount_;
+};
+
+#endif // GLSTATE_H
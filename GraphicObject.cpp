@@ -4,11 +4,12 @@
 #include <cstring> // TODO: remove?
 
 
-GraphicObject::GraphicObject(float x, float y, float z, float size, std::string const & vertexShader, std::string const & fragmentShader):
+GraphicObject::GraphicObject(float x, float y, float z, float size):
   position_ {x, y, z},
   orientation_ {0, 0, 0},
   size_ {size},
-  shader_ {std::unique_ptr<Shader>(new Shader(vertexShader, fragmentShader))},
+  shader_ {nullptr},
+  modelLocation_ {-1},
   VBOId_ {0},
   VAOId_ {0}
   {
@@ -18,12 +19,12 @@ GraphicObject::GraphicObject(float x, float y, float z, float size, std::string
   {
     if (glIsBuffer(VBOId_) )
     {
-      glDeleteBuffers(1, &VBOId_);
+      GLState::deleteBuffer(VBOId_);
     }
 
     if (glIsVertexArray(VAOId_))
     {
-      glDeleteVertexArrays(1, &VAOId_);
+      GLState::deleteVertexArray(VAOId_);
     }
   }
 
@@ -37,6 +38,27 @@ GraphicObject::GraphicObject(float x, float y, float z, float size, std::string
     return colors_.size() * sizeof(float);
   }
 
+  bool GraphicObject::enqueue(InstancedRenderer &)
+  {
+    return false;
+  }
+
+  glm::vec3 GraphicObject::color() const
+  {
+    if (colors_.size() < 3)
+    {
+      return glm::vec3(1.0);
+    }
+
+    glm::vec3 sum(0.0);
+    for (unsigned long i=0; i + 2 < colors_.size(); i += 3)
+    {
+      sum += glm::vec3(colors_[i], colors_[i + 1], colors_[i + 2]);
+    }
+
+    return sum / static_cast<float>(colors_.size() / 3);
+  }
+
   void GraphicObject::move(glm::vec3 const & value)
   {
     position_ += value;
@@ -44,7 +66,7 @@ GraphicObject::GraphicObject(float x, float y, float z, float size, std::string
 
   void GraphicObject::updateVBO(void* data, int bytesSize, int offset)
   {
-    glBindBuffer(GL_ARRAY_BUFFER, VBOId_);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBOId_);
 
     void* VBOAdress = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
 
@@ -52,7 +74,7 @@ GraphicObject::GraphicObject(float x, float y, float z, float size, std::string
     {
       spdlog::get("console")->error() << "Cannot get the VBO address";
 
-      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 
       return;
     }
@@ -60,7 +82,7 @@ GraphicObject::GraphicObject(float x, float y, float z, float size, std::string
     glUnmapBuffer(GL_ARRAY_BUFFER);
     VBOAdress = 0;
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
   }
 
   NullGraphicObject::NullGraphicObject()
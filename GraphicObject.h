@@ -10,12 +10,15 @@
 
 #include "Include/glm/glm.hpp"
 #include "Shader.h"
+#include "GLState.h"
 #include "Utils.h"
 
 #include <vector>
 #include <string>
 #include <memory>
 
+class InstancedRenderer;
+
 //GL Macro
 #ifndef BUFFER_OFFSET
 
@@ -30,16 +33,31 @@
 class GraphicObject
 {
 public:
-  GraphicObject(float x = 0, float y = 0, float z = 0, float size = 0, std::string const & vertexShader = "", std::string const & fragmentShader = "");
+  GraphicObject(float x = 0, float y = 0, float z = 0, float size = 0);
 
   virtual ~GraphicObject();
 
   /**
   * @brief Displays the graphic object
-  * @param projection The OpenGL projection matrix
-  * @param modelview The OpenGL modelview matrix, which is the product of the model matrix and the view matrix, in this order
+  * @details The view and projection matrices are read from the camera uniform buffer, see CameraUniforms; only the
+  * model matrix of the object is sent
+  */
+  virtual void draw() = 0;
+
+  /**
+  * @brief Queues the graphic object in an instanced renderer instead of drawing it right away
+  * @param renderer The instanced renderer batching the objects of the current frame
+  * @return true if the object was queued, false if it does not support instancing and must be drawn with draw()
+  */
+  virtual bool enqueue(InstancedRenderer & renderer);
+
+  /**
+  * @brief Gives the colour of the object seen from afar
+  * @details The distant objects and octants are drawn as points of this colour, see PointRenderer. By default it is
+  * the mean of the colors coordinates, white if there are none.
+  * @return The RGB colour, each channel in [0, 1]
   */
-  virtual void draw(glm::mat4 &projection, glm::mat4 &modelview) = 0;
+  virtual glm::vec3 color() const;
 
   /**
   * @brief Gives the memory size of the vertices coordinates in bytes
@@ -99,8 +117,14 @@ protected:
   /**
   * @brief The shader manager
   * @details In OpenGL > 3.0 every object is displayed and tranformed through a shader.
+  * It is shared with all the objects using the same shader source files, see ShaderFactory.
+  */
+  std::shared_ptr<Shader> shader_;
+
+  /**
+  * @brief The location of the model matrix in the shader program, kept so that draw() does not look it up
   */
-  std::unique_ptr<Shader> shader_;
+  GLint modelLocation_;
 
   /**
   * @brief The OpenGL id of the Vertex Buffer Object which stores the vertices coordinates in the graphic card
@@ -126,7 +150,7 @@ public:
 
   void release() {}
 
-  void draw(glm::mat4 &, glm::mat4 &) {}
+  void draw() {}
 };
 
 
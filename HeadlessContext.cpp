@@ -0,0 +1,171 @@
+#include "HeadlessContext.h"
+
+#ifdef SIMULATION_HEADLESS
+
+#include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
+
+#include <EGL/eglext.h>
+#include <cstring>
+
+HeadlessContext::HeadlessContext(int width, int height):
+  display_ {EGL_NO_DISPLAY},
+  context_ {EGL_NO_CONTEXT},
+  surface_ {EGL_NO_SURFACE},
+  FBOId_ {0},
+  colorBufferId_ {0},
+  depthBufferId_ {0},
+  width_ {width},
+  height_ {height}
+  {
+  }
+
+  HeadlessContext::~HeadlessContext()
+  {
+    if (context_ != EGL_NO_CONTEXT)
+    {
+      glDeleteFramebuffers(1, &FBOId_);
+      glDeleteRenderbuffers(1, &colorBufferId_);
+      glDeleteRenderbuffers(1, &depthBufferId_);
+
+      eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+      eglDestroyContext(display_, context_);
+    }
+
+    if (surface_ != EGL_NO_SURFACE)
+    {
+      eglDestroySurface(display_, surface_);
+    }
+
+    if (display_ != EGL_NO_DISPLAY)
+    {
+      eglTerminate(display_);
+    }
+  }
+
+  bool HeadlessContext::initContext()
+  {
+    //Surfaceless platform first: no X server nor GPU required
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+    reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    if (getPlatformDisplay)
+    {
+      display_ = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+
+    if (display_ == EGL_NO_DISPLAY)
+    {
+      display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0;
+    EGLint minor = 0;
+    if (display_ == EGL_NO_DISPLAY || !eglInitialize(display_, &major, &minor))
+    {
+      spdlog::get("console")->error() << "Error initializing EGL, EGL error " << eglGetError();
+      display_ = EGL_NO_DISPLAY;
+
+      return false;
+    }
+
+    LOG_DEBUG("EGL " << major << "." << minor << " initialized");
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+      spdlog::get("console")->error() << "Error binding the OpenGL API, EGL error " << eglGetError();
+
+      return false;
+    }
+
+    const char* extensions = eglQueryString(display_, EGL_EXTENSIONS);
+    bool surfaceless = extensions && std::strstr(extensions, "EGL_KHR_surfaceless_context");
+
+    //We render into a FBO, the surface type only matters for the pbuffer fallback
+    const EGLint configAttributes[] = {
+      EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_RED_SIZE, 8,
+      EGL_GREEN_SIZE, 8,
+      EGL_BLUE_SIZE, 8,
+      EGL_DEPTH_SIZE, 24,
+      EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configsCount = 0;
+    if (!eglChooseConfig(display_, configAttributes, &config, 1, &configsCount) || configsCount == 0)
+    {
+      spdlog::get("console")->error() << "Error: no suitable EGL configuration";
+
+      return false;
+    }
+
+    //Version
+    const EGLint contextAttributes[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 3,
+      EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE
+    };
+
+    context_ = eglCreateContext(display_, config, EGL_NO_CONTEXT, contextAttributes);
+
+    if (context_ == EGL_NO_CONTEXT)
+    {
+      spdlog::get("console")->error() << "Error creating the OpenGL context, EGL error " << eglGetError();
+
+      return false;
+    }
+
+    if (!surfaceless)
+    {
+      const EGLint pbufferAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+      surface_ = eglCreatePbufferSurface(display_, config, pbufferAttributes);
+    }
+
+    if (!eglMakeCurrent(display_, surface_, surface_, context_))
+    {
+      spdlog::get("console")->error() << "Error making the OpenGL context current, EGL error " << eglGetError();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  bool HeadlessContext::initFBO()
+  {
+    glGenFramebuffers(1, &FBOId_);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBOId_);
+
+    glGenRenderbuffers(1, &colorBufferId_);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBufferId_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBufferId_);
+
+    glGenRenderbuffers(1, &depthBufferId_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBufferId_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width_, height_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBufferId_);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      spdlog::get("console")->error() << "Error: the offscreen framebuffer is incomplete";
+
+      return false;
+    }
+
+    glViewport(0, 0, width_, height_);
+
+    return true;
+  }
+
+  GLuint HeadlessContext::FBOId() const
+  {
+    return FBOId_;
+  }
+
+#endif
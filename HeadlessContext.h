@@ -0,0 +1,92 @@
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+/** @file
+* @brief Offscreen OpenGL context for the headless mode
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#ifdef SIMULATION_HEADLESS
+
+#define GL3_PROTOTYPES 1
+#include "Include/GL3/gl3.h"
+
+#include <EGL/egl.h>
+
+/**
+* @brief The HeadlessContext class
+* @details Creates an OpenGL 3.3 core context without any window, through EGL. It uses the Mesa surfaceless platform
+* when available (no X server nor GPU needed, it runs on llvmpipe) and falls back on the default EGL display with a
+* pbuffer. The scene is rendered into a Frame Buffer Object of the requested size.
+*/
+class HeadlessContext
+{
+public:
+  /**
+  * @brief Constructor
+  * @param width The width of the offscreen framebuffer
+  * @param height The height of the offscreen framebuffer
+  */
+  HeadlessContext(int width, int height);
+
+  /**
+  * @brief Destructor
+  * @details Releases the FBO and the EGL context
+  */
+  ~HeadlessContext();
+
+  /**
+  * @brief Creates the EGL context and makes it current
+  * @return true if successful, else false
+  */
+  bool initContext();
+
+  /**
+  * @brief Creates the offscreen framebuffer and binds it
+  * @details Must be called once the OpenGL functions are loaded
+  * @return true if successful, else false
+  */
+  bool initFBO();
+
+  GLuint FBOId() const;
+
+private:
+  /**
+  * @brief The EGL display, i.e the connection to the EGL implementation
+  */
+  EGLDisplay display_;
+
+  /**
+  * @brief The EGL OpenGL context
+  */
+  EGLContext context_;
+
+  /**
+  * @brief The 1x1 pbuffer, only used if the implementation does not support surfaceless contexts
+  */
+  EGLSurface surface_;
+
+  /**
+  * @brief The OpenGL id of the Frame Buffer Object the scene is rendered into
+  */
+  GLuint FBOId_;
+
+  /**
+  * @brief The OpenGL id of the color buffer attached to the FBO
+  */
+  GLuint colorBufferId_;
+
+  /**
+  * @brief The OpenGL id of the depth buffer attached to the FBO
+  */
+  GLuint depthBufferId_;
+
+  int width_;
+  int height_;
+};
+
+#endif
+
+#endif // HEADLESSCONTEXT_H
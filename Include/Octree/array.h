@@ -21,6 +21,8 @@
 #include "shareddata.h"
 #include "tinyvector.h"
 
+#include <cassert>
+
 template< typename T, int N >
 class Array
 {
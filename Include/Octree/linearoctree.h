@@ -0,0 +1,96 @@
+/*
+ *  Pointerless octree storing its cells in Morton order.
+ *
+ *  Same interface as Octree for the operations used by the simulation, so that
+ *  the two can be swapped at compile time.
+ */
+
+#ifndef LINEAROCTREE_H
+#define LINEAROCTREE_H
+
+#include "morton.h"
+#include "octreefrustum.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template< typename T, int AS = 1 >
+class LinearOctree
+{
+public:
+    LinearOctree( int size, const T& emptyValue = T(0) );
+
+    // Accessors
+    int size() const;
+    const T& emptyValue() const;
+
+    unsigned long bytes() const;
+    unsigned long cells() const;
+
+    // Mutators
+    void setEmptyValue( const T& emptyValue );
+
+    void swap( LinearOctree<T,AS>& o );
+    void compact();
+
+    // Indexing operators
+    T& operator() ( int x, int y, int z );
+    const T& operator() ( int x, int y, int z ) const;
+    const T& at( int x, int y, int z ) const;
+
+    void set( int x, int y, int z, const T& value );
+    void erase( int x, int y, int z );
+
+    template< typename Iterator >
+    void buildFromPoints( Iterator first, Iterator last );
+    template< typename Iterator >
+    void relocate( Iterator first, Iterator last );
+
+    // Spatial queries
+    template< typename Visitor >
+    void visitBox( int x0, int y0, int z0, int x1, int y1, int z1,
+            Visitor visit ) const;
+    template< typename Visitor >
+    void visitFrustum( const float planes[][4], int planeCount, float margin,
+            Visitor visit ) const;
+
+protected:
+    typedef Morton::Code Key;
+
+private:
+    static std::size_t find( const std::vector<Key>& keys, Key key );
+    std::size_t pendingLimit() const;
+
+    template< typename Visitor >
+    void visitBoxRecursive( const std::vector<Key>& keys,
+            const std::vector<T>& values, std::size_t first, std::size_t last,
+            Key base, int size, int x, int y, int z,
+            int x0, int y0, int z0, int x1, int y1, int z1,
+            Visitor& visit ) const;
+
+    template< typename Visitor >
+    void visitFrustumRecursive( const std::vector<Key>& keys,
+            const std::vector<T>& values, std::size_t first, std::size_t last,
+            Key base, int size, int x, int y, int z,
+            const float planes[][4], unsigned int planeMask, float margin,
+            Visitor& visit ) const;
+
+private:
+    // Sorted cells.
+    std::vector<Key> keys_;
+    std::vector<T> values_;
+
+    // Sorted cells inserted since the last compact(), absent from keys_.
+    std::vector<Key> pendingKeys_;
+    std::vector<T> pendingValues_;
+
+    T emptyValue_;
+    int size_;
+};
+
+#include "linearoctree.tcc"
+
+#endif
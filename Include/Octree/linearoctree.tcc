@@ -0,0 +1,584 @@
+/**
+ * \class LinearOctree
+ * \brief Octree without pointers, stored as a sorted array of Morton codes
+ *
+ * The allocated cells are kept in two parallel arrays, the Morton codes of
+ * their indices (see morton.h) and their values, sorted by code. A lookup is a
+ * binary search over contiguous keys instead of one pointer chase per level,
+ * and every subtree is a contiguous range of the arrays, which makes box
+ * queries a recursive narrowing of index ranges.
+ *
+ * Inserting into a sorted array moves all the following cells, so new cells
+ * go into a second, much smaller, sorted array which is merged into the main
+ * one when it grows past the square root of the main one (or when compact()
+ * is called). Erasing a cell of the main array only overwrites it with the
+ * empty value; such cells are dropped at the next merge.
+ *
+ * \param T Type of the contained data. Same requirements as for Octree, plus
+ * equality comparison.
+ *
+ * \param AS Ignored. Accepted so that LinearOctree<T,AS> can replace
+ * Octree<T,AS>.
+ */
+
+/**
+ * \param size Size of octree, in nodes. <b>Must be a power of two</b> and at
+ * most 2<sup>21</sup>.
+ *
+ * \param emptyValue Value returned when accessing cells that were not
+ * allocated.
+ */
+template< typename T, int AS >
+LinearOctree<T,AS>::LinearOctree( int size, const T& emptyValue )
+    : emptyValue_(emptyValue)
+    , size_(size)
+{
+    assert( ((size - 1) & size) == 0 );
+    assert( size <= (1 << Morton::maxBits) );
+}
+
+/**
+ * \return Size of octree, in nodes, as specified in the constructor.
+ */
+template< typename T, int AS >
+int LinearOctree<T,AS>::size() const
+{
+    return size_;
+}
+
+/**
+ * \return Value of empty nodes, as specified in the constructor.
+ */
+template< typename T, int AS >
+const T& LinearOctree<T,AS>::emptyValue() const
+{
+    return emptyValue_;
+}
+
+/**
+ * Sets the value of empty nodes to \a emptyValue.
+ */
+template< typename T, int AS >
+void LinearOctree<T,AS>::setEmptyValue( const T& emptyValue )
+{
+    emptyValue_ = emptyValue;
+}
+
+/**
+ * \return Total number of bytes the octree occupies, counting the reserved
+ * capacity of the arrays.
+ */
+template< typename T, int AS >
+unsigned long LinearOctree<T,AS>::bytes() const
+{
+    return sizeof(*this)
+        + ( keys_.capacity() + pendingKeys_.capacity() ) * sizeof(Key)
+        + ( values_.capacity() + pendingValues_.capacity() ) * sizeof(T);
+}
+
+/**
+ * \return Number of allocated cells, including erased cells not yet dropped
+ * by a merge.
+ */
+template< typename T, int AS >
+unsigned long LinearOctree<T,AS>::cells() const
+{
+    return keys_.size() + pendingKeys_.size();
+}
+
+/**
+ * Swaps the octree's contents with another's.
+ */
+template< typename T, int AS >
+void LinearOctree<T,AS>::swap( LinearOctree<T,AS>& o )
+{
+    std::swap( emptyValue_, o.emptyValue_ );
+    keys_.swap( o.keys_ );
+    values_.swap( o.values_ );
+    pendingKeys_.swap( o.pendingKeys_ );
+    pendingValues_.swap( o.pendingValues_ );
+    std::swap( size_, o.size_ );
+}
+
+/**
+ * Merges the recently inserted cells into the main array and drops the erased
+ * cells. This is done automatically, but calling it after a batch of
+ * insertions makes the following lookups a single binary search.
+ */
+template< typename T, int AS >
+void LinearOctree<T,AS>::compact()
+{
+    std::vector<Key> keys;
+    std::vector<T> values;
+    keys.reserve( keys_.size() + pendingKeys_.size() );
+    values.reserve( keys_.size() + pendingKeys_.size() );
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while ( i < keys_.size() || j < pendingKeys_.size() ) {
+        bool fromMain = j == pendingKeys_.size()
+            || ( i < keys_.size() && keys_[i] < pendingKeys_[j] );
+        const Key key = fromMain ? keys_[i] : pendingKeys_[j];
+        const T& value = fromMain ? values_[i++] : pendingValues_[j++];
+
+        if ( value != emptyValue_ ) {
+            keys.push_back(key);
+            values.push_back(value);
+        }
+    }
+
+    keys_.swap(keys);
+    values_.swap(values);
+    pendingKeys_.clear();
+    pendingValues_.clear();
+}
+
+/**
+ * \return Index of \a key in \a keys, or <code>keys.size()</code> if absent.
+ */
+template< typename T, int AS >
+std::size_t LinearOctree<T,AS>::find( const std::vector<Key>& keys, Key key )
+{
+    typename std::vector<Key>::const_iterator it =
+        std::lower_bound( keys.begin(), keys.end(), key );
+
+    if ( it == keys.end() || *it != key ) {
+        return keys.size();
+    }
+    return it - keys.begin();
+}
+
+/**
+ * \return Number of pending cells that triggers a merge.
+ */
+template< typename T, int AS >
+std::size_t LinearOctree<T,AS>::pendingLimit() const
+{
+    std::size_t limit = 1024;
+    while ( limit * limit < keys_.size() ) {
+        limit *= 2;
+    }
+    return limit;
+}
+
+/**
+ * \return Value at index (\a x,\a y,\a z), or emptyValue() if no cell exists
+ * at this index.
+ */
+template< typename T, int AS >
+const T& LinearOctree<T,AS>::at( int x, int y, int z ) const
+{
+    assert( x >= 0 && x < size_ );
+    assert( y >= 0 && y < size_ );
+    assert( z >= 0 && z < size_ );
+
+    const Key key = Morton::encode( x, y, z );
+
+    std::size_t i = find( keys_, key );
+    if ( i != keys_.size() ) {
+        return values_[i];
+    }
+
+    i = find( pendingKeys_, key );
+    if ( i != pendingKeys_.size() ) {
+        return pendingValues_[i];
+    }
+
+    return emptyValue_;
+}
+
+/**
+ * Synonym of at().
+ */
+template< typename T, int AS >
+const T& LinearOctree<T,AS>::operator() ( int x, int y, int z ) const
+{
+    return at(x,y,z);
+}
+
+/**
+ * \return Reference to value at index (\a x,\a y,\a z). If no cell exists at
+ * this index, a new one is created, initialized to emptyValue(), and returned.
+ *
+ * \remarks Unlike with Octree, the reference is only valid until the next
+ * insertion or compact().
+ */
+template< typename T, int AS >
+T& LinearOctree<T,AS>::operator() ( int x, int y, int z )
+{
+    assert( x >= 0 && x < size_ );
+    assert( y >= 0 && y < size_ );
+    assert( z >= 0 && z < size_ );
+
+    const Key key = Morton::encode( x, y, z );
+
+    std::size_t i = find( keys_, key );
+    if ( i != keys_.size() ) {
+        return values_[i];
+    }
+
+    typename std::vector<Key>::iterator it =
+        std::lower_bound( pendingKeys_.begin(), pendingKeys_.end(), key );
+    i = it - pendingKeys_.begin();
+    if ( it != pendingKeys_.end() && *it == key ) {
+        return pendingValues_[i];
+    }
+
+    if ( pendingKeys_.size() >= pendingLimit() ) {
+        compact();
+        pendingKeys_.push_back(key);
+        pendingValues_.push_back(emptyValue_);
+        return pendingValues_.back();
+    }
+
+    pendingKeys_.insert( it, key );
+    pendingValues_.insert( pendingValues_.begin() + i, emptyValue_ );
+    return pendingValues_[i];
+}
+
+/**
+ * Sets the value of the cell at (\a x, \a y, \a z) to \a value. If \a value is
+ * the empty value, the cell is erased.
+ */
+template< typename T, int AS >
+void LinearOctree<T,AS>::set( int x, int y, int z, const T& value )
+{
+    if ( value != emptyValue() ) {
+        (*this)(x,y,z) = value;
+    }
+    else {
+        erase(x,y,z);
+    }
+}
+
+/**
+ * Erases the cell at index (\a x,\a y,\a z). After the call,
+ * <code>at(x,y,z)</code> will return the value returned by emptyValue().
+ */
+template< typename T, int AS >
+void LinearOctree<T,AS>::erase( int x, int y, int z )
+{
+    assert( x >= 0 && x < size_ );
+    assert( y >= 0 && y < size_ );
+    assert( z >= 0 && z < size_ );
+
+    const Key key = Morton::encode( x, y, z );
+
+    std::size_t i = find( keys_, key );
+    if ( i != keys_.size() ) {
+        values_[i] = emptyValue_;
+        return;
+    }
+
+    i = find( pendingKeys_, key );
+    if ( i != pendingKeys_.size() ) {
+        pendingKeys_.erase( pendingKeys_.begin() + i );
+        pendingValues_.erase( pendingValues_.begin() + i );
+    }
+}
+
+/**
+ * Replaces the contents of the octree with the points of the random access
+ * range [\a first, \a last), as Octree::buildFromPoints() does. Once sorted by
+ * Morton code, the points are the arrays themselves.
+ */
+template< typename T, int AS >
+template< typename Iterator >
+void LinearOctree<T,AS>::buildFromPoints( Iterator first, Iterator last )
+{
+    const std::vector<Morton::Entry> entries =
+        Morton::sortPoints( first, last );
+
+    std::vector<Key> keys;
+    std::vector<T> values;
+    keys.reserve( entries.size() );
+    values.reserve( entries.size() );
+
+    for ( std::size_t i = 0; i < entries.size(); ++i ) {
+        // Only the last duplicate is kept.
+        if ( i + 1 < entries.size() && entries[i+1].code == entries[i].code ) {
+            continue;
+        }
+
+        const T& value = std::get<3>( *( first + entries[i].index ) );
+        if ( value != emptyValue_ ) {
+            keys.push_back( entries[i].code );
+            values.push_back( value );
+        }
+    }
+
+    keys_.swap(keys);
+    values_.swap(values);
+    pendingKeys_.clear();
+    pendingValues_.clear();
+}
+
+/**
+ * Moves values between indices in one pass, as Octree::relocate() does. The
+ * erasures and the insertions are sorted by Morton code, so each of them is
+ * looked up from where the previous one was found instead of over the whole
+ * arrays. The erased cells are overwritten with the empty value, the moved
+ * values overwrite the cells that already exist and the new cells are merged
+ * into the recently inserted ones at once.
+ */
+template< typename T, int AS >
+template< typename Iterator >
+void LinearOctree<T,AS>::relocate( Iterator first, Iterator last )
+{
+    std::vector< std::pair<Key,T> > erasures;
+    std::vector< std::pair<Key,T> > insertions;
+    Morton::sortMoves<T>( first, last, erasures, insertions );
+
+    if ( erasures.empty() ) {
+        return;
+    }
+
+    typename std::vector<Key>::iterator main = keys_.begin();
+    typename std::vector<Key>::iterator pending = pendingKeys_.begin();
+    for ( std::size_t e = 0; e < erasures.size(); ++e ) {
+        const Key key = erasures[e].first;
+
+        main = std::lower_bound( main, keys_.end(), key );
+        if ( main != keys_.end() && *main == key ) {
+            T& value = values_[ main - keys_.begin() ];
+            if ( value == erasures[e].second ) {
+                value = emptyValue_;
+            }
+            continue;
+        }
+
+        // Dropped from the pending cells below.
+        pending = std::lower_bound( pending, pendingKeys_.end(), key );
+        if ( pending != pendingKeys_.end() && *pending == key ) {
+            T& value = pendingValues_[ pending - pendingKeys_.begin() ];
+            if ( value == erasures[e].second ) {
+                value = emptyValue_;
+            }
+        }
+    }
+
+    std::vector<Key> newKeys;
+    std::vector<T> newValues;
+    main = keys_.begin();
+    pending = pendingKeys_.begin();
+    for ( std::size_t i = 0; i < insertions.size(); ++i ) {
+        const Key key = insertions[i].first;
+        const T& value = insertions[i].second;
+        if ( value == emptyValue_ ) {
+            continue;
+        }
+
+        main = std::lower_bound( main, keys_.end(), key );
+        if ( main != keys_.end() && *main == key ) {
+            values_[ main - keys_.begin() ] = value;
+            continue;
+        }
+
+        pending = std::lower_bound( pending, pendingKeys_.end(), key );
+        if ( pending != pendingKeys_.end() && *pending == key ) {
+            pendingValues_[ pending - pendingKeys_.begin() ] = value;
+            continue;
+        }
+
+        // Only the last duplicate is kept.
+        if ( !newKeys.empty() && newKeys.back() == key ) {
+            newValues.back() = value;
+        }
+        else {
+            newKeys.push_back(key);
+            newValues.push_back(value);
+        }
+    }
+
+    std::vector<Key> keys;
+    std::vector<T> values;
+    keys.reserve( pendingKeys_.size() + newKeys.size() );
+    values.reserve( pendingKeys_.size() + newKeys.size() );
+
+    std::size_t p = 0;
+    std::size_t n = 0;
+    while ( p < pendingKeys_.size() || n < newKeys.size() ) {
+        bool fromPending = n == newKeys.size()
+            || ( p < pendingKeys_.size() && pendingKeys_[p] < newKeys[n] );
+        const Key key = fromPending ? pendingKeys_[p] : newKeys[n];
+        const T& value = fromPending ? pendingValues_[p++] : newValues[n++];
+
+        if ( value != emptyValue_ ) {
+            keys.push_back(key);
+            values.push_back(value);
+        }
+    }
+
+    pendingKeys_.swap(keys);
+    pendingValues_.swap(values);
+
+    if ( pendingKeys_.size() >= pendingLimit() ) {
+        compact();
+    }
+}
+
+/**
+ * Calls \a visit for every non-empty cell whose index lies in the box
+ * [\a x0,\a x1) x [\a y0,\a y1) x [\a z0,\a z1), as Octree::visitBox() does.
+ * Cells are visited in Morton order, first the main array then the recently
+ * inserted cells.
+ */
+template< typename T, int AS >
+template< typename Visitor >
+void LinearOctree<T,AS>::visitBox( int x0, int y0, int z0,
+        int x1, int y1, int z1, Visitor visit ) const
+{
+    x0 = std::max( x0, 0 );
+    y0 = std::max( y0, 0 );
+    z0 = std::max( z0, 0 );
+    x1 = std::min( x1, size_ );
+    y1 = std::min( y1, size_ );
+    z1 = std::min( z1, size_ );
+
+    if ( x0 >= x1 || y0 >= y1 || z0 >= z1 ) {
+        return;
+    }
+
+    visitBoxRecursive( keys_, values_, 0, keys_.size(), 0, size_, 0, 0, 0,
+            x0, y0, z0, x1, y1, z1, visit );
+    visitBoxRecursive( pendingKeys_, pendingValues_, 0, pendingKeys_.size(),
+            0, size_, 0, 0, 0, x0, y0, z0, x1, y1, z1, visit );
+}
+
+/**
+ * Helper function for visitBox() method. The cells [\a first, \a last) of
+ * \a keys are those of the subtree of lowest corner (\a x, \a y, \a z) and of
+ * edge \a size, whose Morton codes start at \a base.
+ */
+template< typename T, int AS >
+template< typename Visitor >
+void LinearOctree<T,AS>::visitBoxRecursive( const std::vector<Key>& keys,
+        const std::vector<T>& values, std::size_t first, std::size_t last,
+        Key base, int size, int x, int y, int z,
+        int x0, int y0, int z0, int x1, int y1, int z1, Visitor& visit ) const
+{
+    if ( first == last ) {
+        return;
+    }
+
+    if ( x + size <= x0 || x >= x1 ||
+         y + size <= y0 || y >= y1 ||
+         z + size <= z0 || z >= z1 ) {
+        return;
+    }
+
+    // Whole subtree inside the box: no need to look at the indices.
+    if ( x >= x0 && x + size <= x1 &&
+         y >= y0 && y + size <= y1 &&
+         z >= z0 && z + size <= z1 ) {
+        for ( std::size_t i = first; i < last; ++i ) {
+            if ( values[i] != emptyValue_ ) {
+                int cx, cy, cz;
+                Morton::decode( keys[i], cx, cy, cz );
+                visit( cx, cy, cz, values[i] );
+            }
+        }
+        return;
+    }
+
+    size /= 2;
+    const Key childSpan = Key(size) * size * size;
+    for ( int i = 0; i < 8; ++i ) {
+        const Key childBase = base + i * childSpan;
+        std::size_t childLast = last;
+        if ( i < 7 ) {
+            childLast = std::lower_bound( keys.begin() + first,
+                    keys.begin() + last, childBase + childSpan )
+                - keys.begin();
+        }
+
+        visitBoxRecursive( keys, values, first, childLast, childBase, size,
+                x + ( i & 1 ? size : 0 ),
+                y + ( i & 2 ? size : 0 ),
+                z + ( i & 4 ? size : 0 ),
+                x0, y0, z0, x1, y1, z1, visit );
+
+        first = childLast;
+    }
+}
+
+/**
+ * Calls \a visit for every non-empty cell that may be inside the convex volume
+ * bounded by \a planes, as Octree::visitFrustum() does.
+ */
+template< typename T, int AS >
+template< typename Visitor >
+void LinearOctree<T,AS>::visitFrustum( const float planes[][4],
+        int planeCount, float margin, Visitor visit ) const
+{
+    assert( planeCount >= 0 && planeCount <= 32 );
+
+    unsigned int planeMask = planeCount == 32 ? ~0u : ( 1u << planeCount ) - 1;
+    visitFrustumRecursive( keys_, values_, 0, keys_.size(), 0, size_, 0, 0, 0,
+            planes, planeMask, margin, visit );
+    visitFrustumRecursive( pendingKeys_, pendingValues_, 0,
+            pendingKeys_.size(), 0, size_, 0, 0, 0, planes, planeMask, margin,
+            visit );
+}
+
+/**
+ * Helper function for visitFrustum() method, on the cells [\a first, \a last)
+ * of the subtree described as in visitBoxRecursive().
+ */
+template< typename T, int AS >
+template< typename Visitor >
+void LinearOctree<T,AS>::visitFrustumRecursive( const std::vector<Key>& keys,
+        const std::vector<T>& values, std::size_t first, std::size_t last,
+        Key base, int size, int x, int y, int z,
+        const float planes[][4], unsigned int planeMask, float margin,
+        Visitor& visit ) const
+{
+    if ( first == last ) {
+        return;
+    }
+
+    unsigned int remaining;
+    if ( !OctreeFrustum::classify( planes, planeMask,
+                x - margin, y - margin, z - margin,
+                x + size + margin, y + size + margin, z + size + margin,
+                remaining ) ) {
+        return;
+    }
+
+    // Whole subtree inside: no need to look at the indices.
+    if ( remaining == 0 ) {
+        for ( std::size_t i = first; i < last; ++i ) {
+            if ( values[i] != emptyValue_ ) {
+                int cx, cy, cz;
+                Morton::decode( keys[i], cx, cy, cz );
+                visit( cx, cy, cz, values[i] );
+            }
+        }
+        return;
+    }
+
+    if ( size == 1 ) {
+        if ( values[first] != emptyValue_ ) {
+            visit( x, y, z, values[first] );
+        }
+        return;
+    }
+
+    size /= 2;
+    const Key childSpan = Key(size) * size * size;
+    for ( int i = 0; i < 8; ++i ) {
+        const Key childBase = base + i * childSpan;
+        std::size_t childLast = last;
+        if ( i < 7 ) {
+            childLast = std::lower_bound( keys.begin() + first,
+                    keys.begin() + last, childBase + childSpan )
+                - keys.begin();
+        }
+
+        visitFrustumRecursive( keys, values, first, childLast, childBase,
+                size, x + ( i & 1 ? size : 0 ), y + ( i & 2 ? size : 0 ),
+                z + ( i & 4 ? size : 0 ), planes, remaining, margin, visit );
+
+        first = childLast;
+    }
+}
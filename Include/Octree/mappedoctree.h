@@ -0,0 +1,120 @@
+/*
+ *  Read-only octree queried in place from a memory-mapped file.
+ *
+ *  The file layout has no pointers: nodes refer to their children by their
+ *  offset from the start of the file, so the file can be mapped anywhere and
+ *  used without deserialisation.
+ */
+
+#ifndef MAPPEDOCTREE_H
+#define MAPPEDOCTREE_H
+
+#include "octree.h"
+
+#include <stdint.h>
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+/**
+ * On-disk layout, in native byte order. Every structure is 8-byte aligned.
+ *
+ *   MappedOctreeHeader   at offset 0
+ *   empty value          at header.emptyValue
+ *   nodes                children before their parent, the root last
+ *
+ * A node starts with MappedOctreeNode, whose type is 0 for a branch, 1 for an
+ * aggregate and 2 for a leaf as in Octree::NodeType. A branch is followed by the offsets of
+ * its 8 children (0 for none), indexed by x | y<<1 | z<<2; an aggregate by its
+ * AS*AS*AS values, x varying the quickest; a leaf by its value. Values are
+ * padded to 8 bytes.
+ */
+struct MappedOctreeHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t valueBytes;
+    int32_t aggregateSize;
+    int32_t size;
+    uint32_t reserved;
+    uint64_t nodes;
+    uint64_t root;
+    uint64_t emptyValue;
+    uint64_t fileBytes;
+};
+
+struct MappedOctreeNode
+{
+    uint32_t type;
+    uint32_t reserved;
+};
+
+template< typename T, int AS = 1 >
+class MappedOctree
+{
+public:
+    explicit MappedOctree( const std::string& file );
+    MappedOctree( const void* data, unsigned long bytes );
+    ~MappedOctree();
+
+    // Accessors
+    int size() const;
+    const T& emptyValue() const;
+    unsigned long nodes() const;
+    unsigned long bytes() const;
+
+    // Indexing operators
+    const T& operator() ( int x, int y, int z ) const;
+    const T& at( int x, int y, int z ) const;
+
+    // Spatial queries
+    template< typename Visitor >
+    void visitBox( int x0, int y0, int z0, int x1, int y1, int z1,
+            Visitor visit ) const;
+
+    // Encoding
+    template< typename Allocator >
+    static void write( const Octree<T,AS,Allocator>& octree, std::ostream& out );
+    static void convertBinary( std::istream& in, std::ostream& out );
+
+    static const uint32_t version = 1;
+
+private:
+    MappedOctree( const MappedOctree<T,AS>& );
+    MappedOctree<T,AS>& operator= ( const MappedOctree<T,AS>& );
+
+    void validate();
+
+    const MappedOctreeNode* node( uint64_t offset, int size ) const;
+    static const uint64_t* children( const MappedOctreeNode* node );
+    static const T* values( const MappedOctreeNode* node );
+
+    template< typename Visitor >
+    void visitBoxRecursive( uint64_t offset, int size, int x, int y, int z,
+            int x0, int y0, int z0, int x1, int y1, int z1,
+            Visitor& visit ) const;
+
+    template< typename Allocator >
+    static uint64_t writeRecursive( std::ostream& out,
+            const typename Octree<T,AS,Allocator>::Node* node,
+            uint64_t& offset, uint64_t& nodes );
+    static void writeAligned( std::ostream& out, const void* data,
+            unsigned long bytes, uint64_t& offset );
+
+    static unsigned long padded( unsigned long bytes );
+
+private:
+    const char* data_;
+    unsigned long bytes_;
+
+    // Length of the mapping, 0 if the data is not owned.
+    unsigned long mappedBytes_;
+
+    const MappedOctreeHeader* header_;
+};
+
+#include "mappedoctree.tcc"
+
+#endif
@@ -0,0 +1,488 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * \class MappedOctree
+ * \brief Read-only octree stored in a memory-mapped file
+ *
+ * The file is written by write() from an Octree, or by convertBinary() from
+ * the output of Octree::writeBinary(). Opening it only maps it: the nodes are
+ * read in place when queried, so loading is immediate whatever the size of the
+ * tree, and the pages are shared between processes by the system.
+ *
+ * \param T Type of the contained data. Since the values are stored as raw
+ * bytes, it must be trivially copyable: store indices or handles rather than
+ * pointers (e.g. not <code>std::shared_ptr</code>).
+ *
+ * \param AS Aggregate size of the octree that was written.
+ */
+
+/**
+ * Maps \a file. Throws std::runtime_error if the file cannot be mapped or was
+ * not written for this \a T, \a AS and format version.
+ */
+template< typename T, int AS >
+MappedOctree<T,AS>::MappedOctree( const std::string& file )
+    : data_(0)
+    , bytes_(0)
+    , mappedBytes_(0)
+    , header_(0)
+{
+    int fd = open( file.c_str(), O_RDONLY );
+    if ( fd < 0 ) {
+        throw std::runtime_error( "MappedOctree: cannot open " + file );
+    }
+
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+        close(fd);
+        throw std::runtime_error( "MappedOctree: cannot read " + file );
+    }
+
+    void* p = mmap( 0, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close(fd);
+    if ( p == MAP_FAILED ) {
+        throw std::runtime_error( "MappedOctree: cannot map " + file );
+    }
+
+    data_ = static_cast<const char*>(p);
+    bytes_ = st.st_size;
+    mappedBytes_ = st.st_size;
+
+    try {
+        validate();
+    }
+    catch (...) {
+        munmap( const_cast<char*>(data_), mappedBytes_ );
+        throw;
+    }
+}
+
+/**
+ * Uses the file already in memory at \a data, which must stay valid and be
+ * 8-byte aligned for the lifetime of the object. Throws std::runtime_error if
+ * \a data is not aligned or was not written for this \a T, \a AS and format
+ * version.
+ */
+template< typename T, int AS >
+MappedOctree<T,AS>::MappedOctree( const void* data, unsigned long bytes )
+    : data_( static_cast<const char*>(data) )
+    , bytes_(bytes)
+    , mappedBytes_(0)
+    , header_(0)
+{
+    validate();
+}
+
+template< typename T, int AS >
+MappedOctree<T,AS>::~MappedOctree()
+{
+    if ( mappedBytes_ ) {
+        munmap( const_cast<char*>(data_), mappedBytes_ );
+    }
+}
+
+/**
+ * Checks the header against the template parameters and the data size, and
+ * the root node. The other nodes are checked by node() as the queries reach
+ * them, so that opening the file does not read all of it.
+ */
+template< typename T, int AS >
+void MappedOctree<T,AS>::validate()
+{
+    if ( reinterpret_cast<uintptr_t>(data_) % 8 != 0 ) {
+        throw std::runtime_error( "MappedOctree: data not aligned on 8 bytes" );
+    }
+    if ( bytes_ < sizeof(MappedOctreeHeader) ) {
+        throw std::runtime_error( "MappedOctree: truncated header" );
+    }
+
+    header_ = reinterpret_cast<const MappedOctreeHeader*>(data_);
+
+    if ( std::memcmp( header_->magic, "OCTMAP\0\0", 8 ) != 0 ) {
+        throw std::runtime_error( "MappedOctree: not a mapped octree" );
+    }
+    if ( header_->version != version ) {
+        throw std::runtime_error( "MappedOctree: unsupported version" );
+    }
+    if ( header_->byteOrder != 0x01020304 ) {
+        throw std::runtime_error( "MappedOctree: wrong byte order" );
+    }
+    if ( header_->valueBytes != sizeof(T) || header_->aggregateSize != AS ) {
+        throw std::runtime_error( "MappedOctree: written for another value type" );
+    }
+    if ( header_->size < AS || ( header_->size & ( header_->size - 1 ) ) ) {
+        throw std::runtime_error( "MappedOctree: invalid size" );
+    }
+    // Each offset is compared with what is left after it, so that no sum
+    // overflows.
+    if ( header_->fileBytes != bytes_ || sizeof(T) > bytes_ ||
+         header_->emptyValue % 8 != 0 ||
+         header_->emptyValue > bytes_ - sizeof(T) ) {
+        throw std::runtime_error( "MappedOctree: truncated file" );
+    }
+
+    node( header_->root, header_->size );
+}
+
+/**
+ * \return Size of octree, in nodes.
+ */
+template< typename T, int AS >
+int MappedOctree<T,AS>::size() const
+{
+    return header_->size;
+}
+
+/**
+ * \return Value of empty nodes.
+ */
+template< typename T, int AS >
+const T& MappedOctree<T,AS>::emptyValue() const
+{
+    return *reinterpret_cast<const T*>( data_ + header_->emptyValue );
+}
+
+/**
+ * \return Number of nodes in the file.
+ */
+template< typename T, int AS >
+unsigned long MappedOctree<T,AS>::nodes() const
+{
+    return header_->nodes;
+}
+
+/**
+ * \return Size of the file. Only the pages actually touched by the queries are
+ * loaded in memory.
+ */
+template< typename T, int AS >
+unsigned long MappedOctree<T,AS>::bytes() const
+{
+    return bytes_;
+}
+
+/**
+ * \return Node at \a offset, the root of a subtree of \a size, or 0 if
+ * \a offset is 0. Throws std::runtime_error if the node is not aligned, does
+ * not lie in the data or has a type that is not valid for \a size, so that a
+ * corrupt file is never read outside of the mapping.
+ */
+template< typename T, int AS >
+const MappedOctreeNode* MappedOctree<T,AS>::node( uint64_t offset,
+        int size ) const
+{
+    if ( !offset ) {
+        return 0;
+    }
+
+    if ( offset % 8 != 0 || offset < sizeof(MappedOctreeHeader) ||
+         offset > bytes_ - sizeof(MappedOctreeNode) ) {
+        throw std::runtime_error( "MappedOctree: corrupt node" );
+    }
+
+    const MappedOctreeNode* n =
+        reinterpret_cast<const MappedOctreeNode*>( data_ + offset );
+
+    unsigned long contentBytes;
+    if ( n->type == 0 && size > AS ) {
+        contentBytes = 8 * sizeof(uint64_t);
+    }
+    else if ( n->type == 1 && size == AS ) {
+        contentBytes = AS * AS * AS * sizeof(T);
+    }
+    else if ( n->type == 2 ) {
+        contentBytes = sizeof(T);
+    }
+    else {
+        throw std::runtime_error( "MappedOctree: corrupt node" );
+    }
+
+    if ( contentBytes > bytes_ - sizeof(MappedOctreeNode) - offset ) {
+        throw std::runtime_error( "MappedOctree: corrupt node" );
+    }
+
+    return n;
+}
+
+template< typename T, int AS >
+const uint64_t* MappedOctree<T,AS>::children( const MappedOctreeNode* node )
+{
+    return reinterpret_cast<const uint64_t*>( node + 1 );
+}
+
+template< typename T, int AS >
+const T* MappedOctree<T,AS>::values( const MappedOctreeNode* node )
+{
+    return reinterpret_cast<const T*>( node + 1 );
+}
+
+/**
+ * \return Value at index (\a x,\a y,\a z), or emptyValue() if no node exists
+ * at this index. Same as Octree::at(). Throws std::runtime_error if the path
+ * to the index goes through a corrupt node (see node()).
+ */
+template< typename T, int AS >
+const T& MappedOctree<T,AS>::at( int x, int y, int z ) const
+{
+    assert( x >= 0 && x < size() );
+    assert( y >= 0 && y < size() );
+    assert( z >= 0 && z < size() );
+
+    const MappedOctreeNode* n = node( header_->root, header_->size );
+    int size = header_->size;
+
+    while ( size != AS ) {
+        if (!n) {
+            return emptyValue();
+        }
+        else if ( n->type == 0 ) {
+            size /= 2;
+            n = node( children(n)[ ( x & size ? 1 : 0 )
+                                 | ( y & size ? 2 : 0 )
+                                 | ( z & size ? 4 : 0 ) ], size );
+        }
+        else {
+            assert( n->type == 2 );
+            return *values(n);
+        }
+    }
+
+    if (!n) {
+        return emptyValue();
+    }
+    else if ( n->type == 2 ) {
+        return *values(n);
+    }
+
+    --size;
+    return values(n)[ ( ( z & size ) * AS + ( y & size ) ) * AS + ( x & size ) ];
+}
+
+/**
+ * Synonym of at().
+ */
+template< typename T, int AS >
+const T& MappedOctree<T,AS>::operator() ( int x, int y, int z ) const
+{
+    return at(x,y,z);
+}
+
+/**
+ * Calls \a visit for every non-empty node whose index lies in the box
+ * [\a x0,\a x1) x [\a y0,\a y1) x [\a z0,\a z1), like Octree::visitBox().
+ * Throws std::runtime_error if it reaches a corrupt node (see node()).
+ */
+template< typename T, int AS >
+template< typename Visitor >
+void MappedOctree<T,AS>::visitBox( int x0, int y0, int z0,
+        int x1, int y1, int z1, Visitor visit ) const
+{
+    x0 = std::max( x0, 0 );
+    y0 = std::max( y0, 0 );
+    z0 = std::max( z0, 0 );
+    x1 = std::min( x1, size() );
+    y1 = std::min( y1, size() );
+    z1 = std::min( z1, size() );
+
+    if ( x0 >= x1 || y0 >= y1 || z0 >= z1 ) {
+        return;
+    }
+
+    visitBoxRecursive( header_->root, size(), 0, 0, 0,
+            x0, y0, z0, x1, y1, z1, visit );
+}
+
+/**
+ * Helper function for visitBox() method.
+ */
+template< typename T, int AS >
+template< typename Visitor >
+void MappedOctree<T,AS>::visitBoxRecursive( uint64_t offset, int size,
+        int x, int y, int z, int x0, int y0, int z0, int x1, int y1, int z1,
+        Visitor& visit ) const
+{
+    const MappedOctreeNode* n = node( offset, size );
+    if ( !n ) {
+        return;
+    }
+
+    if ( x + size <= x0 || x >= x1 ||
+         y + size <= y0 || y >= y1 ||
+         z + size <= z0 || z >= z1 ) {
+        return;
+    }
+
+    const T& empty = emptyValue();
+
+    if ( n->type == 0 ) {
+        size /= 2;
+        for ( int i = 0; i < 8; ++i ) {
+            visitBoxRecursive( children(n)[i], size,
+                    x + ( i & 1 ? size : 0 ),
+                    y + ( i & 2 ? size : 0 ),
+                    z + ( i & 4 ? size : 0 ),
+                    x0, y0, z0, x1, y1, z1, visit );
+        }
+        return;
+    }
+
+    for ( int k = std::max( z, z0 ); k < std::min( z + size, z1 ); ++k ) {
+        for ( int j = std::max( y, y0 ); j < std::min( y + size, y1 ); ++j ) {
+            for ( int i = std::max( x, x0 ); i < std::min( x + size, x1 ); ++i ) {
+                const T& value = n->type == 1
+                    ? values(n)[ ( ( k - z ) * AS + ( j - y ) ) * AS + ( i - x ) ]
+                    : *values(n);
+                if ( value != empty ) {
+                    visit( i, j, k, value );
+                }
+            }
+        }
+    }
+}
+
+template< typename T, int AS >
+unsigned long MappedOctree<T,AS>::padded( unsigned long bytes )
+{
+    return ( bytes + 7 ) & ~7ul;
+}
+
+/**
+ * Writes \a bytes of \a data followed by zeros up to the next multiple of 8.
+ */
+template< typename T, int AS >
+void MappedOctree<T,AS>::writeAligned( std::ostream& out, const void* data,
+        unsigned long bytes, uint64_t& offset )
+{
+    static const char zeros[8] = { 0 };
+
+    out.write( static_cast<const char*>(data), bytes );
+    out.write( zeros, padded(bytes) - bytes );
+    offset += padded(bytes);
+}
+
+/**
+ * Writes \a octree in the mapped format to \a out, which must be seekable: the
+ * header is rewritten once the offset of the root is known.
+ */
+template< typename T, int AS >
+template< typename Allocator >
+void MappedOctree<T,AS>::write( const Octree<T,AS,Allocator>& octree,
+        std::ostream& out )
+{
+    static_assert( std::is_trivially_copyable<T>::value,
+            "MappedOctree stores the values as raw bytes" );
+    static_assert( alignof(T) <= 8, "MappedOctree aligns values on 8 bytes" );
+
+    const std::streampos start = out.tellp();
+
+    MappedOctreeHeader header;
+    std::memset( &header, 0, sizeof(header) );
+    std::memcpy( header.magic, "OCTMAP\0\0", 8 );
+    header.version = version;
+    header.byteOrder = 0x01020304;
+    header.valueBytes = sizeof(T);
+    header.aggregateSize = AS;
+    header.size = octree.size();
+
+    uint64_t offset = 0;
+    writeAligned( out, &header, sizeof(header), offset );
+
+    header.emptyValue = offset;
+    writeAligned( out, &octree.emptyValue(), sizeof(T), offset );
+
+    uint64_t nodes = 0;
+    header.root = writeRecursive<Allocator>( out, octree.root(), offset, nodes );
+    header.nodes = nodes;
+    header.fileBytes = offset;
+
+    out.seekp(start);
+    out.write( reinterpret_cast<const char*>(&header), sizeof(header) );
+    out.seekp( start + std::streamoff(offset) );
+}
+
+/**
+ * Helper function for write(). Writes the subtree of \a node, children first.
+ *
+ * \return Offset of \a node, 0 if it is null.
+ */
+template< typename T, int AS >
+template< typename Allocator >
+uint64_t MappedOctree<T,AS>::writeRecursive( std::ostream& out,
+        const typename Octree<T,AS,Allocator>::Node* node, uint64_t& offset,
+        uint64_t& nodes )
+{
+    typedef Octree<T,AS,Allocator> Tree;
+
+    if ( !node || !out.good() ) {
+        return 0;
+    }
+
+    MappedOctreeNode n = { static_cast<uint32_t>( node->type() ), 0 };
+
+    switch ( node->type() ) {
+        case Tree::BranchNode:
+            {
+                const typename Tree::Branch* b =
+                    reinterpret_cast<const typename Tree::Branch*>(node);
+
+                uint64_t childOffsets[8];
+                for ( int i = 0; i < 8; ++i ) {
+                    childOffsets[i] = writeRecursive<Allocator>( out,
+                            b->child(i), offset, nodes );
+                }
+
+                uint64_t nodeOffset = offset;
+                writeAligned( out, &n, sizeof(n), offset );
+                writeAligned( out, childOffsets, sizeof(childOffsets), offset );
+                ++nodes;
+                return nodeOffset;
+            }
+
+        case Tree::AggregateNode:
+            {
+                uint64_t nodeOffset = offset;
+                writeAligned( out, &n, sizeof(n), offset );
+                writeAligned( out,
+                        &reinterpret_cast<const typename Tree::Aggregate*>(node)->value(0),
+                        AS*AS*AS*sizeof(T), offset );
+                ++nodes;
+                return nodeOffset;
+            }
+
+        case Tree::LeafNode:
+            {
+                uint64_t nodeOffset = offset;
+                writeAligned( out, &n, sizeof(n), offset );
+                writeAligned( out,
+                        &reinterpret_cast<const typename Tree::Leaf*>(node)->value(),
+                        sizeof(T), offset );
+                ++nodes;
+                return nodeOffset;
+            }
+    }
+
+    return 0;
+}
+
+/**
+ * Converts an octree written by Octree::writeBinary() to the mapped format.
+ * Throws std::runtime_error if \a in cannot be read.
+ */
+template< typename T, int AS >
+void MappedOctree<T,AS>::convertBinary( std::istream& in, std::ostream& out )
+{
+    Octree<T,AS> octree(1);
+    octree.readBinary(in);
+    if ( in.fail() ) {
+        throw std::runtime_error( "MappedOctree: cannot read the binary octree" );
+    }
+
+    write( octree, out );
+}
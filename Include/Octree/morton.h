@@ -0,0 +1,276 @@
+/*
+ *  Morton (Z-order) codes of octree indices.
+ *
+ *  The bits of x, y and z are interleaved with x in the lowest bit, so that the
+ *  three bits of a level are the child index x | y<<1 | z<<2 used by
+ *  Octree::Branch::child(int). Sorting indices by Morton code therefore sorts
+ *  them in depth-first octree order: every subtree is a contiguous range of
+ *  codes.
+ */
+
+#ifndef MORTON_H
+#define MORTON_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace Morton
+{
+    typedef uint64_t Code;
+
+    // Indices up to 2^21 per axis, i.e. 63 bits of code.
+    static const int maxBits = 21;
+
+    /**
+     * Spreads the 21 low bits of \a v so that there are two zero bits between
+     * each of them.
+     */
+    inline Code spread( uint32_t v )
+    {
+        Code x = v & 0x1fffff;
+        x = ( x | x << 32 ) & 0x001f00000000ffffULL;
+        x = ( x | x << 16 ) & 0x001f0000ff0000ffULL;
+        x = ( x | x <<  8 ) & 0x100f00f00f00f00fULL;
+        x = ( x | x <<  4 ) & 0x10c30c30c30c30c3ULL;
+        x = ( x | x <<  2 ) & 0x1249249249249249ULL;
+        return x;
+    }
+
+    /**
+     * Inverse of spread(): gathers every third bit of \a x.
+     */
+    inline uint32_t compact( Code x )
+    {
+        x &= 0x1249249249249249ULL;
+        x = ( x ^ ( x >>  2 ) ) & 0x10c30c30c30c30c3ULL;
+        x = ( x ^ ( x >>  4 ) ) & 0x100f00f00f00f00fULL;
+        x = ( x ^ ( x >>  8 ) ) & 0x001f0000ff0000ffULL;
+        x = ( x ^ ( x >> 16 ) ) & 0x001f00000000ffffULL;
+        x = ( x ^ ( x >> 32 ) ) & 0x00000000001fffffULL;
+        return static_cast<uint32_t>(x);
+    }
+
+    inline Code encode( int x, int y, int z )
+    {
+        return spread(x) | spread(y) << 1 | spread(z) << 2;
+    }
+
+    inline void decode( Code code, int& x, int& y, int& z )
+    {
+        x = compact( code );
+        y = compact( code >> 1 );
+        z = compact( code >> 2 );
+    }
+
+    /**
+     * Morton code of a point and its position in the input range. Ordered by
+     * code, then by position, so that the last of several points with the
+     * same index comes last.
+     */
+    struct Entry
+    {
+        Code code;
+        std::size_t index;
+
+        bool operator< ( const Entry& e ) const
+        {
+            return code < e.code || ( code == e.code && index < e.index );
+        }
+    };
+
+    /**
+     * Sorts the entries [\a first, \a last) by code with a least significant
+     * digit radix sort, 11 bits per pass, in O(n) instead of O(n log n). The
+     * passes stop at the highest bit set in the codes, i.e. 3 for an octree of
+     * size 1024. The sort is stable: entries of equal codes keep their order.
+     * Entries already sorted, e.g. read from a Morton sorted file, are only
+     * checked.
+     */
+    inline void radixSort( std::vector<Entry>::iterator first,
+            std::vector<Entry>::iterator last )
+    {
+        const int radixBits = 11;
+        const std::size_t n = last - first;
+        if ( n < 2 ) {
+            return;
+        }
+
+        Code bits = 0;
+        bool sorted = true;
+        Code previous = 0;
+        for ( std::vector<Entry>::iterator it = first; it != last; ++it ) {
+            bits |= it->code;
+            sorted = sorted && previous <= it->code;
+            previous = it->code;
+        }
+        if ( sorted ) {
+            return;
+        }
+
+        std::vector<Entry> buffer(n);
+        Entry* from = &*first;
+        Entry* to = buffer.data();
+        for ( int shift = 0; shift < 64 && ( bits >> shift ) != 0;
+                shift += radixBits ) {
+            std::vector<std::size_t> offsets( ( 1 << radixBits ) + 1, 0 );
+            for ( std::size_t i = 0; i < n; ++i ) {
+                ++offsets[ ( ( from[i].code >> shift ) &
+                        ( ( 1 << radixBits ) - 1 ) ) + 1 ];
+            }
+            for ( std::size_t d = 1; d < offsets.size(); ++d ) {
+                offsets[d] += offsets[d-1];
+            }
+            for ( std::size_t i = 0; i < n; ++i ) {
+                to[ offsets[ ( from[i].code >> shift ) &
+                        ( ( 1 << radixBits ) - 1 ) ]++ ] = from[i];
+            }
+            std::swap( from, to );
+        }
+
+        if ( from != &*first ) {
+            std::copy( from, from + n, first );
+        }
+    }
+
+    /**
+     * Sorts the points of the random access range [\a first, \a last) by
+     * Morton code. The elements must support <code>std::get<0></code> to
+     * <code>std::get<2></code> for x, y and z, like
+     * <code>std::tuple<int,int,int,T></code>.
+     *
+     * Large ranges are split in one chunk per thread: each thread encodes and
+     * sorts its chunk (see radixSort()), then the sorted chunks are merged
+     * pairwise, also in parallel. The threads are started and joined on each
+     * call, which is worth it for a whole tree but not for a batch of moves
+     * every frame.
+     *
+     * \param threads Number of threads to sort on, 0 for one per core. Ranges
+     * of fewer than 2^16 points are always sorted on the calling thread.
+     *
+     * \return The sorted codes with the index of their point in the range.
+     */
+    template< typename Iterator >
+    std::vector<Entry> sortPoints( Iterator first, Iterator last,
+            std::size_t threads = 0 )
+    {
+        const std::size_t n = last - first;
+        std::vector<Entry> entries(n);
+
+        if ( threads == 0 ) {
+            threads = std::thread::hardware_concurrency();
+        }
+        if ( n < ( 1 << 16 ) || threads < 2 ) {
+            threads = 1;
+        }
+
+        // Chunk boundaries, one chunk per thread.
+        std::vector<std::size_t> bounds( threads + 1 );
+        for ( std::size_t t = 0; t <= threads; ++t ) {
+            bounds[t] = n * t / threads;
+        }
+
+        auto sortChunk = [&]( std::size_t t ) {
+            for ( std::size_t i = bounds[t]; i < bounds[t+1]; ++i ) {
+                Iterator it = first + i;
+                entries[i].code = encode( std::get<0>(*it), std::get<1>(*it),
+                        std::get<2>(*it) );
+                entries[i].index = i;
+            }
+            radixSort( entries.begin() + bounds[t],
+                    entries.begin() + bounds[t+1] );
+        };
+
+        std::vector<std::thread> workers;
+        for ( std::size_t t = 1; t < threads; ++t ) {
+            workers.push_back( std::thread( sortChunk, t ) );
+        }
+        sortChunk(0);
+        for ( std::size_t t = 0; t < workers.size(); ++t ) {
+            workers[t].join();
+        }
+
+        // Merge neighbouring chunks until there is only one.
+        for ( std::size_t width = 1; width < threads; width *= 2 ) {
+            workers.clear();
+            for ( std::size_t t = 0; t + width < threads; t += 2 * width ) {
+                const std::size_t begin = bounds[t];
+                const std::size_t middle = bounds[t + width];
+                const std::size_t end = bounds[std::min( t + 2 * width, threads )];
+                // Chunks already in order are left as they are.
+                if ( entries[middle-1].code <= entries[middle].code ) {
+                    continue;
+                }
+                workers.push_back( std::thread( [&entries, begin, middle, end]() {
+                    std::inplace_merge( entries.begin() + begin,
+                            entries.begin() + middle, entries.begin() + end );
+                } ) );
+            }
+            for ( std::size_t t = 0; t < workers.size(); ++t ) {
+                workers[t].join();
+            }
+        }
+
+        return entries;
+    }
+
+    /**
+     * Splits the moves of the random access range [\a first, \a last) into
+     * the erasures of their old indices and the insertions at their new ones,
+     * each sorted by Morton code (see sortPoints()), for
+     * Octree::relocate() and LinearOctree::relocate(). The elements must
+     * support <code>std::get<0></code> to <code>std::get<2></code> for the
+     * value, the old index and the new index, the indices giving x, y and z
+     * through <code>operator[]</code>, like
+     * <code>std::tuple<T,glm::ivec3,glm::ivec3></code>. The moves whose old
+     * and new indices are the same are dropped.
+     *
+     * \param threads Number of threads to sort on, as for sortPoints(). The
+     * moves are sorted on the calling thread by default, as relocations are
+     * usually made every frame.
+     */
+    template< typename T, typename Iterator >
+    void sortMoves( Iterator first, Iterator last,
+            std::vector< std::pair<Code,T> >& erasures,
+            std::vector< std::pair<Code,T> >& insertions,
+            std::size_t threads = 1 )
+    {
+        const std::size_t n = last - first;
+        std::vector< std::tuple<int,int,int> > from;
+        std::vector< std::tuple<int,int,int> > to;
+        std::vector<T> values;
+        from.reserve(n);
+        to.reserve(n);
+        values.reserve(n);
+        for ( Iterator it = first; it != last; ++it ) {
+            const auto& f = std::get<1>(*it);
+            const auto& t = std::get<2>(*it);
+            if ( f[0] != t[0] || f[1] != t[1] || f[2] != t[2] ) {
+                from.push_back( std::make_tuple( f[0], f[1], f[2] ) );
+                to.push_back( std::make_tuple( t[0], t[1], t[2] ) );
+                values.push_back( std::get<0>(*it) );
+            }
+        }
+
+        const std::vector<Entry> sortedFrom =
+            sortPoints( from.begin(), from.end(), threads );
+        const std::vector<Entry> sortedTo =
+            sortPoints( to.begin(), to.end(), threads );
+
+        erasures.resize( values.size() );
+        insertions.resize( values.size() );
+        for ( std::size_t i = 0; i < values.size(); ++i ) {
+            erasures[i].first = sortedFrom[i].code;
+            erasures[i].second = values[ sortedFrom[i].index ];
+            insertions[i].first = sortedTo[i].code;
+            insertions[i].second = values[ sortedTo[i].index ];
+        }
+    }
+}
+
+#endif
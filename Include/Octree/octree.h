@@ -19,19 +19,34 @@
 #define OCTREE_H
 
 #include "array2d.h"
+#include "morton.h"
+#include "octreefrustum.h"
+#include "octreepool.h"
+#include "octreesummary.h"
 #include "point3d.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstddef>
 #include <istream>
 #include <ostream>
+#include <type_traits>
+#include <utility>
 
-template< typename T, int AS = 1 >
+template< typename T, int AS > class MappedOctree;
+
+template< typename T, int AS = 1, typename Allocator = OctreePool >
 class Octree
 {
+    // Reads the nodes to lay them out on disk.
+    template< typename, int > friend class MappedOctree;
+
 public:
+    typedef typename OctreeSummaryTraits<T>::Summary Summary;
+
     Octree( int size, const T& emptyValue = T(0) );
-    Octree( const Octree<T,AS>& o );
+    Octree( const Octree<T,AS,Allocator>& o );
     ~Octree();
 
     // Accessors
@@ -46,22 +61,45 @@ public:
     int nodes() const;
     int nodesAtSize( int size ) const;
 
+    Summary summary() const;
+
     // Mutators
     void setEmptyValue( const T& emptyValue );
 
-    void swap( Octree<T,AS>& o );
-    Octree<T,AS>& operator= ( Octree<T,AS> o );
+    void swap( Octree<T,AS,Allocator>& o );
+    Octree<T,AS,Allocator>& operator= ( Octree<T,AS,Allocator> o );
 
     // Indexing operators
     T& operator() ( int x, int y, int z );
     const T& operator() ( int x, int y, int z ) const;
     const T& at( int x, int y, int z ) const;
+    void atBatch( const int* xs, const int* ys, const int* zs, std::size_t n,
+            const T** out ) const;
 
     void set( int x, int y, int z, const T& value );
     void erase( int x, int y, int z );
 
+    template< typename Iterator >
+    void buildFromPoints( Iterator first, Iterator last );
+    template< typename Iterator >
+    void relocate( Iterator first, Iterator last );
+
+    void refreshSummaries();
+
     Array2D<T> zSlice( int z ) const;
 
+    // Spatial queries
+    template< typename Visitor >
+    void visitBox( int x0, int y0, int z0, int x1, int y1, int z1,
+            Visitor visit ) const;
+    template< typename Visitor >
+    void visitFrustum( const float planes[][4], int planeCount, float margin,
+            Visitor visit ) const;
+    template< typename CellVisitor, typename SummaryVisitor >
+    void visitLOD( const float planes[][4], int planeCount, float margin,
+            const float eye[3], float lodRatio, CellVisitor visitCell,
+            SummaryVisitor visitSummary ) const;
+
     // I/O functions
     void writeBinary( std::ostream& out ) const;
     void readBinary( std::istream& in );
@@ -78,18 +116,45 @@ protected:
     Node*& root();
     const Node* root() const;
 
-    static void deleteNode( Node** node );
+    Branch* newBranch();
+    Aggregate* newAggregate( const T& v );
+    Leaf* newLeaf( const T& v );
+    Node* copyNode( const Node* node );
+    void deleteNode( Node** node );
+    void updateSummaries( int x, int y, int z, const T* removed,
+            const T* added );
 
 private:
     // Recursive helper functions
     void eraseRecursive( Node** node, int size, int x, int y, int z );
+    void relocateRecursive( Node** node, int size, int x, int y, int z,
+            const std::pair<Morton::Code,T>* erasuresFirst,
+            const std::pair<Morton::Code,T>* erasuresLast,
+            const std::pair<Morton::Code,T>* insertionsFirst,
+            const std::pair<Morton::Code,T>* insertionsLast );
     static unsigned long bytesRecursive( const Node* node );
     static int nodesRecursive( const Node* node );
     static int nodesAtSizeRecursive( int targetSize, int size, Node* node );
     void zSliceRecursive( Array2D<T> slice, const Node* node, int size,
             int x, int y, int z, int targetZ ) const;
+    template< typename Visitor >
+    void visitBoxRecursive( const Node* node, int size, int x, int y, int z,
+            int x0, int y0, int z0, int x1, int y1, int z1,
+            Visitor& visit ) const;
+    template< typename Visitor >
+    void visitFrustumRecursive( const Node* node, int size, int x, int y, int z,
+            const float planes[][4], unsigned int planeMask, float margin,
+            Visitor& visit ) const;
+    template< typename CellVisitor, typename SummaryVisitor >
+    void visitLODRecursive( const Node* node, int size, int x, int y, int z,
+            const float planes[][4], unsigned int planeMask, float margin,
+            const float eye[3], float lodRatio, CellVisitor& visitCell,
+            SummaryVisitor& visitSummary ) const;
+    Summary summaryOf( const Node* node, int size, int x, int y, int z ) const;
+    Summary refreshSummariesRecursive( Node* node, int size,
+            int x, int y, int z );
     static void writeBinaryRecursive( std::ostream& out, const Node* node );
-    static void readBinaryRecursive( std::istream& in, Node** node );
+    void readBinaryRecursive( std::istream& in, Node** node );
 
 protected:
     // Node classes
@@ -111,20 +176,26 @@ protected:
     {
     public:
         Branch();
-        Branch( const Branch& b );
-        ~Branch();
 
         const Node* child( int x, int y, int z ) const;
         Node*& child( int x, int y, int z );
         const Node* child( int index ) const;
         Node*& child( int index );
 
-        friend void Octree<T,AS>::deleteNode( Node** node );
+        const Summary& summary() const;
+        Summary& summary();
+
+        friend class Octree<T,AS,Allocator>;
 
     private:
+        ~Branch() {}
+        Branch( const Branch& b );
         Branch& operator= ( Branch b );
 
     private:
+        // Empty unless enabled by OctreeSummaryTraits<T>. The empty summary
+        // fits in the padding after the node type.
+        Summary summary_;
         Node* children[2][2][2];
     };
 
@@ -141,7 +212,7 @@ protected:
         T& value( int i );
         void setValue( int i, const T& v );
 
-        friend void Octree<T,AS>::deleteNode( Node** node );
+        friend class Octree<T,AS,Allocator>;
 
     private:
         ~Aggregate() {}
@@ -159,7 +230,7 @@ protected:
         T& value();
         void setValue( const T& v );
 
-        friend void Octree<T,AS>::deleteNode( Node** node );
+        friend class Octree<T,AS,Allocator>;
 
     private:
         ~Leaf() {}
@@ -174,6 +245,7 @@ private:
     Node* root_;
     T emptyValue_;
     int size_;
+    Allocator allocator_;
 };
 
 #include "octree.tcc"
@@ -17,6 +17,15 @@
 
 #include <cstring>
 
+#if defined(__GNUC__)
+#define OCTREE_PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#define OCTREE_PREFETCH(p) _mm_prefetch( reinterpret_cast<const char*>(p), _MM_HINT_T0 )
+#else
+#define OCTREE_PREFETCH(p) ((void)0)
+#endif
+
 /**
  * \class Octree
  * \brief Generic octree template
@@ -35,6 +44,16 @@
  * aggregated so that the relative size of pointers is diminished. This is 1 by
  * default, but should be set higher when the size of \a T is small. <b>Must be
  * a power of two.</b>
+ *
+ * \param Allocator Allocator policy of the nodes, see octreepool.h. The default
+ * OctreePool carves the nodes out of contiguous blocks and frees them all at
+ * once; OctreeHeap allocates each node with new.
+ *
+ * The branches may also cache a summary of their subtree (count, centroid and
+ * summed colour of the non-empty nodes), enabled per type through
+ * OctreeSummaryTraits, see octreesummary.h. set(), erase(), buildFromPoints()
+ * and readBinary() keep the summaries up to date; values written through the
+ * non-const operator() are not accounted for until refreshSummaries().
  */
 
 /**
@@ -48,8 +67,8 @@
  * octree root is initially a null pointer, the whole volume is initialized to
  * this value.
  */
-template< typename T, int AS >
-Octree<T,AS>::Octree( int size, const T& emptyValue )
+template< typename T, int AS, typename A >
+Octree<T,AS,A>::Octree( int size, const T& emptyValue )
     : root_(0)
     , emptyValue_(emptyValue)
     , size_(size)
@@ -65,56 +84,50 @@ Octree<T,AS>::Octree( int size, const T& emptyValue )
  *
  * \param o Octree to be copied.
  */
-template< typename T, int AS >
-Octree<T,AS>::Octree( const Octree<T,AS>& o )
-    : emptyValue_( o.emptyValue_ )
+template< typename T, int AS, typename A >
+Octree<T,AS,A>::Octree( const Octree<T,AS,A>& o )
+    : root_(0)
+    , emptyValue_( o.emptyValue_ )
     , size_( o.size_ )
 {
-    if ( !o.root_ ) {
-        root_ = 0;
-    } else {
-        switch ( o.root_->type() ) {
-            case BranchNode:
-                root_ = new Branch   ( *reinterpret_cast<Branch   *>(o.root_) );
-                break;
-            case LeafNode:
-                root_ = new Leaf     ( *reinterpret_cast<Leaf     *>(o.root_) );
-                break;
-            case AggregateNode:
-                root_ = new Aggregate( *reinterpret_cast<Aggregate*>(o.root_) );
-                break;
-        }
-    }
+    root_ = copyNode( o.root_ );
 }
 
 /**
  * Recursively deletes all nodes by following branch pointers.
+ *
+ * When the allocator releases all its memory at once and \a T has a trivial
+ * destructor, there is nothing to do per node: the nodes are freed along with
+ * the allocator's blocks, in time proportional to the number of blocks.
  */
-template< typename T, int AS >
-Octree<T,AS>::~Octree()
+template< typename T, int AS, typename A >
+Octree<T,AS,A>::~Octree()
 {
-    deleteNode(&root_);
+    if ( !( A::releasesAll && std::is_trivially_destructible<T>::value ) ) {
+        deleteNode(&root_);
+    }
 }
 
 /**
  * Swaps the octree's contents with another's. This is a cheap operation as only
  * the root pointers are swapped, not the whole structure.
  */
-template< typename T, int AS >
-void Octree<T,AS>::swap( Octree<T,AS>& o )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::swap( Octree<T,AS,A>& o )
 {
     std::swap( emptyValue_, o.emptyValue_ );  // This can throw.
 
     // These can't.
     std::swap( root_, o.root_ );
     std::swap( size_, o.size_ );
+    allocator_.swap( o.allocator_ );
 }
 
 /**
  * Assigns to this octree the contents of octree \a o.
  */
-template< typename T, int AS >
-Octree<T,AS>& Octree<T,AS>::operator= ( Octree<T,AS> o )
+template< typename T, int AS, typename A >
+Octree<T,AS,A>& Octree<T,AS,A>::operator= ( Octree<T,AS,A> o )
 {
     swap(o);
     return *this;
@@ -123,8 +136,8 @@ Octree<T,AS>& Octree<T,AS>::operator= ( Octree<T,AS> o )
 /**
  * \return Size of octree, in nodes, as specified in the constructor.
  */
-template< typename T, int AS >
-int Octree<T,AS>::size() const
+template< typename T, int AS, typename A >
+int Octree<T,AS,A>::size() const
 {
     return size_;
 }
@@ -133,8 +146,8 @@ int Octree<T,AS>::size() const
  * \return Value of empty nodes, as specified in the constructor.
  * \see setEmptyValue()
  */
-template< typename T, int AS >
-const T& Octree<T,AS>::emptyValue() const
+template< typename T, int AS, typename A >
+const T& Octree<T,AS,A>::emptyValue() const
 {
     return emptyValue_;
 }
@@ -143,40 +156,178 @@ const T& Octree<T,AS>::emptyValue() const
  * Sets the value of empty nodes to \a emptyValue.
  * \see setEmptyValue()
  */
-template< typename T, int AS >
-void Octree<T,AS>::setEmptyValue( const T& emptyValue )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::setEmptyValue( const T& emptyValue )
 {
     emptyValue_ = emptyValue;
 }
 
+/**
+ * Allocates a branch node with the allocator policy.
+ */
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Branch* Octree<T,AS,A>::newBranch()
+{
+    return new ( allocator_.allocate( sizeof(Branch) ) ) Branch;
+}
+
+/**
+ * Allocates an aggregate node whose values are all \a v with the allocator
+ * policy.
+ */
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Aggregate* Octree<T,AS,A>::newAggregate( const T& v )
+{
+    void* p = allocator_.allocate( sizeof(Aggregate) );
+    try {
+        return new (p) Aggregate(v);
+    }
+    catch (...) {
+        allocator_.deallocate( p, sizeof(Aggregate) );
+        throw;
+    }
+}
+
+/**
+ * Allocates a leaf node of value \a v with the allocator policy.
+ */
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Leaf* Octree<T,AS,A>::newLeaf( const T& v )
+{
+    void* p = allocator_.allocate( sizeof(Leaf) );
+    try {
+        return new (p) Leaf(v);
+    }
+    catch (...) {
+        allocator_.deallocate( p, sizeof(Leaf) );
+        throw;
+    }
+}
+
+/**
+ * \return Deep copy of \a node and its subtree, allocated with this octree's
+ * allocator.
+ */
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Node* Octree<T,AS,A>::copyNode( const Node* node )
+{
+    if ( !node ) {
+        return 0;
+    }
+
+    switch ( node->type() ) {
+        case BranchNode:
+            {
+                const Branch* b = reinterpret_cast<const Branch*>(node);
+                Node* copy = newBranch();
+                reinterpret_cast<Branch*>(copy)->summary() = b->summary();
+                try {
+                    for ( int i = 0; i < 8; ++i ) {
+                        reinterpret_cast<Branch*>(copy)->child(i) =
+                            copyNode( b->child(i) );
+                    }
+                }
+                catch (...) {
+                    deleteNode(&copy);
+                    throw;
+                }
+                return copy;
+            }
+
+        case AggregateNode:
+            {
+                const Aggregate* a = reinterpret_cast<const Aggregate*>(node);
+                Aggregate* copy = newAggregate( a->value(0) );
+                for ( int i = 1; i < AS*AS*AS; ++i ) {
+                    copy->setValue( i, a->value(i) );
+                }
+                return copy;
+            }
+
+        case LeafNode:
+            return newLeaf( reinterpret_cast<const Leaf*>(node)->value() );
+    }
+
+    return 0;
+}
+
 /**
  * Deletes a node polymorphically. If the node is a branch node, it will delete
  * all its subtree recursively.
  */
-template< typename T, int AS >
-void Octree<T,AS>::deleteNode( Node** node )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::deleteNode( Node** node )
 {
     assert(node);
     if (*node) {
         if ( (*node)->type() == BranchNode ) {
-            delete reinterpret_cast<Branch*>(*node);
+            Branch* b = reinterpret_cast<Branch*>(*node);
+            for ( int i = 0; i < 8; ++i ) {
+                assert( b->child(i) != b );
+                deleteNode( &b->child(i) );
+            }
+            b->~Branch();
+            allocator_.deallocate( b, sizeof(Branch) );
         }
         else if ( (*node)->type() == AggregateNode ) {
-            delete reinterpret_cast<Aggregate*>(*node);
+            Aggregate* a = reinterpret_cast<Aggregate*>(*node);
+            a->~Aggregate();
+            allocator_.deallocate( a, sizeof(Aggregate) );
         }
         else {
             assert( (*node)->type() == LeafNode );
-            delete reinterpret_cast<Leaf*>(*node);
+            Leaf* l = reinterpret_cast<Leaf*>(*node);
+            l->~Leaf();
+            allocator_.deallocate( l, sizeof(Leaf) );
         }
         *node = 0;
     }
 }
 
+/**
+ * Updates the summaries of the branches on the path of index (\a x, \a y,
+ * \a z) after its value changed from \a removed to \a added. Either may be
+ * null when the node was or is now empty.
+ */
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::updateSummaries( int x, int y, int z, const T* removed,
+        const T* added )
+{
+    if ( !Summary::enabled ) {
+        return;
+    }
+
+    float removedColor[3];
+    float addedColor[3];
+    if (removed) {
+        OctreeSummaryTraits<T>::color( *removed, removedColor );
+    }
+    if (added) {
+        OctreeSummaryTraits<T>::color( *added, addedColor );
+    }
+
+    Node* n = root_;
+    int size = size_;
+
+    while ( n && n->type() == BranchNode ) {
+        Branch* b = reinterpret_cast<Branch*>(n);
+        if (removed) {
+            b->summary().remove( x, y, z, removedColor );
+        }
+        if (added) {
+            b->summary().add( x, y, z, addedColor );
+        }
+
+        size /= 2;
+        n = b->child( !!(x & size), !!(y & size), !!(z & size) );
+    }
+}
+
 /**
  * \return Pointer to octree's root node.
  */
-template< typename T, int AS >
-typename Octree<T,AS>::Node*& Octree<T,AS>::root()
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Node*& Octree<T,AS,A>::root()
 {
     return root_;
 }
@@ -184,8 +335,8 @@ typename Octree<T,AS>::Node*& Octree<T,AS>::root()
 /**
  * Const version of above.
  */
-template< typename T, int AS >
-const typename Octree<T,AS>::Node* Octree<T,AS>::root() const
+template< typename T, int AS, typename A >
+const typename Octree<T,AS,A>::Node* Octree<T,AS,A>::root() const
 {
     return root_;
 }
@@ -210,8 +361,8 @@ const typename Octree<T,AS>::Node* Octree<T,AS>::root() const
  *
  * However, zSlice() provides an even faster way.
  */
-template< typename T, int AS >
-const T& Octree<T,AS>::at( int x, int y, int z ) const
+template< typename T, int AS, typename A >
+const T& Octree<T,AS,A>::at( int x, int y, int z ) const
 {
     assert( x >= 0 && x < size_ );
     assert( y >= 0 && y < size_ );
@@ -244,11 +395,91 @@ const T& Octree<T,AS>::at( int x, int y, int z ) const
             x & size, y & size, z & size );
 }
 
+/**
+ * Looks up the \a n indices (\a xs[i], \a ys[i], \a zs[i]) and stores in
+ * \a out[i] the address of the value at() would return for each.
+ *
+ * at() follows a chain of dependent loads, paying a full cache miss at each
+ * level when the tree does not fit in cache. Here the lookups are advanced
+ * by groups, one level at a time: the child each one descends into is
+ * prefetched, and loaded only once the rest of the group has been advanced.
+ * The misses of the independent lookups of a group thus overlap instead of
+ * adding up. This pays off for many scattered lookups, e.g. neighbour probes
+ * or cross-matching a catalog; for a few close lookups at() is as fast.
+ */
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::atBatch( const int* xs, const int* ys, const int* zs,
+        std::size_t n, const T** out ) const
+{
+    // Lookups in flight, enough to cover the memory latency.
+    enum { GroupSize = 16 };
+    const Node* nodes[GroupSize];
+
+    for ( std::size_t first = 0; first < n; first += GroupSize ) {
+        const int count = static_cast<int>(
+                std::min<std::size_t>( GroupSize, n - first ) );
+        const int* x = xs + first;
+        const int* y = ys + first;
+        const int* z = zs + first;
+        const T** o = out + first;
+
+        for ( int i = 0; i < count; ++i ) {
+            assert( x[i] >= 0 && x[i] < size_ );
+            assert( y[i] >= 0 && y[i] < size_ );
+            assert( z[i] >= 0 && z[i] < size_ );
+            o[i] = &emptyValue_;
+            nodes[i] = root_;
+        }
+
+        // nodes[i] is null once lookup i is resolved.
+        int size = size_;
+        bool active = root_ != 0;
+        while ( active && size != aggregateSize_ ) {
+            size /= 2;
+            active = false;
+            for ( int i = 0; i < count; ++i ) {
+                const Node* node = nodes[i];
+                if ( !node ) {
+                    continue;
+                }
+
+                if ( node->type() == BranchNode ) {
+                    node = reinterpret_cast<const Branch*>(node)->child(
+                            !!(x[i] & size), !!(y[i] & size), !!(z[i] & size) );
+                    if (node) {
+                        OCTREE_PREFETCH(node);
+                        active = true;
+                    }
+                    nodes[i] = node;
+                }
+                else {
+                    assert( node->type() == LeafNode );
+                    o[i] = &reinterpret_cast<const Leaf*>(node)->value();
+                    nodes[i] = 0;
+                }
+            }
+        }
+
+        if ( !active ) {
+            continue;
+        }
+
+        // The remaining lookups reached their aggregate.
+        const int mask = aggregateSize_ - 1;
+        for ( int i = 0; i < count; ++i ) {
+            if ( nodes[i] ) {
+                o[i] = &reinterpret_cast<const Aggregate*>(nodes[i])->value(
+                        x[i] & mask, y[i] & mask, z[i] & mask );
+            }
+        }
+    }
+}
+
 /**
  * Synonym of at().
  */
-template< typename T, int AS >
-const T& Octree<T,AS>::operator() ( int x, int y, int z ) const
+template< typename T, int AS, typename A >
+const T& Octree<T,AS,A>::operator() ( int x, int y, int z ) const
 {
     return at(x,y,z);
 }
@@ -263,8 +494,8 @@ const T& Octree<T,AS>::operator() ( int x, int y, int z ) const
  *
  * \see at()
  */
-template< typename T, int AS >
-T& Octree<T,AS>::operator() ( int x, int y, int z )
+template< typename T, int AS, typename A >
+T& Octree<T,AS,A>::operator() ( int x, int y, int z )
 {
     assert( x >= 0 && x < size_ );
     assert( y >= 0 && y < size_ );
@@ -275,7 +506,7 @@ T& Octree<T,AS>::operator() ( int x, int y, int z )
 
     while ( size != aggregateSize_ ) {
         if (!*n) {
-            *n = new Branch;
+            *n = newBranch();
         }
         else if ( (*n)->type() == BranchNode ) {
             size /= 2;
@@ -288,7 +519,7 @@ T& Octree<T,AS>::operator() ( int x, int y, int z )
     }
 
     if (!*n) {
-        *n = new Aggregate(emptyValue_);
+        *n = newAggregate(emptyValue_);
     }
 
     --size;
@@ -301,11 +532,18 @@ T& Octree<T,AS>::operator() ( int x, int y, int z )
  * the empty value, the node is erased. Otherwise, the node is created if it did
  * not already exist and its value is set to \a value.
  */
-template< typename T, int AS >
-void Octree<T,AS>::set( int x, int y, int z, const T& value )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::set( int x, int y, int z, const T& value )
 {
     if ( value != emptyValue() ) {
-        (*this)(x,y,z) = value;
+        if ( Summary::enabled ) {
+            const T old = at(x,y,z);
+            (*this)(x,y,z) = value;
+            updateSummaries( x, y, z, old != emptyValue_ ? &old : 0, &value );
+        }
+        else {
+            (*this)(x,y,z) = value;
+        }
     }
     else {
         erase(x,y,z);
@@ -321,21 +559,30 @@ void Octree<T,AS>::set( int x, int y, int z, const T& value )
  * replaced by a null pointer in its parent. This will percolate to the top of
  * the tree if necessary.
  */
-template< typename T, int AS >
-void Octree<T,AS>::erase( int x, int y, int z )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::erase( int x, int y, int z )
 {
     assert( x >= 0 && x < size_ );
     assert( y >= 0 && y < size_ );
     assert( z >= 0 && z < size_ );
 
-    eraseRecursive( &root_, size_, x, y, z );
+    if ( Summary::enabled ) {
+        const T old = at(x,y,z);
+        eraseRecursive( &root_, size_, x, y, z );
+        if ( old != emptyValue_ ) {
+            updateSummaries( x, y, z, &old, 0 );
+        }
+    }
+    else {
+        eraseRecursive( &root_, size_, x, y, z );
+    }
 }
 
 /**
  * Helper function for erase() method.
  */
-template< typename T, int AS >
-void Octree<T,AS>::eraseRecursive( Node** node, int size, int x, int y, int z )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::eraseRecursive( Node** node, int size, int x, int y, int z )
 {
     assert(node);
 
@@ -361,22 +608,27 @@ void Octree<T,AS>::eraseRecursive( Node** node, int size, int x, int y, int z )
             deleteNode(node);
         }
         else {
-            Branch* b = new Branch;
+            // Split the leaf into 8 uniform children, then erase the node in
+            // the one containing it.
+            Branch* b = newBranch();
+            const T& value = reinterpret_cast<Leaf*>(*node)->value();
+            if ( Summary::enabled ) {
+                float color[3];
+                OctreeSummaryTraits<T>::color( value, color );
+                b->summary().addUniform( x & ~(size - 1), y & ~(size - 1),
+                        z & ~(size - 1), size, color );
+            }
             size /= 2;
             int childIndex = ( x & size ? 1 : 0 )
                            | ( y & size ? 2 : 0 )
                            | ( z & size ? 4 : 0 );
-            const T& value = reinterpret_cast<Leaf*>(*node)->value();
             try {
                 for ( int i = 0; i < 8; ++i ) {
-                    if ( i == childIndex ) {
-                        continue;
-                    }
                     if ( size == aggregateSize_ ) {
-                        b->child(i) = new Leaf(value);
+                        b->child(i) = newAggregate(value);
                     }
                     else {
-                        b->child(i) = new Aggregate(value);
+                        b->child(i) = newLeaf(value);
                     }
                 }
             }
@@ -388,7 +640,7 @@ void Octree<T,AS>::eraseRecursive( Node** node, int size, int x, int y, int z )
 
             deleteNode(node);
             *node = b;
-            node = &b->child(childIndex);
+            eraseRecursive( &b->child(childIndex), size, x, y, z );
         }
     }
     else {
@@ -405,11 +657,376 @@ void Octree<T,AS>::eraseRecursive( Node** node, int size, int x, int y, int z )
     }
 }
 
+/**
+ * Replaces the contents of the octree with the points of the random access
+ * range [\a first, \a last). Each element gives (x, y, z, value) through
+ * <code>std::get<0></code> to <code>std::get<3></code>, e.g.
+ * <code>std::tuple<int,int,int,T></code>. Points whose value is the empty value
+ * are ignored and, as with successive set() calls, the last of several points
+ * with the same index wins.
+ *
+ * The points are sorted by Morton code in parallel (see Morton::sortPoints()),
+ * which is the depth-first order of the tree. The tree is then built in one
+ * pass: consecutive points share the ancestry down to their first differing
+ * level, so each node is allocated exactly once and never revisited. This is
+ * much faster than inserting the points one by one with operator().
+ */
+template< typename T, int AS, typename A >
+template< typename Iterator >
+void Octree<T,AS,A>::buildFromPoints( Iterator first, Iterator last )
+{
+    const std::vector<Morton::Entry> entries =
+        Morton::sortPoints( first, last );
+
+    Octree<T,AS,A> tmp( size_, emptyValue_ );
+
+    // Depth of the aggregates, and of the whole tree in Morton bits.
+    int levels = 0;
+    while ( ( aggregateSize_ << levels ) < size_ ) {
+        ++levels;
+    }
+    int bits = levels;
+    while ( ( 1 << bits ) < size_ ) {
+        ++bits;
+    }
+
+    // path[d] is the slot of the node of depth d on the path of the last
+    // point, path[0] being the root.
+    std::vector<Node**> path( levels + 1 );
+    path[0] = &tmp.root_;
+
+    bool firstPoint = true;
+    Morton::Code previous = 0;
+
+    for ( std::size_t i = 0; i < entries.size(); ++i ) {
+        // Only the last duplicate is kept.
+        if ( i + 1 < entries.size() && entries[i+1].code == entries[i].code ) {
+            continue;
+        }
+
+        const Morton::Code code = entries[i].code;
+        const T& value = std::get<3>( *( first + entries[i].index ) );
+        if ( value == emptyValue_ ) {
+            continue;
+        }
+
+        // Deepest node shared with the previous point.
+        int shared = -1;
+        if ( !firstPoint ) {
+            shared = 0;
+            while ( shared < levels &&
+                    ( code >> 3 * ( bits - shared - 1 ) ) ==
+                    ( previous >> 3 * ( bits - shared - 1 ) ) ) {
+                ++shared;
+            }
+        }
+
+        for ( int d = std::max( shared, 0 ); d < levels; ++d ) {
+            if ( d > shared ) {
+                *path[d] = tmp.newBranch();
+            }
+            int childIndex = ( code >> 3 * ( bits - d - 1 ) ) & 7;
+            path[d+1] = &reinterpret_cast<Branch*>(*path[d])->child(childIndex);
+        }
+
+        if ( !*path[levels] ) {
+            *path[levels] = tmp.newAggregate(emptyValue_);
+        }
+
+        int x, y, z;
+        Morton::decode( code, x, y, z );
+        reinterpret_cast<Aggregate*>(*path[levels])->setValue(
+                x & ( aggregateSize_ - 1 ), y & ( aggregateSize_ - 1 ),
+                z & ( aggregateSize_ - 1 ), value );
+
+        previous = code;
+        firstPoint = false;
+    }
+
+    tmp.refreshSummaries();
+    swap(tmp);
+}
+
+/**
+ * Moves values between indices in one pass, for objects moving every frame.
+ * Each element of the random access range [\a first, \a last) gives the
+ * value, its old index and its new index through <code>std::get<0></code> to
+ * <code>std::get<2></code>, the indices giving x, y and z through
+ * <code>operator[]</code>, e.g.
+ * <code>std::tuple<T,glm::ivec3,glm::ivec3></code>.
+ *
+ * The old indices are erased first, each only if it still holds its value,
+ * then the values are set at the new indices: a value may move into an index
+ * left by another one in the same batch. As with buildFromPoints(), the last
+ * of several values moving to the same index wins; the value already at a new
+ * index, if any, is overwritten. The moves whose indices are the same are
+ * skipped.
+ *
+ * The erasures and the insertions are sorted by Morton code on the calling
+ * thread (see Morton::sortMoves()), then applied in a single descent of the
+ * tree which only enters the subtrees they fall in, allocating and freeing the
+ * nodes on the way, and refreshes the summaries of the branches it went
+ * through. This is much faster than an erase() and a set() per move, each of
+ * which walks the tree from the root twice.
+ */
+template< typename T, int AS, typename A >
+template< typename Iterator >
+void Octree<T,AS,A>::relocate( Iterator first, Iterator last )
+{
+    std::vector< std::pair<Morton::Code,T> > erasures;
+    std::vector< std::pair<Morton::Code,T> > insertions;
+    Morton::sortMoves<T>( first, last, erasures, insertions );
+
+    if ( erasures.empty() ) {
+        return;
+    }
+
+    relocateRecursive( &root_, size_, 0, 0, 0,
+            erasures.data(), erasures.data() + erasures.size(),
+            insertions.data(), insertions.data() + insertions.size() );
+}
+
+/**
+ * Helper function for relocate() method. Applies the sorted erasures and
+ * insertions that fall in \a node, whose lowest index is (\a x, \a y, \a z).
+ */
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::relocateRecursive( Node** node, int size,
+        int x, int y, int z,
+        const std::pair<Morton::Code,T>* erasuresFirst,
+        const std::pair<Morton::Code,T>* erasuresLast,
+        const std::pair<Morton::Code,T>* insertionsFirst,
+        const std::pair<Morton::Code,T>* insertionsLast )
+{
+    if ( erasuresFirst == erasuresLast && insertionsFirst == insertionsLast ) {
+        return;
+    }
+
+    if ( size == aggregateSize_ ) {
+        Aggregate* a = reinterpret_cast<Aggregate*>(*node);
+        const int mask = size - 1;
+        int cx, cy, cz;
+
+        for ( const std::pair<Morton::Code,T>* e = erasuresFirst;
+                e != erasuresLast && a; ++e ) {
+            Morton::decode( e->first, cx, cy, cz );
+            if ( a->value( cx & mask, cy & mask, cz & mask ) == e->second ) {
+                a->setValue( cx & mask, cy & mask, cz & mask, emptyValue_ );
+            }
+        }
+
+        for ( const std::pair<Morton::Code,T>* i = insertionsFirst;
+                i != insertionsLast; ++i ) {
+            if ( i->second == emptyValue_ ) {
+                continue;
+            }
+            if ( !a ) {
+                *node = a = newAggregate(emptyValue_);
+            }
+            Morton::decode( i->first, cx, cy, cz );
+            a->setValue( cx & mask, cy & mask, cz & mask, i->second );
+        }
+
+        if (a) {
+            for ( int i = 0; i < AS*AS*AS; ++i ) {
+                if ( a->value(i) != emptyValue_ ) {
+                    return;
+                }
+            }
+            deleteNode(node);
+        }
+        return;
+    }
+
+    if ( *node && (*node)->type() == LeafNode ) {
+        const T value = reinterpret_cast<Leaf*>(*node)->value();
+        if ( value == emptyValue_ ) {
+            deleteNode(node);
+        }
+        else {
+            // Split the leaf into 8 uniform children, the moves then go down
+            // into them.
+            Branch* b = newBranch();
+            try {
+                for ( int i = 0; i < 8; ++i ) {
+                    if ( size / 2 == aggregateSize_ ) {
+                        b->child(i) = newAggregate(value);
+                    }
+                    else {
+                        b->child(i) = newLeaf(value);
+                    }
+                }
+            }
+            catch (...) {
+                Node* bb = b;
+                deleteNode(&bb);
+                throw;
+            }
+
+            deleteNode(node);
+            *node = b;
+        }
+    }
+
+    if ( !*node ) {
+        if ( insertionsFirst == insertionsLast ) {
+            return;
+        }
+        *node = newBranch();
+    }
+
+    Branch* b = reinterpret_cast<Branch*>(*node);
+    size /= 2;
+    int shift = 0;
+    while ( ( 1 << shift ) < size ) {
+        ++shift;
+    }
+    shift *= 3;
+
+    // The moves of each child are the next contiguous ranges of the arrays.
+    for ( int c = 0; c < 8; ++c ) {
+        const std::pair<Morton::Code,T>* erasuresEnd = erasuresFirst;
+        while ( erasuresEnd != erasuresLast &&
+                static_cast<int>( erasuresEnd->first >> shift & 7 ) == c ) {
+            ++erasuresEnd;
+        }
+        const std::pair<Morton::Code,T>* insertionsEnd = insertionsFirst;
+        while ( insertionsEnd != insertionsLast &&
+                static_cast<int>( insertionsEnd->first >> shift & 7 ) == c ) {
+            ++insertionsEnd;
+        }
+
+        relocateRecursive( &b->child(c), size,
+                x + ( c & 1 ? size : 0 ),
+                y + ( c & 2 ? size : 0 ),
+                z + ( c & 4 ? size : 0 ),
+                erasuresFirst, erasuresEnd, insertionsFirst, insertionsEnd );
+
+        erasuresFirst = erasuresEnd;
+        insertionsFirst = insertionsEnd;
+    }
+
+    bool empty = true;
+    for ( int c = 0; c < 8 && empty; ++c ) {
+        empty = !b->child(c);
+    }
+    if (empty) {
+        deleteNode(node);
+        return;
+    }
+
+    if ( Summary::enabled ) {
+        Summary s;
+        for ( int c = 0; c < 8; ++c ) {
+            s.add( summaryOf( b->child(c), size,
+                        x + ( c & 1 ? size : 0 ),
+                        y + ( c & 2 ? size : 0 ),
+                        z + ( c & 4 ? size : 0 ) ) );
+        }
+        b->summary() = s;
+    }
+}
+
+/**
+ * Recomputes the summaries of all the branches from their subtrees, in time
+ * proportional to the number of nodes. Only needed after writing values
+ * through the non-const operator(), the other mutators keep them up to date.
+ */
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::refreshSummaries()
+{
+    if ( Summary::enabled ) {
+        refreshSummariesRecursive( root_, size_, 0, 0, 0 );
+    }
+}
+
+/**
+ * Helper function for refreshSummaries() method. \return Summary of \a node.
+ */
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Summary Octree<T,AS,A>::refreshSummariesRecursive(
+        Node* node, int size, int x, int y, int z )
+{
+    if ( !node || node->type() != BranchNode ) {
+        return summaryOf( node, size, x, y, z );
+    }
+
+    Branch* b = reinterpret_cast<Branch*>(node);
+    Summary s;
+    size /= 2;
+    for ( int i = 0; i < 8; ++i ) {
+        s.add( refreshSummariesRecursive( b->child(i), size,
+                    x + ( i & 1 ? size : 0 ),
+                    y + ( i & 2 ? size : 0 ),
+                    z + ( i & 4 ? size : 0 ) ) );
+    }
+    b->summary() = s;
+
+    return s;
+}
+
+/**
+ * \return Summary of the whole octree, see OctreeSummary.
+ */
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Summary Octree<T,AS,A>::summary() const
+{
+    return summaryOf( root_, size_, 0, 0, 0 );
+}
+
+/**
+ * \return Summary of \a node, whose lowest index is (\a x, \a y, \a z). It is
+ * cached by branches and computed on the fly for aggregates and leaves.
+ */
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Summary Octree<T,AS,A>::summaryOf( const Node* node,
+        int size, int x, int y, int z ) const
+{
+    Summary s;
+    if ( !node ) {
+        return s;
+    }
+
+    float color[3];
+    switch ( node->type() ) {
+        case BranchNode:
+            s = reinterpret_cast<const Branch*>(node)->summary();
+            break;
+
+        case AggregateNode:
+            for ( int k = 0; k < size; ++k ) {
+                for ( int j = 0; j < size; ++j ) {
+                    for ( int i = 0; i < size; ++i ) {
+                        const T& value = reinterpret_cast<const Aggregate*>(
+                                node)->value( i, j, k );
+                        if ( value != emptyValue_ ) {
+                            OctreeSummaryTraits<T>::color( value, color );
+                            s.add( x + i, y + j, z + k, color );
+                        }
+                    }
+                }
+            }
+            break;
+
+        case LeafNode:
+            {
+                const T& value = reinterpret_cast<const Leaf*>(node)->value();
+                if ( value != emptyValue_ ) {
+                    OctreeSummaryTraits<T>::color( value, color );
+                    s.addUniform( x, y, z, size, color );
+                }
+            }
+            break;
+    }
+
+    return s;
+}
+
 /**
  * \return Number of bytes a branch node occupies.
  */
-template< typename T, int AS >
-unsigned long Octree<T,AS>::branchBytes()
+template< typename T, int AS, typename A >
+unsigned long Octree<T,AS,A>::branchBytes()
 {
     return sizeof(Branch);
 }
@@ -417,8 +1034,8 @@ unsigned long Octree<T,AS>::branchBytes()
 /**
  * \return Number of bytes an aggregate node occupies.
  */
-template< typename T, int AS >
-unsigned long Octree<T,AS>::aggregateBytes()
+template< typename T, int AS, typename A >
+unsigned long Octree<T,AS,A>::aggregateBytes()
 {
     return sizeof(Aggregate);
 }
@@ -426,8 +1043,8 @@ unsigned long Octree<T,AS>::aggregateBytes()
 /**
  * \return Number of bytes a leaf node occupies.
  */
-template< typename T, int AS >
-unsigned long Octree<T,AS>::leafBytes()
+template< typename T, int AS, typename A >
+unsigned long Octree<T,AS,A>::leafBytes()
 {
     return sizeof(Leaf);
 }
@@ -435,8 +1052,8 @@ unsigned long Octree<T,AS>::leafBytes()
 /**
  * \return Total number of nodes in the octree.
  */
-template< typename T, int AS >
-int Octree<T,AS>::nodes() const
+template< typename T, int AS, typename A >
+int Octree<T,AS,A>::nodes() const
 {
     return nodesRecursive(root_);
 }
@@ -444,8 +1061,8 @@ int Octree<T,AS>::nodes() const
 /**
  * Helper function for nodes() method.
  */
-template< typename T, int AS >
-int Octree<T,AS>::nodesRecursive( const Node* node )
+template< typename T, int AS, typename A >
+int Octree<T,AS,A>::nodesRecursive( const Node* node )
 {
     if ( !node ) {
         return 0;
@@ -463,22 +1080,23 @@ int Octree<T,AS>::nodesRecursive( const Node* node )
 }
 
 /**
- * \return Total number of bytes the octree occupies.
+ * \return Total number of bytes the octree occupies, including the memory the
+ * allocator holds on top of the live nodes (see Allocator::overheadBytes()).
  *
- * \remarks Memory fragmentation may make the actual memory usage significantly
- * higher.
+ * \remarks With OctreeHeap, memory fragmentation may make the actual memory
+ * usage significantly higher.
  */
-template< typename T, int AS >
-unsigned long Octree<T,AS>::bytes() const
+template< typename T, int AS, typename A >
+unsigned long Octree<T,AS,A>::bytes() const
 {
-    return bytesRecursive(root_) + sizeof(*this);
+    return bytesRecursive(root_) + sizeof(*this) + allocator_.overheadBytes();
 }
 
 /**
  * Helper function for bytes() method.
  */
-template< typename T, int AS >
-unsigned long Octree<T,AS>::bytesRecursive( const Node* node )
+template< typename T, int AS, typename A >
+unsigned long Octree<T,AS,A>::bytesRecursive( const Node* node )
 {
     if ( !node ) {
         return 0;
@@ -514,8 +1132,8 @@ unsigned long Octree<T,AS>::bytesRecursive( const Node* node )
  * For sizes lower than the aggregate size, this function will always return
  * zero.
  */
-template< typename T, int AS >
-int Octree<T,AS>::nodesAtSize( int size ) const
+template< typename T, int AS, typename A >
+int Octree<T,AS,A>::nodesAtSize( int size ) const
 {
     return nodesAtSizeRecursive( size, size_, root_ );
 }
@@ -523,8 +1141,8 @@ int Octree<T,AS>::nodesAtSize( int size ) const
 /**
  * Helper function for nodesAtSize() method.
  */
-template< typename T, int AS >
-int Octree<T,AS>::nodesAtSizeRecursive( int targetSize, int size, Node* node )
+template< typename T, int AS, typename A >
+int Octree<T,AS,A>::nodesAtSizeRecursive( int targetSize, int size, Node* node )
 {
     if (node) {
         if ( size == targetSize ) {
@@ -548,67 +1166,27 @@ int Octree<T,AS>::nodesAtSizeRecursive( int targetSize, int size, Node* node )
     return 0;
 }
 
-template< typename T, int AS >
-Octree<T,AS>::Node::Node( NodeType type )
+template< typename T, int AS, typename A >
+Octree<T,AS,A>::Node::Node( NodeType type )
     : type_(type)
 {
 }
 
-template< typename T, int AS >
-typename Octree<T,AS>::NodeType Octree<T,AS>::Node::type() const
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::NodeType Octree<T,AS,A>::Node::type() const
 {
     return type_;
 }
 
-template< typename T, int AS >
-Octree<T,AS>::Branch::Branch()
+template< typename T, int AS, typename A >
+Octree<T,AS,A>::Branch::Branch()
     : Node(BranchNode)
 {
     memset( children, 0, sizeof(children) );
 }
 
-template< typename T, int AS >
-Octree<T,AS>::Branch::Branch( const Branch& b )
-    : Node(BranchNode)
-{
-    for ( int i = 0; i < 8; ++i ) {
-        if ( b.child(i) ) {
-            switch ( b.child(i)->type() ) {
-                case BranchNode:
-                    child(i) = new Branch(
-                            *reinterpret_cast<const Branch   *>(b.child(i)) );
-                    break;
-                case LeafNode:
-                    child(i) = new Leaf(
-                            *reinterpret_cast<const Leaf     *>(b.child(i)) );
-                    break;
-                case AggregateNode:
-                    child(i) = new Aggregate(
-                            *reinterpret_cast<const Aggregate*>(b.child(i)) );
-                    break;
-            }
-        }
-        else {
-            child(i) = 0;
-        }
-    }
-}
-
-template< typename T, int AS >
-Octree<T,AS>::Branch::~Branch()
-{
-    for ( int i = 0; i < 2; ++i ) {
-        for ( int j = 0; j < 2; ++j ) {
-            for ( int k = 0; k < 2; ++k ) {
-                assert( children[i][j][k] != this );
-                deleteNode( &children[i][j][k] );
-            }
-        }
-    }
-}
-
-template< typename T, int AS >
-const typename Octree<T,AS>::Node* Octree<T,AS>::Branch::child(
+template< typename T, int AS, typename A >
+const typename Octree<T,AS,A>::Node* Octree<T,AS,A>::Branch::child(
         int x, int y, int z ) const
 {
     assert( x == 0 || x == 1 );
@@ -617,8 +1195,8 @@ const typename Octree<T,AS>::Node* Octree<T,AS>::Branch::child(
     return children[z][y][x];
 }
 
-template< typename T, int AS >
-typename Octree<T,AS>::Node*& Octree<T,AS>::Branch::child( int x, int y, int z )
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Node*& Octree<T,AS,A>::Branch::child( int x, int y, int z )
 {
     assert( x == 0 || x == 1 );
     assert( y == 0 || y == 1 );
@@ -626,23 +1204,35 @@ typename Octree<T,AS>::Node*& Octree<T,AS>::Branch::child( int x, int y, int z )
     return children[z][y][x];
 }
 
-template< typename T, int AS >
-const typename Octree<T,AS>::Node* Octree<T,AS>::Branch::child( int index )
+template< typename T, int AS, typename A >
+const typename Octree<T,AS,A>::Node* Octree<T,AS,A>::Branch::child( int index )
     const
 {
     assert( index >= 0 && index < 8 );
     return *( &children[0][0][0] + index );
 }
 
-template< typename T, int AS >
-typename Octree<T,AS>::Node*& Octree<T,AS>::Branch::child( int index )
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Node*& Octree<T,AS,A>::Branch::child( int index )
 {
     assert( index >= 0 && index < 8 );
     return *( &children[0][0][0] + index );
 }
 
-template< typename T, int AS >
-Octree<T,AS>::Aggregate::Aggregate( const T& v )
+template< typename T, int AS, typename A >
+const typename Octree<T,AS,A>::Summary& Octree<T,AS,A>::Branch::summary() const
+{
+    return summary_;
+}
+
+template< typename T, int AS, typename A >
+typename Octree<T,AS,A>::Summary& Octree<T,AS,A>::Branch::summary()
+{
+    return summary_;
+}
+
+template< typename T, int AS, typename A >
+Octree<T,AS,A>::Aggregate::Aggregate( const T& v )
     : Node(AggregateNode)
 {
     for ( int i = 0; i < AS; ++i ) {
@@ -654,8 +1244,8 @@ Octree<T,AS>::Aggregate::Aggregate( const T& v )
     }
 }
 
-template< typename T, int AS >
-const T& Octree<T,AS>::Aggregate::value( int x, int y, int z ) const
+template< typename T, int AS, typename A >
+const T& Octree<T,AS,A>::Aggregate::value( int x, int y, int z ) const
 {
     assert( x >= 0 && x < AS );
     assert( y >= 0 && y < AS );
@@ -664,8 +1254,8 @@ const T& Octree<T,AS>::Aggregate::value( int x, int y, int z ) const
     return value_[z][y][x];
 }
 
-template< typename T, int AS >
-T& Octree<T,AS>::Aggregate::value( int x, int y, int z )
+template< typename T, int AS, typename A >
+T& Octree<T,AS,A>::Aggregate::value( int x, int y, int z )
 {
     assert( x >= 0 && x < AS );
     assert( y >= 0 && y < AS );
@@ -674,8 +1264,8 @@ T& Octree<T,AS>::Aggregate::value( int x, int y, int z )
     return value_[z][y][x];
 }
 
-template< typename T, int AS >
-void Octree<T,AS>::Aggregate::setValue( int x, int y, int z, const T& v )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::Aggregate::setValue( int x, int y, int z, const T& v )
 {
     assert( x >= 0 && x < AS );
     assert( y >= 0 && y < AS );
@@ -684,51 +1274,51 @@ void Octree<T,AS>::Aggregate::setValue( int x, int y, int z, const T& v )
     value_[z][y][x] = v;
 }
 
-template< typename T, int AS >
-const T& Octree<T,AS>::Aggregate::value( int i ) const
+template< typename T, int AS, typename A >
+const T& Octree<T,AS,A>::Aggregate::value( int i ) const
 {
     assert( i >= 0 && i < AS*AS*AS );
 
     return *( &value_[0][0][0] + i );
 }
 
-template< typename T, int AS >
-T& Octree<T,AS>::Aggregate::value( int i )
+template< typename T, int AS, typename A >
+T& Octree<T,AS,A>::Aggregate::value( int i )
 {
     assert( i >= 0 && i < AS*AS*AS );
 
     return *( &value_[0][0][0] + i );
 }
 
-template< typename T, int AS >
-void Octree<T,AS>::Aggregate::setValue( int i, const T& v )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::Aggregate::setValue( int i, const T& v )
 {
     assert( i >= 0 && i < AS*AS*AS );
 
     *( &value_[0][0][0] + i ) = v;
 }
 
-template< typename T, int AS >
-Octree<T,AS>::Leaf::Leaf( const T& v )
+template< typename T, int AS, typename A >
+Octree<T,AS,A>::Leaf::Leaf( const T& v )
     : Node(LeafNode)
     , value_(v)
 {
 }
 
-template< typename T, int AS >
-const T& Octree<T,AS>::Leaf::value() const
+template< typename T, int AS, typename A >
+const T& Octree<T,AS,A>::Leaf::value() const
 {
     return value_;
 }
 
-template< typename T, int AS >
-T& Octree<T,AS>::Leaf::value()
+template< typename T, int AS, typename A >
+T& Octree<T,AS,A>::Leaf::value()
 {
     return value_;
 }
 
-template< typename T, int AS >
-void Octree<T,AS>::Leaf::setValue( const T& v )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::Leaf::setValue( const T& v )
 {
     value_ = v;
 }
@@ -756,8 +1346,8 @@ void Octree<T,AS>::Leaf::setValue( const T& v )
  * }
  * \endcode
  */
-template< typename T, int AS >
-Array2D<T> Octree<T,AS>::zSlice( int z ) const
+template< typename T, int AS, typename A >
+Array2D<T> Octree<T,AS,A>::zSlice( int z ) const
 {
     assert( z >= 0 && z < size_ );
 
@@ -770,8 +1360,8 @@ Array2D<T> Octree<T,AS>::zSlice( int z ) const
 /**
  * Helper function for zSlice() method.
  */
-template< typename T, int AS >
-void Octree<T,AS>::zSliceRecursive( Array2D<T> slice, const Node* node,
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::zSliceRecursive( Array2D<T> slice, const Node* node,
         int size, int x, int y, int z, int targetZ ) const
 {
     if (!node) {
@@ -797,7 +1387,7 @@ void Octree<T,AS>::zSliceRecursive( Array2D<T> slice, const Node* node,
         for ( int i = 0; i < slice.M(); ++i ) {
             for ( int j = 0; j < slice.N(); ++j ) {
                 slice(i,j) = reinterpret_cast<const Aggregate*>(node)->value(
-                        j, i, targetZ - z & (size-1) );
+                        j, i, ( targetZ - z ) & (size-1) );
             }
         }
     }
@@ -811,6 +1401,321 @@ void Octree<T,AS>::zSliceRecursive( Array2D<T> slice, const Node* node,
     }
 }
 
+/**
+ * Calls \a visit for every non-empty node whose index lies in the box
+ * [\a x0,\a x1) x [\a y0,\a y1) x [\a z0,\a z1). The box is clipped to the
+ * octree bounds.
+ *
+ * The visitor is called as <code>visit(x, y, z, value)</code> with \a value
+ * being a const reference to the stored value. Subtrees are visited depth
+ * first, their children in child-index (Morton) order, and the indices within
+ * an aggregate or a leaf with \a x varying the quickest, then \a y, then \a z.
+ * Subtrees that are not allocated or that do not intersect the box are
+ * skipped entirely. The cost is therefore proportional to the number of
+ * allocated nodes in the box, not its volume:
+ *
+ * \code
+ * octree.visitBox( 0, 0, 0, 16, 16, 16,
+ *         []( int x, int y, int z, const T& value ) { ... } );
+ * \endcode
+ */
+template< typename T, int AS, typename A >
+template< typename Visitor >
+void Octree<T,AS,A>::visitBox( int x0, int y0, int z0, int x1, int y1, int z1,
+        Visitor visit ) const
+{
+    x0 = std::max( x0, 0 );
+    y0 = std::max( y0, 0 );
+    z0 = std::max( z0, 0 );
+    x1 = std::min( x1, size_ );
+    y1 = std::min( y1, size_ );
+    z1 = std::min( z1, size_ );
+
+    if ( x0 >= x1 || y0 >= y1 || z0 >= z1 ) {
+        return;
+    }
+
+    visitBoxRecursive( root_, size_, 0, 0, 0, x0, y0, z0, x1, y1, z1, visit );
+}
+
+/**
+ * Helper function for visitBox() method. (\a x, \a y, \a z) is the index of the
+ * lowest corner of \a node, which spans \a size indices along each axis.
+ */
+template< typename T, int AS, typename A >
+template< typename Visitor >
+void Octree<T,AS,A>::visitBoxRecursive( const Node* node, int size,
+        int x, int y, int z, int x0, int y0, int z0, int x1, int y1, int z1,
+        Visitor& visit ) const
+{
+    if ( !node ) {
+        return;
+    }
+
+    if ( x + size <= x0 || x >= x1 ||
+         y + size <= y0 || y >= y1 ||
+         z + size <= z0 || z >= z1 ) {
+        return;
+    }
+
+    switch ( node->type() ) {
+        case BranchNode:
+            {
+                const Branch* b = reinterpret_cast<const Branch*>(node);
+                size /= 2;
+                for ( int i = 0; i < 8; ++i ) {
+                    visitBoxRecursive( b->child(i), size,
+                            x + ( i & 1 ? size : 0 ),
+                            y + ( i & 2 ? size : 0 ),
+                            z + ( i & 4 ? size : 0 ),
+                            x0, y0, z0, x1, y1, z1, visit );
+                }
+            }
+            break;
+
+        case AggregateNode:
+            {
+                const Aggregate* a = reinterpret_cast<const Aggregate*>(node);
+                for ( int k = std::max( z, z0 ); k < std::min( z + size, z1 ); ++k ) {
+                    for ( int j = std::max( y, y0 ); j < std::min( y + size, y1 ); ++j ) {
+                        for ( int i = std::max( x, x0 ); i < std::min( x + size, x1 ); ++i ) {
+                            const T& value = a->value( i - x, j - y, k - z );
+                            if ( value != emptyValue_ ) {
+                                visit( i, j, k, value );
+                            }
+                        }
+                    }
+                }
+            }
+            break;
+
+        case LeafNode:
+            {
+                const T& value = reinterpret_cast<const Leaf*>(node)->value();
+                if ( value == emptyValue_ ) {
+                    return;
+                }
+                for ( int k = std::max( z, z0 ); k < std::min( z + size, z1 ); ++k ) {
+                    for ( int j = std::max( y, y0 ); j < std::min( y + size, y1 ); ++j ) {
+                        for ( int i = std::max( x, x0 ); i < std::min( x + size, x1 ); ++i ) {
+                            visit( i, j, k, value );
+                        }
+                    }
+                }
+            }
+            break;
+    }
+}
+
+/**
+ * Calls \a visit for every non-empty node that may be inside the convex volume
+ * bounded by \a planes, typically the six planes of the view frustum. A plane
+ * (a, b, c, d) keeps the points where a*x + b*y + c*z + d >= 0; at most 32
+ * planes are supported.
+ *
+ * The node of index (x, y, z) is taken as the box [x, x+1]^3 grown by
+ * \a margin on every side, so that objects centered on the index with a half
+ * size up to \a margin are kept. Subtrees outside one of the planes are
+ * skipped, and subtrees inside all of them are visited without any further
+ * test. The visitor is called as in visitBox().
+ */
+template< typename T, int AS, typename A >
+template< typename Visitor >
+void Octree<T,AS,A>::visitFrustum( const float planes[][4], int planeCount,
+        float margin, Visitor visit ) const
+{
+    assert( planeCount >= 0 && planeCount <= 32 );
+
+    unsigned int planeMask = planeCount == 32 ? ~0u : ( 1u << planeCount ) - 1;
+    visitFrustumRecursive( root_, size_, 0, 0, 0, planes, planeMask, margin,
+            visit );
+}
+
+/**
+ * Helper function for visitFrustum() method. \a planeMask holds the planes the
+ * parent of \a node was not entirely inside of.
+ */
+template< typename T, int AS, typename A >
+template< typename Visitor >
+void Octree<T,AS,A>::visitFrustumRecursive( const Node* node, int size,
+        int x, int y, int z, const float planes[][4], unsigned int planeMask,
+        float margin, Visitor& visit ) const
+{
+    if ( !node ) {
+        return;
+    }
+
+    unsigned int remaining;
+    if ( !OctreeFrustum::classify( planes, planeMask,
+                x - margin, y - margin, z - margin,
+                x + size + margin, y + size + margin, z + size + margin,
+                remaining ) ) {
+        return;
+    }
+
+    if ( remaining == 0 ) {
+        visitBoxRecursive( node, size, x, y, z,
+                x, y, z, x + size, y + size, z + size, visit );
+        return;
+    }
+
+    // The planes of a single cell are not needed further down.
+    unsigned int cellRemaining;
+
+    switch ( node->type() ) {
+        case BranchNode:
+            {
+                const Branch* b = reinterpret_cast<const Branch*>(node);
+                size /= 2;
+                for ( int i = 0; i < 8; ++i ) {
+                    visitFrustumRecursive( b->child(i), size,
+                            x + ( i & 1 ? size : 0 ),
+                            y + ( i & 2 ? size : 0 ),
+                            z + ( i & 4 ? size : 0 ),
+                            planes, remaining, margin, visit );
+                }
+            }
+            break;
+
+        case AggregateNode:
+        case LeafNode:
+            for ( int k = z; k < z + size; ++k ) {
+                for ( int j = y; j < y + size; ++j ) {
+                    for ( int i = x; i < x + size; ++i ) {
+                        const T& value = node->type() == AggregateNode
+                            ? reinterpret_cast<const Aggregate*>(node)->value(
+                                    i - x, j - y, k - z )
+                            : reinterpret_cast<const Leaf*>(node)->value();
+                        if ( value != emptyValue_ &&
+                             OctreeFrustum::classify( planes, remaining,
+                                 i - margin, j - margin, k - margin,
+                                 i + 1 + margin, j + 1 + margin, k + 1 + margin,
+                                 cellRemaining ) ) {
+                            visit( i, j, k, value );
+                        }
+                    }
+                }
+            }
+            break;
+    }
+}
+
+/**
+ * Level of detail traversal: calls \a visitCell for the non-empty nodes close
+ * to the eye and \a visitSummary for the distant subtrees, each standing for
+ * all of its nodes. Requires the summaries to be enabled for \a T, see
+ * OctreeSummaryTraits.
+ *
+ * A subtree of edge \a size is summarized when
+ * <code>size < lodRatio * distance</code>, the distance being from \a eye to
+ * the closest point of the subtree; \a lodRatio is thus the angular size
+ * below which subtrees are not refined. As the subtrees visited at a given
+ * distance grow with it, the number of calls depends on \a lodRatio and on the
+ * view, not on the number of nodes, and the whole octree can be traversed
+ * every frame. Subtrees outside of \a planes are skipped, as in
+ * visitFrustum().
+ *
+ * The visitors are called as <code>visitCell(x, y, z, value)</code> and
+ * <code>visitSummary(x, y, z, size, summary)</code>, (\a x, \a y, \a z) being
+ * the lowest index of the subtree.
+ */
+template< typename T, int AS, typename A >
+template< typename CellVisitor, typename SummaryVisitor >
+void Octree<T,AS,A>::visitLOD( const float planes[][4], int planeCount,
+        float margin, const float eye[3], float lodRatio,
+        CellVisitor visitCell, SummaryVisitor visitSummary ) const
+{
+    static_assert( Summary::enabled,
+            "visitLOD() needs the summaries, see OctreeSummaryTraits" );
+    assert( planeCount >= 0 && planeCount <= 32 );
+
+    unsigned int planeMask = planeCount == 32 ? ~0u : ( 1u << planeCount ) - 1;
+    visitLODRecursive( root_, size_, 0, 0, 0, planes, planeMask, margin, eye,
+            lodRatio, visitCell, visitSummary );
+}
+
+/**
+ * Helper function for visitLOD() method.
+ */
+template< typename T, int AS, typename A >
+template< typename CellVisitor, typename SummaryVisitor >
+void Octree<T,AS,A>::visitLODRecursive( const Node* node, int size,
+        int x, int y, int z, const float planes[][4], unsigned int planeMask,
+        float margin, const float eye[3], float lodRatio,
+        CellVisitor& visitCell, SummaryVisitor& visitSummary ) const
+{
+    if ( !node ) {
+        return;
+    }
+
+    unsigned int remaining;
+    if ( !OctreeFrustum::classify( planes, planeMask,
+                x - margin, y - margin, z - margin,
+                x + size + margin, y + size + margin, z + size + margin,
+                remaining ) ) {
+        return;
+    }
+
+    if ( size > 1 ) {
+        const int corner[3] = { x, y, z };
+        float distance2 = 0;
+        for ( int i = 0; i < 3; ++i ) {
+            float d = std::max( std::max( corner[i] - eye[i], 0.0f ),
+                    eye[i] - ( corner[i] + size ) );
+            distance2 += d * d;
+        }
+
+        if ( size < lodRatio * std::sqrt(distance2) ) {
+            const Summary s = summaryOf( node, size, x, y, z );
+            if ( s.count() ) {
+                visitSummary( x, y, z, size, s );
+            }
+            return;
+        }
+    }
+
+    // The planes of a single cell are not needed further down.
+    unsigned int cellRemaining;
+
+    switch ( node->type() ) {
+        case BranchNode:
+            {
+                const Branch* b = reinterpret_cast<const Branch*>(node);
+                size /= 2;
+                for ( int i = 0; i < 8; ++i ) {
+                    visitLODRecursive( b->child(i), size,
+                            x + ( i & 1 ? size : 0 ),
+                            y + ( i & 2 ? size : 0 ),
+                            z + ( i & 4 ? size : 0 ),
+                            planes, remaining, margin, eye, lodRatio,
+                            visitCell, visitSummary );
+                }
+            }
+            break;
+
+        case AggregateNode:
+        case LeafNode:
+            for ( int k = z; k < z + size; ++k ) {
+                for ( int j = y; j < y + size; ++j ) {
+                    for ( int i = x; i < x + size; ++i ) {
+                        const T& value = node->type() == AggregateNode
+                            ? reinterpret_cast<const Aggregate*>(node)->value(
+                                    i - x, j - y, k - z )
+                            : reinterpret_cast<const Leaf*>(node)->value();
+                        if ( value != emptyValue_ &&
+                             OctreeFrustum::classify( planes, remaining,
+                                 i - margin, j - margin, k - margin,
+                                 i + 1 + margin, j + 1 + margin, k + 1 + margin,
+                                 cellRemaining ) ) {
+                            visitCell( i, j, k, value );
+                        }
+                    }
+                }
+            }
+            break;
+    }
+}
+
 /**
  * Writes the octree in binary form to the output stream \a out. This should be
  * fast, but note that the type \a T will be written as it appears in memory.
@@ -818,8 +1723,8 @@ void Octree<T,AS>::zSliceRecursive( Array2D<T> slice, const Node* node,
  * will be written instead of the data pointed at. For complex types, you should
  * roll your own function.
  */
-template< typename T, int AS >
-void Octree<T,AS>::writeBinary( std::ostream& out ) const
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::writeBinary( std::ostream& out ) const
 {
     if ( !root_ ) {
         static const char zero = 0;
@@ -836,8 +1741,8 @@ void Octree<T,AS>::writeBinary( std::ostream& out ) const
     out.write( reinterpret_cast<const char*>(&size_), sizeof(int) );
 }
 
-template< typename T, int AS >
-void Octree<T,AS>::writeBinaryRecursive( std::ostream& out, const Node* node )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::writeBinaryRecursive( std::ostream& out, const Node* node )
 {
     assert(node);
 
@@ -887,27 +1792,28 @@ void Octree<T,AS>::writeBinaryRecursive( std::ostream& out, const Node* node )
  * Reads the octree from \a in. It must previously have been written using
  * writeBinary().
  */
-template< typename T, int AS >
-void Octree<T,AS>::readBinary( std::istream& in )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::readBinary( std::istream& in )
 {
-    Octree<T,AS> tmp(0);
+    Octree<T,AS,A> tmp(0);
 
     char root;
     in.read( &root, 1 );
     if (root) {
-        readBinaryRecursive( in, &tmp.root_ );
+        tmp.readBinaryRecursive( in, &tmp.root_ );
     }
 
     in.read( reinterpret_cast<char*>(&tmp.emptyValue_), sizeof(T) );
     in.read( reinterpret_cast<char*>(&tmp.size_), sizeof(int) );
 
     if ( in.good() ) {
+        tmp.refreshSummaries();
         swap(tmp);
     }
 }
 
-template< typename T, int AS >
-void Octree<T,AS>::readBinaryRecursive( std::istream& in, Node** node )
+template< typename T, int AS, typename A >
+void Octree<T,AS,A>::readBinaryRecursive( std::istream& in, Node** node )
 {
     assert(node);
 
@@ -921,7 +1827,7 @@ void Octree<T,AS>::readBinaryRecursive( std::istream& in, Node** node )
     switch (type) {
         case BranchNode:
             {
-                Branch* b = new Branch;
+                Branch* b = newBranch();
                 *node = b;
 
                 char children;
@@ -937,7 +1843,7 @@ void Octree<T,AS>::readBinaryRecursive( std::istream& in, Node** node )
 
         case AggregateNode:
             {
-                Aggregate* a = new Aggregate( T(0) );
+                Aggregate* a = newAggregate( T(0) );
                 *node = a;
                 in.read( reinterpret_cast<char*>(&a->value(0,0,0)),
                         AS*AS*AS*sizeof(T) );
@@ -946,7 +1852,7 @@ void Octree<T,AS>::readBinaryRecursive( std::istream& in, Node** node )
 
         case LeafNode:
             {
-                Leaf* l = new Leaf( T(0) );
+                Leaf* l = newLeaf( T(0) );
                 *node = l;
                 in.read( reinterpret_cast<char*>(&l->value()), sizeof(T) );
             }
@@ -0,0 +1,54 @@
+/*
+ *  Box against planes classification shared by the frustum traversals of the
+ *  octrees.
+ */
+
+#ifndef OCTREEFRUSTUM_H
+#define OCTREEFRUSTUM_H
+
+namespace OctreeFrustum
+{
+    /**
+     * Classifies the box [\a x0,\a x1] x [\a y0,\a y1] x [\a z0,\a z1]
+     * against the planes of \a planes whose bit is set in \a planeMask, any
+     * of the 32 bits. A plane (a, b, c, d) keeps the points where
+     * a*x + b*y + c*z + d >= 0.
+     *
+     * \param remaining Set to \a planeMask without the planes the box is
+     * entirely inside of, if the box is not outside. 0 therefore means that
+     * the box is inside all the planes.
+     *
+     * \return false if the box is entirely outside one of the planes.
+     */
+    inline bool classify( const float planes[][4], unsigned int planeMask,
+            float x0, float y0, float z0, float x1, float y1, float z1,
+            unsigned int& remaining )
+    {
+        remaining = planeMask;
+
+        // Only the planes of the mask, lowest first.
+        for ( unsigned int m = planeMask; m; m &= m - 1 ) {
+            const int i = __builtin_ctz(m);
+            const float* p = planes[i];
+
+            // Corner furthest along the normal, then the nearest one.
+            float farthest = p[0] * ( p[0] >= 0 ? x1 : x0 )
+                      + p[1] * ( p[1] >= 0 ? y1 : y0 )
+                      + p[2] * ( p[2] >= 0 ? z1 : z0 ) + p[3];
+            if ( farthest < 0 ) {
+                return false;
+            }
+
+            float nearest = p[0] * ( p[0] >= 0 ? x0 : x1 )
+                       + p[1] * ( p[1] >= 0 ? y0 : y1 )
+                       + p[2] * ( p[2] >= 0 ? z0 : z1 ) + p[3];
+            if ( nearest >= 0 ) {
+                remaining &= ~( 1u << i );
+            }
+        }
+
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ *  Allocator policies for the nodes of Octree.
+ *
+ *  An allocator policy is a default-constructible class providing:
+ *
+ *    void* allocate( std::size_t bytes );
+ *    void deallocate( void* p, std::size_t bytes );
+ *    void swap( Policy& o );
+ *    unsigned long overheadBytes() const;
+ *    static const bool releasesAll;
+ *
+ *  overheadBytes() is the memory held by the policy on top of the live nodes.
+ *  releasesAll tells that the destructor of the policy frees every node it
+ *  ever allocated, so that the octree does not need to deallocate its nodes
+ *  one by one when it is destroyed.
+ */
+
+#ifndef OCTREEPOOL_H
+#define OCTREEPOOL_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * Plain operator new/delete, one heap allocation per node.
+ */
+class OctreeHeap
+{
+public:
+    void* allocate( std::size_t bytes )
+    {
+        return ::operator new(bytes);
+    }
+
+    void deallocate( void* p, std::size_t )
+    {
+        ::operator delete(p);
+    }
+
+    void swap( OctreeHeap& )
+    {
+    }
+
+    unsigned long overheadBytes() const
+    {
+        return 0;
+    }
+
+    static const bool releasesAll = false;
+};
+
+/**
+ * Slab allocator: the nodes of each size are carved out of contiguous blocks,
+ * freed nodes are kept in a free list for reuse, and the blocks are only
+ * returned to the system when the pool is destroyed. The blocks double in size
+ * from 4 KiB up to 1 MiB, so that small trees stay small.
+ */
+class OctreePool
+{
+public:
+    OctreePool()
+        : reservedBytes_(0)
+        , usedBytes_(0)
+    {
+    }
+
+    ~OctreePool()
+    {
+        for ( std::size_t i = 0; i < blocks_.size(); ++i ) {
+            ::operator delete( blocks_[i] );
+        }
+    }
+
+    void* allocate( std::size_t bytes )
+    {
+        SizeClass& c = sizeClass(bytes);
+        usedBytes_ += c.size;
+
+        if ( c.freeList ) {
+            void* p = c.freeList;
+            c.freeList = *static_cast<void**>(p);
+            return p;
+        }
+
+        if ( static_cast<std::size_t>( c.end - c.next ) < c.size ) {
+            c.blockBytes = std::min<std::size_t>( c.blockBytes * 2, maxBlockBytes );
+            std::size_t blockBytes = std::max( c.blockBytes, c.size );
+            c.next = static_cast<char*>( ::operator new(blockBytes) );
+            c.end = c.next + blockBytes;
+            blocks_.push_back( c.next );
+            reservedBytes_ += blockBytes;
+        }
+
+        void* p = c.next;
+        c.next += c.size;
+        return p;
+    }
+
+    void deallocate( void* p, std::size_t bytes )
+    {
+        SizeClass& c = sizeClass(bytes);
+        usedBytes_ -= c.size;
+
+        *static_cast<void**>(p) = c.freeList;
+        c.freeList = p;
+    }
+
+    void swap( OctreePool& o )
+    {
+        classes_.swap( o.classes_ );
+        blocks_.swap( o.blocks_ );
+        std::swap( reservedBytes_, o.reservedBytes_ );
+        std::swap( usedBytes_, o.usedBytes_ );
+    }
+
+    /**
+     * \return Bytes reserved in the blocks but not used by live nodes: unused
+     * block tails, free lists and size rounding, plus the bookkeeping.
+     */
+    unsigned long overheadBytes() const
+    {
+        return reservedBytes_ - usedBytes_
+            + blocks_.capacity() * sizeof(char*)
+            + classes_.capacity() * sizeof(SizeClass);
+    }
+
+    static const bool releasesAll = true;
+
+private:
+    OctreePool( const OctreePool& );
+    OctreePool& operator= ( const OctreePool& );
+
+    struct SizeClass
+    {
+        std::size_t size;
+        std::size_t blockBytes;
+        void* freeList;
+        char* next;
+        char* end;
+    };
+
+    /**
+     * \return The size class of \a bytes, rounded up to a multiple of the
+     * pointer size so that every slot is aligned and can hold the free list
+     * link. An octree only uses up to three classes.
+     */
+    SizeClass& sizeClass( std::size_t bytes )
+    {
+        std::size_t size = ( std::max( bytes, sizeof(void*) ) + sizeof(void*) - 1 )
+            & ~( sizeof(void*) - 1 );
+
+        for ( std::size_t i = 0; i < classes_.size(); ++i ) {
+            if ( classes_[i].size == size ) {
+                return classes_[i];
+            }
+        }
+
+        SizeClass c = { size, minBlockBytes / 2, 0, 0, 0 };
+        classes_.push_back(c);
+        return classes_.back();
+    }
+
+    enum { minBlockBytes = 4096, maxBlockBytes = 1 << 20 };
+
+    std::vector<SizeClass> classes_;
+    std::vector<char*> blocks_;
+    unsigned long reservedBytes_;
+    unsigned long usedBytes_;
+};
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ *  Per-branch summaries (count, centroid, summed colour) cached by Octree for
+ *  level-of-detail drawing.
+ */
+
+#ifndef OCTREESUMMARY_H
+#define OCTREESUMMARY_H
+
+#include <cassert>
+
+/**
+ * \class OctreeNoSummary
+ * \brief Summary of the octrees that do not cache any
+ *
+ * This is the default: the branches carry nothing and every method does
+ * nothing.
+ */
+class OctreeNoSummary
+{
+public:
+    static const bool enabled = false;
+
+    void add( int, int, int, const float* ) {}
+    void remove( int, int, int, const float* ) {}
+    void addUniform( int, int, int, int, const float* ) {}
+    void add( const OctreeNoSummary& ) {}
+};
+
+/**
+ * \class OctreeSummary
+ * \brief Aggregate data cached by the branches of an octree for their subtree
+ *
+ * Number of non-empty nodes, sum of their indices (the centroid is their mean)
+ * and sum of their colours, whose luminance is the summed luminosity. Every
+ * member is a sum, so a node is added or removed in constant time and the
+ * octree keeps the branches on the path of set() and erase() up to date.
+ *
+ * The indices are summed in 64-bit integers, so that the centroid does not
+ * drift however many times the nodes are added and removed.
+ */
+class OctreeSummary
+{
+public:
+    static const bool enabled = true;
+
+    OctreeSummary()
+        : count_(0)
+    {
+        for ( int i = 0; i < 3; ++i ) {
+            color_[i] = 0;
+            position_[i] = 0;
+        }
+    }
+
+    /**
+     * Adds the node of index (\a x, \a y, \a z) and colour \a color.
+     */
+    void add( int x, int y, int z, const float* color )
+    {
+        ++count_;
+        position_[0] += x;
+        position_[1] += y;
+        position_[2] += z;
+        for ( int i = 0; i < 3; ++i ) {
+            color_[i] += color[i];
+        }
+    }
+
+    /**
+     * Removes the node of index (\a x, \a y, \a z) and colour \a color, which
+     * must have been added before.
+     */
+    void remove( int x, int y, int z, const float* color )
+    {
+        assert( count_ > 0 );
+        --count_;
+        position_[0] -= x;
+        position_[1] -= y;
+        position_[2] -= z;
+        for ( int i = 0; i < 3; ++i ) {
+            color_[i] = count_ ? color_[i] - color[i] : 0;
+        }
+    }
+
+    /**
+     * Adds the \a size^3 nodes of colour \a color whose lowest index is
+     * (\a x, \a y, \a z), i.e. a leaf node.
+     */
+    void addUniform( int x, int y, int z, int size, const float* color )
+    {
+        const long long n = static_cast<long long>(size) * size * size;
+        assert( count_ + n <= 0xffffffffLL );
+
+        count_ += static_cast<unsigned int>(n);
+        // Sum of x + i over i in [0, size), times size^2 for the other axes.
+        const long long offset = static_cast<long long>(size) * size
+                               * size * ( size - 1 ) / 2;
+        position_[0] += n * x + offset;
+        position_[1] += n * y + offset;
+        position_[2] += n * z + offset;
+        for ( int i = 0; i < 3; ++i ) {
+            color_[i] += n * color[i];
+        }
+    }
+
+    /**
+     * Adds all the nodes of summary \a s.
+     */
+    void add( const OctreeSummary& s )
+    {
+        count_ += s.count_;
+        for ( int i = 0; i < 3; ++i ) {
+            position_[i] += s.position_[i];
+            color_[i] += s.color_[i];
+        }
+    }
+
+    /**
+     * \return Number of non-empty nodes.
+     */
+    unsigned int count() const
+    {
+        return count_;
+    }
+
+    /**
+     * \return Mean index of the nodes along \a axis (0 for x, 1 for y, 2 for
+     * z). Must not be called on an empty summary.
+     */
+    float centroid( int axis ) const
+    {
+        assert( count_ > 0 );
+        return static_cast<double>( position_[axis] ) / count_;
+    }
+
+    /**
+     * \return Summed colour channel \a channel (0 red, 1 green, 2 blue).
+     */
+    float color( int channel ) const
+    {
+        return color_[channel];
+    }
+
+    /**
+     * \return Summed luminosity, the Rec. 709 luminance of the summed colour.
+     */
+    float luminosity() const
+    {
+        return 0.2126f * color_[0] + 0.7152f * color_[1] + 0.0722f * color_[2];
+    }
+
+private:
+    unsigned int count_;
+    float color_[3];
+    long long position_[3];
+};
+
+/**
+ * \class OctreeSummaryTraits
+ * \brief Chooses the summary the branches of an Octree<T> cache
+ *
+ * By default nothing is cached and the branches keep their size. To enable the
+ * summaries for a type, specialize this class with
+ * <code>typedef OctreeSummary Summary;</code> and a static
+ * <code>void color( const T& value, float color[3] )</code> giving the colour
+ * of a value:
+ *
+ * \code
+ * template<>
+ * class OctreeSummaryTraits<Star>
+ * {
+ * public:
+ *     typedef OctreeSummary Summary;
+ *     static void color( const Star& star, float color[3] ) { ... }
+ * };
+ * \endcode
+ *
+ * The specialization must be visible wherever the octree is instantiated.
+ */
+template< typename T >
+class OctreeSummaryTraits
+{
+public:
+    typedef OctreeNoSummary Summary;
+
+    static void color( const T&, float color[3] )
+    {
+        color[0] = color[1] = color[2] = 0;
+    }
+};
+
+#endif
@@ -19,6 +19,7 @@
 #define SHAREDDATA_H
 
 #include <algorithm>
+#include <cassert>
 
 /**
  * \warning This class isn't thread-safe! In particular, we should use atomic
@@ -39,6 +40,8 @@ public:
     T& operator[] ( int i ) const;
 
 private:
+    void release();
+
     T* data_;
     int* refcount_;
 };
@@ -68,11 +71,23 @@ template< typename T >
 SharedData<T>::~SharedData()
 {
     if ( --*refcount_ == 0 ) {
-        delete[] data_;
-        delete refcount_;
+        release();
     }
 }
 
+/**
+ * Frees the data and the reference count once the last reference is gone.
+ * Kept out of line: once the destructors of several copies are inlined in the
+ * same function, GCC cannot tell that only the last one frees the count and
+ * warns that the others use it after it is freed (-Wuse-after-free).
+ */
+template< typename T >
+__attribute__((noinline)) void SharedData<T>::release()
+{
+    delete[] data_;
+    delete refcount_;
+}
+
 template< typename T >
 void SharedData<T>::swap( SharedData<T>& sharedData )
 {
@@ -2,7 +2,7 @@
 #include "Utils.h"
 #include "Scene.h"
 #include "Oculus.h"
-#include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
 
 #include <iostream>
 
@@ -41,12 +41,12 @@ Input::Input(Scene* scene):
       {
       case SDL_KEYDOWN:
         keyboardKeys_[event_.key.keysym.scancode] = KEY::DOWN;
-        spdlog::get("console")->debug() << "The key: " << SDL_GetScancodeName(event_.key.keysym.scancode) << " was pressed";
+        LOG_DEBUG("The key: " << SDL_GetScancodeName(event_.key.keysym.scancode) << " was pressed");
         break;
 
       case SDL_KEYUP:
         keyboardKeys_[event_.key.keysym.scancode] = KEY::UP;
-        spdlog::get("console")->debug() << "The key: " << SDL_GetScancodeName(event_.key.keysym.scancode) << " was released";
+        LOG_DEBUG("The key: " << SDL_GetScancodeName(event_.key.keysym.scancode) << " was released");
         break;
 
       case SDL_MOUSEBUTTONDOWN:
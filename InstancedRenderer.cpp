@@ -0,0 +1,225 @@
+#include "InstancedRenderer.h"
+#include "GraphicObject.h"
+#include "Log.h"
+
+#include <algorithm>
+
+namespace
+{
+  //Same unit cube as Cube, A B C D anti clockwise with A facing x axis +, E top, F bottom
+  const float cubeVertices[] = {
+    -1.0, -1.0, -1.0,   1.0, -1.0, -1.0,   1.0, 1.0, -1.0,     // Face 1 D
+    -1.0, -1.0, -1.0,   -1.0, 1.0, -1.0,   1.0, 1.0, -1.0,     // Face 1
+
+    1.0, -1.0, 1.0,   1.0, -1.0, -1.0,   1.0, 1.0, -1.0,       // Face 2 A
+    1.0, -1.0, 1.0,   1.0, 1.0, 1.0,   1.0, 1.0, -1.0,         // Face 2
+
+    -1.0, -1.0, 1.0,   1.0, -1.0, 1.0,   1.0, -1.0, -1.0,      // Face 3 F
+    -1.0, -1.0, 1.0,   -1.0, -1.0, -1.0,   1.0, -1.0, -1.0,    // Face 3
+
+    -1.0, -1.0, 1.0,   1.0, -1.0, 1.0,   1.0, 1.0, 1.0,        // Face 4 B
+    -1.0, -1.0, 1.0,   -1.0, 1.0, 1.0,   1.0, 1.0, 1.0,        // Face 4
+
+    -1.0, -1.0, -1.0,   -1.0, -1.0, 1.0,   -1.0, 1.0, 1.0,     // Face 5 C
+    -1.0, -1.0, -1.0,   -1.0, 1.0, -1.0,   -1.0, 1.0, 1.0,     // Face 5
+
+    -1.0, 1.0, 1.0,   1.0, 1.0, 1.0,   1.0, 1.0, -1.0,         // Face 6 E
+    -1.0, 1.0, 1.0,   -1.0, 1.0, -1.0,   1.0, 1.0, -1.0        // Face 6
+  };
+
+  //Same texture coordinates as Crate
+  const float cubeTextureCoord[] = {
+    0, 0,   1, 0,   1, 1,     // Face 1
+    0, 0,   0, 1,   1, 1,     // Face 1
+
+    0, 0,   1, 0,   1, 1,     // Face 2
+    0, 0,   0, 1,   1, 1,     // Face 2
+
+    0, 0,   1, 0,   1, 1,     // Face 3
+    0, 0,   0, 1,   1, 1,     // Face 3
+
+    0, 0,   1, 0,   1, 1,     // Face 4
+    0, 0,   0, 1,   1, 1,     // Face 4
+
+    0, 0,   1, 0,   1, 1,     // Face 5
+    0, 0,   0, 1,   1, 1,     // Face 5
+
+    0, 0,   1, 0,   1, 1,     // Face 6
+    0, 0,   0, 1,   1, 1      // Face 6
+  };
+
+  const int cubeVerticesCount = sizeof(cubeVertices) / (3 * sizeof(float));
+}
+
+InstancedRenderer::InstancedRenderer(std::string const & vertexShader, std::string const & fragmentShader):
+  shader_ {nullptr},
+  meshVBOId_ {0},
+  instancesVBOId_ {0},
+  VAOId_ {0},
+  instancesCapacity_ {0},
+  instancesCount_ {0},
+  drawCallsCount_ {0}
+  {
+    //Shared shader pool
+    shader_ = ShaderFactory::createShader(vertexShader, fragmentShader);
+
+    load();
+  }
+
+  InstancedRenderer::InstancedRenderer():
+    InstancedRenderer("../Shaders/textureInstanced.vert", "../Shaders/texture.frag")
+    {
+    }
+
+    InstancedRenderer::~InstancedRenderer()
+    {
+      if (glIsBuffer(meshVBOId_))
+      {
+        GLState::deleteBuffer(meshVBOId_);
+      }
+
+      if (glIsBuffer(instancesVBOId_))
+      {
+        GLState::deleteBuffer(instancesVBOId_);
+      }
+
+      if (glIsVertexArray(VAOId_))
+      {
+        GLState::deleteVertexArray(VAOId_);
+      }
+    }
+
+    void InstancedRenderer::load()
+    {
+      //Mesh VBO, never modified afterwards
+      if (glIsBuffer(meshVBOId_))
+      {
+        GLState::deleteBuffer(meshVBOId_);
+      }
+
+      glGenBuffers(1, &meshVBOId_);
+      GLState::bindBuffer(GL_ARRAY_BUFFER, meshVBOId_);
+
+      glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices) + sizeof(cubeTextureCoord), 0, GL_STATIC_DRAW);
+      glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(cubeVertices), cubeVertices);
+      glBufferSubData(GL_ARRAY_BUFFER, sizeof(cubeVertices), sizeof(cubeTextureCoord), cubeTextureCoord);
+
+      //Instances VBO, filled every frame
+      if (glIsBuffer(instancesVBOId_))
+      {
+        GLState::deleteBuffer(instancesVBOId_);
+      }
+
+      glGenBuffers(1, &instancesVBOId_);
+
+      //VAO
+      if (glIsVertexArray(VAOId_))
+      {
+        GLState::deleteVertexArray(VAOId_);
+      }
+
+      glGenVertexArrays(1, &VAOId_);
+      GLState::bindVertexArray(VAOId_);
+
+      GLState::bindBuffer(GL_ARRAY_BUFFER, meshVBOId_);
+
+      glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(0));
+      glEnableVertexAttribArray(0);
+
+      glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(sizeof(cubeVertices)));
+      glEnableVertexAttribArray(2);
+
+      //Instance data: (x, y, z, size), advanced once per cube instead of once per vertex
+      GLState::bindBuffer(GL_ARRAY_BUFFER, instancesVBOId_);
+
+      glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(0));
+      glVertexAttribDivisor(3, 1);
+      glEnableVertexAttribArray(3);
+
+      GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+      GLState::bindVertexArray(0);
+    }
+
+    void InstancedRenderer::reserve(unsigned long instancesCount)
+    {
+      upload_.reserve(instancesCount);
+
+      if (instancesCount > instancesCapacity_)
+      {
+        instancesCapacity_ = instancesCount;
+
+        GLState::bindBuffer(GL_ARRAY_BUFFER, instancesVBOId_);
+        glBufferData(GL_ARRAY_BUFFER, instancesCapacity_ * sizeof(glm::vec4), 0, GL_STREAM_DRAW);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+      }
+    }
+
+    void InstancedRenderer::add(GLuint textureId, glm::vec3 const & position, float size)
+    {
+      instances_[textureId].push_back(glm::vec4(position, size));
+    }
+
+    void InstancedRenderer::draw()
+    {
+      instancesCount_ = 0;
+      drawCallsCount_ = 0;
+
+      //One upload for all the groups
+      upload_.clear();
+      for (const auto & group : instances_)
+      {
+        upload_.insert(upload_.end(), group.second.begin(), group.second.end());
+      }
+
+      if (upload_.empty())
+      {
+        return;
+      }
+
+      shader_->use();
+
+      GLState::bindVertexArray(VAOId_);
+
+      //Orphan the previous buffer so that the driver does not wait for the previous frame. Always the same size, so that
+      //the driver can recycle the storage
+      instancesCapacity_ = std::max(instancesCapacity_, static_cast<unsigned long>(upload_.size()));
+      GLState::bindBuffer(GL_ARRAY_BUFFER, instancesVBOId_);
+      glBufferData(GL_ARRAY_BUFFER, instancesCapacity_ * sizeof(glm::vec4), 0, GL_STREAM_DRAW);
+      glBufferSubData(GL_ARRAY_BUFFER, 0, upload_.size() * sizeof(glm::vec4), upload_.data());
+
+      unsigned long offset = 0;
+      for (auto & group : instances_)
+      {
+        if (group.second.empty())
+        {
+          continue;
+        }
+
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(offset * sizeof(glm::vec4)));
+
+        GLState::bindTexture(GL_TEXTURE_2D, group.first);
+
+        glDrawArraysInstanced(GL_TRIANGLES, 0, cubeVerticesCount, group.second.size());
+
+        offset += group.second.size();
+        drawCallsCount_++;
+
+        group.second.clear();
+      }
+      instancesCount_ = offset;
+
+      //The bindings are left as they are, the next draws skip them if they are the same, see GLState
+
+      LOG_DEBUG("Instanced rendering: " << instancesCount_ << " cubes in " << drawCallsCount_ << " draw calls");
+    }
+
+    unsigned long InstancedRenderer::instancesCount() const
+    {
+      return instancesCount_;
+    }
+
+    unsigned long InstancedRenderer::drawCallsCount() const
+    {
+      return drawCallsCount_;
+    }
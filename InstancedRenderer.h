@@ -0,0 +1,110 @@
+#ifndef INSTANCEDRENDERER_H
+#define INSTANCEDRENDERER_H
+
+/** @file
+* @brief Instanced rendering of textured cubes
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include "Include/glm/glm.hpp"
+#include "Shader.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+* @brief The InstancedRenderer class
+* @details Draws many textured cubes with a handful of draw calls. All the cubes share a single immutable mesh, and the
+* position and size of each cube are streamed every frame in an instance buffer. The cubes are grouped by texture and
+* each group is drawn with one glDrawArraysInstanced call.
+*/
+class InstancedRenderer
+{
+public:
+  InstancedRenderer(std::string const & vertexShader, std::string const & fragmentShader);
+  InstancedRenderer();
+  ~InstancedRenderer();
+
+  /**
+  * @brief Creates the OpenGL resources (shared cube mesh, instance buffer & VAO) and sends the mesh to the graphic card
+  */
+  void load();
+
+  /**
+  * @brief Allocates the instance buffer once for the given number of cubes
+  * @details Called once the objects are generated, so that the frames do not grow the buffer in the graphic card nor
+  * the staging area. It is only a hint: a frame with more cubes still grows them.
+  * @param instancesCount The maximal number of cubes expected in a frame
+  */
+  void reserve(unsigned long instancesCount);
+
+  /**
+  * @brief Queues a cube to be drawn in the current frame
+  * @param textureId The OpenGL id of the texture applied on the 6 faces of the cube
+  * @param position The position of the center of the cube
+  * @param size The size of the edge of the cube
+  */
+  void add(GLuint textureId, glm::vec3 const & position, float size);
+
+  /**
+  * @brief Draws all the queued cubes and empties the queue
+  * @details The view and projection matrices are read from the camera uniform buffer, see CameraUniforms
+  */
+  void draw();
+
+  /**
+  * @brief Gives the number of cubes drawn during the last call to draw()
+  */
+  unsigned long instancesCount() const;
+
+  /**
+  * @brief Gives the number of draw calls issued during the last call to draw()
+  */
+  unsigned long drawCallsCount() const;
+
+private:
+  /**
+  * @brief The shader program, shared through the ShaderFactory
+  */
+  std::shared_ptr<Shader> shader_;
+
+  /**
+  * @brief The OpenGL id of the VBO storing the cube mesh (vertices and texture coordinates)
+  */
+  GLuint meshVBOId_;
+
+  /**
+  * @brief The OpenGL id of the VBO storing the per instance data, rewritten every frame
+  */
+  GLuint instancesVBOId_;
+
+  /**
+  * @brief The OpenGL id of the VAO binding the mesh and the instance buffer
+  */
+  GLuint VAOId_;
+
+  /**
+  * @brief The queued cubes, grouped by texture id
+  * @details Each instance is stored as (x, y, z, size). The vectors are cleared but not freed between frames.
+  */
+  std::map<GLuint, std::vector<glm::vec4>> instances_;
+
+  /**
+  * @brief Staging area where the groups are concatenated before being sent in one upload
+  */
+  std::vector<glm::vec4> upload_;
+
+  /**
+  * @brief The number of instances the instance buffer can hold
+  */
+  unsigned long instancesCapacity_;
+
+  unsigned long instancesCount_;
+  unsigned long drawCallsCount_;
+};
+
+#endif // INSTANCEDRENDERER_H
@@ -0,0 +1,56 @@
+#ifndef LOG_H
+#define LOG_H
+
+/** @file
+* @brief Logging macros with a compile time minimum level
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include "spdlog/include/spdlog/spdlog.h"
+
+/**
+* @brief The minimum level compiled in, with the values of spdlog::level (0 trace, 1 debug, 2 info, ...)
+* @details Set by CMake from the build type. The messages below this level are removed by the compiler along with
+* their arguments.
+*/
+#ifndef SIMULATION_LOG_LEVEL
+#define SIMULATION_LOG_LEVEL 1
+#endif
+
+/** @namespace Log
+* Namespace gathering the helpers of the logging macros
+*/
+namespace Log
+{
+  /**
+  * @brief Gives the console logger, looked up once in the spdlog registry
+  */
+  inline spdlog::logger* console()
+  {
+    static spdlog::logger* logger = spdlog::get("console").get();
+    return logger;
+  }
+}
+
+/**
+* @brief Logs a message to the console at the given level
+* @details The message is a stream expression, e.g LOG_DEBUG("x = " << x). It is only evaluated if the level is both
+* compiled in and enabled at runtime, so the arguments (Utils::toString and the like) cost nothing otherwise.
+* The macros are variadic so that the message may contain template arguments with commas.
+*/
+#define LOG_AT(level, method, ...) \
+  do \
+  { \
+    if (level >= SIMULATION_LOG_LEVEL && Log::console()->should_log(level)) \
+    { \
+      Log::console()->method() << __VA_ARGS__; \
+    } \
+  } while (0)
+
+#define LOG_TRACE(...) LOG_AT(spdlog::level::trace, trace, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(spdlog::level::debug, debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(spdlog::level::info, info, __VA_ARGS__)
+
+#endif // LOG_H
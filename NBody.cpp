@@ -0,0 +1,138 @@
+#include "NBody.h"
+#include "ThreadPool.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+  //Bodies per chunk of the integration loops
+  const unsigned long integrationChunkSize = 1 << 14;
+}
+
+unsigned long Bodies::size() const
+{
+  return x.size();
+}
+
+void Bodies::resize(unsigned long bodiesCount)
+{
+  for (std::vector<float>* array : {&x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az, &mass})
+  {
+    array->resize(bodiesCount, 0);
+  }
+}
+
+GravitySolver::~GravitySolver()
+{
+}
+
+NBodySimulation::NBodySimulation(std::unique_ptr<GravitySolver> solver, ThreadPool & threadPool, float timestep):
+  bodies_ {},
+  solver_ {std::move(solver)},
+  threadPool_ (threadPool),
+  timestep_ {timestep},
+  time_ {0},
+  stepsCount_ {0},
+  accelerationsValid_ {false}
+  {
+    assert(solver_);
+  }
+
+  void NBodySimulation::step()
+  {
+    if (!accelerationsValid_)
+    {
+      solver_->accelerations(bodies_);
+      accelerationsValid_ = true;
+    }
+
+    const float dt = timestep_;
+    Bodies & b = bodies_;
+
+    //Kick of half a step, then drift of a full step
+    threadPool_.parallelFor(b.size(), integrationChunkSize, [&b, dt] (unsigned long begin, unsigned long end, unsigned long) {
+      for (unsigned long i=begin; i < end; i++)
+      {
+        b.vx[i] += b.ax[i] * dt / 2;
+        b.vy[i] += b.ay[i] * dt / 2;
+        b.vz[i] += b.az[i] * dt / 2;
+
+        b.x[i] += b.vx[i] * dt;
+        b.y[i] += b.vy[i] * dt;
+        b.z[i] += b.vz[i] * dt;
+      }
+    });
+
+    solver_->accelerations(bodies_);
+
+    //Kick of the other half step
+    threadPool_.parallelFor(b.size(), integrationChunkSize, [&b, dt] (unsigned long begin, unsigned long end, unsigned long) {
+      for (unsigned long i=begin; i < end; i++)
+      {
+        b.vx[i] += b.ax[i] * dt / 2;
+        b.vy[i] += b.ay[i] * dt / 2;
+        b.vz[i] += b.az[i] * dt / 2;
+      }
+    });
+
+    time_ += timestep_;
+    stepsCount_++;
+  }
+
+  Bodies & NBodySimulation::bodies()
+  {
+    return bodies_;
+  }
+
+  Bodies const & NBodySimulation::bodies() const
+  {
+    return bodies_;
+  }
+
+  GravitySolver & NBodySimulation::solver()
+  {
+    return *solver_;
+  }
+
+  float NBodySimulation::timestep() const
+  {
+    return timestep_;
+  }
+
+  double NBodySimulation::time() const
+  {
+    return time_;
+  }
+
+  unsigned long long NBodySimulation::stepsCount() const
+  {
+    return stepsCount_;
+  }
+
+  double NBodySimulation::energy(float softening) const
+  {
+    Bodies const & b = bodies_;
+    double kinetic = 0;
+    double potential = 0;
+
+    for (unsigned long i=0; i < b.size(); i++)
+    {
+      kinetic += 0.5 * b.mass[i] * (double(b.vx[i]) * b.vx[i] + double(b.vy[i]) * b.vy[i] + double(b.vz[i]) * b.vz[i]);
+
+      for (unsigned long j=i + 1; j < b.size(); j++)
+      {
+        double dx = double(b.x[j]) - b.x[i];
+        double dy = double(b.y[j]) - b.y[i];
+        double dz = double(b.z[j]) - b.z[i];
+        potential -= double(b.mass[i]) * b.mass[j] / std::sqrt(dx * dx + dy * dy + dz * dz + double(softening) * softening);
+      }
+    }
+
+    return kinetic + potential;
+  }
+
+  void NBodySimulation::invalidate()
+  {
+    accelerationsValid_ = false;
+  }
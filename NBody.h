@@ -0,0 +1,127 @@
+#ifndef NBODY_H
+#define NBODY_H
+
+/** @file
+* @brief Gravitational N-body simulation
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/**
+* @brief The Bodies struct
+* @details The state of the bodies as a structure of arrays: positions, velocities, accelerations and masses each live
+* in their own contiguous array, so that the gravity solvers stream through them.
+*/
+struct Bodies
+{
+  std::vector<float> x, y, z;
+  std::vector<float> vx, vy, vz;
+  std::vector<float> ax, ay, az;
+  std::vector<float> mass;
+
+  unsigned long size() const;
+
+  /**
+  * @brief Resizes all the arrays, the new bodies are at rest at the origin with no mass
+  */
+  void resize(unsigned long bodiesCount);
+};
+
+/**
+* @brief The GravitySolver class
+* @details Abstract base class of the algorithms computing the gravitational accelerations of the bodies
+*/
+class GravitySolver
+{
+public:
+  virtual ~GravitySolver();
+
+  /**
+  * @brief Computes the acceleration of every body due to all the others
+  * @details Reads the positions and masses, writes ax, ay and az
+  */
+  virtual void accelerations(Bodies & bodies) = 0;
+
+  /**
+  * @brief Gives the number of body-body or body-node interactions computed by the last call to accelerations()
+  */
+  virtual unsigned long long interactionsCount() const = 0;
+
+  virtual std::string name() const = 0;
+};
+
+/**
+* @brief The NBodySimulation class
+* @details Advances the bodies in time with the leapfrog (kick-drift-kick) scheme: half a kick of the velocities, a
+* drift of the positions, new accelerations, half a kick. It is second order, time reversible and conserves the energy
+* over long runs as long as the timestep is constant. The gravity is computed by the given solver, e.g. BarnesHut.
+*/
+class NBodySimulation
+{
+public:
+  /**
+  * @param solver The gravity solver
+  * @param threadPool The threads the integration is split on
+  * @param timestep The duration of a step, in simulation time units
+  */
+  NBodySimulation(std::unique_ptr<GravitySolver> solver, ThreadPool & threadPool, float timestep);
+
+  /**
+  * @brief Advances the simulation of 1 timestep
+  */
+  void step();
+
+  Bodies & bodies();
+  Bodies const & bodies() const;
+
+  GravitySolver & solver();
+
+  float timestep() const;
+
+  /**
+  * @brief Gives the simulation time elapsed since the start
+  */
+  double time() const;
+
+  unsigned long long stepsCount() const;
+
+  /**
+  * @brief Gives the total energy, kinetic plus potential, for the conservation checks
+  * @details The potential energy is summed over all the pairs, O(N^2)
+  * @param softening The softening of the solver, so that the energy matches the softened forces
+  */
+  double energy(float softening = 0) const;
+
+  /**
+  * @brief Tells the simulation that the bodies were modified from the outside, so that the accelerations are computed
+  * again before the next step
+  */
+  void invalidate();
+
+private:
+  Bodies bodies_;
+
+  std::unique_ptr<GravitySolver> solver_;
+
+  ThreadPool & threadPool_;
+
+  float timestep_;
+
+  double time_;
+
+  unsigned long long stepsCount_;
+
+  /**
+  * @brief Whether the accelerations match the positions, which is the case after a step
+  */
+  bool accelerationsValid_;
+};
+
+#endif // NBODY_H
@@ -0,0 +1,149 @@
+#include "ObjectStore.h"
+
+#include <cassert>
+
+std::vector<glm::vec3> ObjectStore::positions_;
+std::vector<float> ObjectStore::sizes_;
+std::vector<std::uint16_t> ObjectStore::materials_;
+std::vector<std::uint16_t> ObjectStore::meshes_;
+std::vector<std::shared_ptr<Texture>> ObjectStore::materialTextures_;
+
+std::uint16_t ObjectStore::addMaterial(std::string const & texture)
+{
+  for (std::uint16_t i=0; i < materialTextures_.size(); i++)
+  {
+    if (materialTextures_[i]->file() == texture)
+    {
+      return i;
+    }
+  }
+
+  //Shared texture pool
+  materialTextures_.push_back(TextureFactory::createTexture(texture));
+
+  return materialTextures_.size() - 1;
+}
+
+ObjectHandle ObjectStore::add(glm::vec3 const & position, float size, std::uint16_t material, std::uint16_t mesh)
+{
+  assert(material < materialTextures_.size());
+
+  addNullObject();
+
+  assert(positions_.size() <= UINT32_MAX);
+
+  positions_.push_back(position);
+  sizes_.push_back(size);
+  materials_.push_back(material);
+  meshes_.push_back(mesh);
+
+  return ObjectHandle(positions_.size() - 1);
+}
+
+ObjectHandle ObjectStore::allocate(unsigned long objectsCount)
+{
+  addNullObject();
+
+  assert(positions_.size() + objectsCount <= UINT32_MAX);
+
+  ObjectHandle first(positions_.size());
+
+  positions_.resize(positions_.size() + objectsCount);
+  sizes_.resize(sizes_.size() + objectsCount);
+  materials_.resize(materials_.size() + objectsCount);
+  meshes_.resize(meshes_.size() + objectsCount);
+
+  return first;
+}
+
+void ObjectStore::set(ObjectHandle handle, glm::vec3 const & position, float size, std::uint16_t material, std::uint16_t mesh)
+{
+  assert(handle.index() != 0 && handle.index() < positions_.size());
+  assert(material < materialTextures_.size());
+
+  positions_[handle.index()] = position;
+  sizes_[handle.index()] = size;
+  materials_[handle.index()] = material;
+  meshes_[handle.index()] = mesh;
+}
+
+void ObjectStore::reserve(unsigned long objectsCount)
+{
+  positions_.reserve(objectsCount + 1);
+  sizes_.reserve(objectsCount + 1);
+  materials_.reserve(objectsCount + 1);
+  meshes_.reserve(objectsCount + 1);
+}
+
+glm::vec3 const & ObjectStore::position(ObjectHandle handle)
+{
+  return positions_[handle.index()];
+}
+
+void ObjectStore::setPosition(ObjectHandle handle, glm::vec3 const & position)
+{
+  assert(handle.index() != 0 && handle.index() < positions_.size());
+
+  positions_[handle.index()] = position;
+}
+
+float ObjectStore::size(ObjectHandle handle)
+{
+  return sizes_[handle.index()];
+}
+
+std::uint16_t ObjectStore::material(ObjectHandle handle)
+{
+  return materials_[handle.index()];
+}
+
+std::uint16_t ObjectStore::mesh(ObjectHandle handle)
+{
+  return meshes_[handle.index()];
+}
+
+GLuint ObjectStore::textureId(std::uint16_t material)
+{
+  return materialTextures_[material]->id();
+}
+
+glm::vec3 ObjectStore::color(ObjectHandle handle)
+{
+  return materialTextures_[materials_[handle.index()]]->averageColor();
+}
+
+unsigned long ObjectStore::objectsCount()
+{
+  return positions_.empty() ? 0 : positions_.size() - 1;
+}
+
+unsigned long ObjectStore::bytes()
+{
+  return positions_.capacity() * sizeof(glm::vec3) + sizes_.capacity() * sizeof(float)
+  + materials_.capacity() * sizeof(std::uint16_t) + meshes_.capacity() * sizeof(std::uint16_t);
+}
+
+unsigned long ObjectStore::objectBytes()
+{
+  return sizeof(glm::vec3) + sizeof(float) + 2 * sizeof(std::uint16_t);
+}
+
+void ObjectStore::addNullObject()
+{
+  if (positions_.empty())
+  {
+    positions_.push_back(glm::vec3(0));
+    sizes_.push_back(0);
+    materials_.push_back(0);
+    meshes_.push_back(CubeMesh);
+  }
+}
+
+void ObjectStore::clear()
+{
+  positions_ = std::vector<glm::vec3>();
+  sizes_ = std::vector<float>();
+  materials_ = std::vector<std::uint16_t>();
+  meshes_ = std::vector<std::uint16_t>();
+  materialTextures_.clear();
+}
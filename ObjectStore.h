@@ -0,0 +1,171 @@
+#ifndef OBJECTSTORE_H
+#define OBJECTSTORE_H
+
+/** @file
+* @brief Structure of arrays storing the objects of the scene
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include "Include/glm/glm.hpp"
+#include "Texture.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+* @brief The ObjectHandle class
+* @details 32 bits index of an object in the ObjectStore. The handle 0 is the null handle, i.e. no object: it is the
+* empty value of the scene octree, which stores handles instead of the objects themselves.
+*/
+class ObjectHandle
+{
+public:
+  explicit ObjectHandle(std::uint32_t index = 0):
+    index_ {index}
+  {
+  }
+
+  std::uint32_t index() const
+  {
+    return index_;
+  }
+
+  bool operator==(ObjectHandle const & handle) const
+  {
+    return index_ == handle.index_;
+  }
+
+  bool operator!=(ObjectHandle const & handle) const
+  {
+    return index_ != handle.index_;
+  }
+
+private:
+  std::uint32_t index_;
+};
+
+/**
+* @brief The ObjectStore class
+* @details Stores the objects of the scene as a structure of arrays: positions, sizes, material ids and mesh ids each
+* live in their own contiguous array, indexed by the object handle. An object takes 20 bytes and no allocation of its
+* own, and the passes over the objects (culling, filling the instance buffer) stream through dense memory, all the more
+* as the objects are added in Morton order, the order of the octree traversals.
+* Like the TextureFactory, there is a single store, shared by the whole application.
+*/
+class ObjectStore
+{
+public:
+  /**
+  * @brief The meshes the objects can have
+  */
+  enum Mesh : std::uint16_t
+  {
+    CubeMesh = 0
+  };
+
+  /**
+  * @brief Gives the id of the material of the given texture, creating the material if needed
+  * @param texture The texture image file, loaded through the TextureFactory
+  * @return The material id
+  */
+  static std::uint16_t addMaterial(std::string const & texture);
+
+  /**
+  * @brief Adds an object to the store
+  * @param position The position of the center of the object
+  * @param size The size of the object
+  * @param material The material id, see addMaterial()
+  * @param mesh The mesh id
+  * @return The handle of the new object, never the null handle
+  */
+  static ObjectHandle add(glm::vec3 const & position, float size, std::uint16_t material, std::uint16_t mesh = CubeMesh);
+
+  /**
+  * @brief Adds the given number of objects at once, to be filled with set()
+  * @details The objects get consecutive handles, so that several threads can fill distinct ranges concurrently
+  * @param objectsCount The number of objects
+  * @return The handle of the first new object
+  */
+  static ObjectHandle allocate(unsigned long objectsCount);
+
+  /**
+  * @brief Sets all the data of an object
+  * @details Only touches the element of the handle in each array, so it can be called from several threads for
+  * different objects
+  */
+  static void set(ObjectHandle handle, glm::vec3 const & position, float size, std::uint16_t material, std::uint16_t mesh = CubeMesh);
+
+  /**
+  * @brief Reserves the memory of the given number of objects
+  */
+  static void reserve(unsigned long objectsCount);
+
+  static glm::vec3 const & position(ObjectHandle handle);
+
+  /**
+  * @brief Moves an object
+  * @details Only the store is updated, the octree of the scene is updated by the caller
+  */
+  static void setPosition(ObjectHandle handle, glm::vec3 const & position);
+
+  static float size(ObjectHandle handle);
+  static std::uint16_t material(ObjectHandle handle);
+  static std::uint16_t mesh(ObjectHandle handle);
+
+  /**
+  * @brief Gives the OpenGL id of the texture of a material
+  */
+  static GLuint textureId(std::uint16_t material);
+
+  /**
+  * @brief Gives the colour of an object seen from afar, the mean colour of its texture
+  * @return The RGB colour, each channel in [0, 1]
+  */
+  static glm::vec3 color(ObjectHandle handle);
+
+  /**
+  * @brief Gives the number of objects in the store
+  */
+  static unsigned long objectsCount();
+
+  /**
+  * @brief Gives the memory used by the arrays of the store in bytes
+  */
+  static unsigned long bytes();
+
+  /**
+  * @brief Gives the memory used by one object in the arrays of the store in bytes
+  */
+  static unsigned long objectBytes();
+
+  /**
+  * @brief Removes all the objects and materials
+  */
+  static void clear();
+
+private:
+  /**
+  * @brief Adds the null object, of handle 0, if the store is empty
+  */
+  static void addNullObject();
+
+  /**
+  * @brief The positions of the objects. The element 0 is the null object
+  */
+  static std::vector<glm::vec3> positions_;
+
+  static std::vector<float> sizes_;
+  static std::vector<std::uint16_t> materials_;
+  static std::vector<std::uint16_t> meshes_;
+
+  /**
+  * @brief The texture of each material, indexed by material id
+  */
+  static std::vector<std::shared_ptr<Texture>> materialTextures_;
+};
+
+#endif // OBJECTSTORE_H
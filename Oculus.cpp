@@ -10,7 +10,7 @@ NullOculus::~NullOculus()
 
 bool GenericOculus::isMoving() const
 {
-  spdlog::get("console")->debug() << "Generic Oculus is not moving";
+  LOG_DEBUG("Generic Oculus is not moving");
   return false;
 }
 
@@ -18,9 +18,11 @@
 #define GL3_PROTOTYPES 1
 #include "Include/GL3/gl3.h"
 #include "Include/glm/glm.hpp"
+#include "Profiler.h"
+#include "GLState.h"
 #include "SDL2/SDL_syswm.h"
 #include "Utils.h"
-#include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
 
 #include <iostream>
 //To ignore the asserts uncomment this line:
@@ -95,7 +97,7 @@ public:
         //Cannot create the debug hmd
         assert(hmd_);
 
-        spdlog::get("console")->debug() << "Using the debug hmd";
+        LOG_DEBUG("Using the debug hmd");
       }
 
       ovrHmd_GetDesc(hmd_, &hmdDesc_);
@@ -131,7 +133,7 @@ public:
     ~Oculus()
     {
       glDeleteFramebuffers(1, &FBOId_);
-      glDeleteTextures(1, &textureId_);
+      GLState::deleteTexture(textureId_);
       glDeleteRenderbuffers(1, &depthBufferId_);
 
       ovrHmd_Destroy(hmd_);
@@ -146,9 +148,12 @@ public:
     */
     void render()
     {
+      PROFILE_SCOPE("Oculus::render");
+
+      GLState::bindVertexArray(0);
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-      glBindBuffer(GL_ARRAY_BUFFER, 0);
-      glUseProgram(0);
+      GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+      GLState::useProgram(0);
 
       frameTiming_ = ovrHmd_BeginFrame(hmd_, 0);
 
@@ -164,6 +169,8 @@ public:
 
       for (int eyeIndex = 0; eyeIndex < ovrEye_Count; eyeIndex++)
       {
+        PROFILE_SCOPE("Oculus::renderEye");
+
         ovrEyeType eye = hmdDesc_.EyeRenderOrder[eyeIndex];
         eyeRenderPose[eye] = ovrHmd_BeginEyeRender(hmd_, eye);
 
@@ -187,9 +194,13 @@ public:
         Utils::GLGetError();
 
         ovrHmd_EndEyeRender(hmd_, eye, eyeRenderPose[eye], &eyeTexture_[eye].Texture);
+
+        //The SDK binds on its own
+        GLState::invalidate();
       }
 
       ovrHmd_EndFrame(hmd_);
+      GLState::invalidate();
     }
 
     /**
@@ -247,24 +258,24 @@ public:
 
         dAngles_ = angles_ - oldAngles;
 
-        spdlog::get("console")->debug() << "Angles: "
+        LOG_DEBUG("Angles: "
         << OVR::RadToDegree(angles_[0]) << ", "
         << OVR::RadToDegree(angles_[1]) << ", "
-        << OVR::RadToDegree(angles_[1]) << " degrees";
+        << OVR::RadToDegree(angles_[1]) << " degrees");
 
-        spdlog::get("console")->debug() << "Angles: "
+        LOG_DEBUG("Angles: "
         << angles_[0] << ", "
         << angles_[1] << ", "
-        << angles_[1] << " rad";
+        << angles_[1] << " rad");
 
-        spdlog::get("console")->debug() << "DAngles: "
+        LOG_DEBUG("DAngles: "
         << OVR::RadToDegree(dAngles_[0]) << ", "
         << OVR::RadToDegree(dAngles_[1]) << ", "
-        << OVR::RadToDegree(dAngles_[1]) << " degrees";
+        << OVR::RadToDegree(dAngles_[1]) << " degrees");
       }
       else
       {
-        spdlog::get("console")->debug() << "No input data (using debug hmd)";
+        LOG_DEBUG("No input data (using debug hmd)");
       }
     }
 
@@ -279,7 +290,7 @@ public:
       // The texture we're going to render to...
       glGenTextures(1, &textureId_);
       // "Bind" the newly created texture : all future texture functions will modify this texture...
-      glBindTexture(GL_TEXTURE_2D, textureId_);
+      GLState::bindTexture(GL_TEXTURE_2D, textureId_);
       // Give an empty image to OpenGL (the last "0")
       glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureSize_.w, textureSize_.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
       // Linear filtering...
@@ -345,7 +356,7 @@ public:
 
       // Unbind...
       glBindRenderbuffer(GL_RENDERBUFFER, 0);
-      glBindTexture(GL_TEXTURE_2D, 0);
+      GLState::bindTexture(GL_TEXTURE_2D, 0);
       glBindFramebuffer(GL_FRAMEBUFFER, 0);
       Utils::GLGetError();
 
@@ -424,7 +435,7 @@ public:
       windowSize_.w = scene_.windowWidth();
       windowSize_.h = scene_.windowHeight();
 
-      spdlog::get("console")->debug() << "Fov: " << Utils::radToDegree(2 * atan(hmdDesc_.DefaultEyeFov[0].UpTan));
+      LOG_DEBUG("Fov: " << Utils::radToDegree(2 * atan(hmdDesc_.DefaultEyeFov[0].UpTan)));
 
       textureSizeLeft_ = ovrHmd_GetFovTextureSize(hmd_, ovrEye_Left, hmdDesc_.DefaultEyeFov[0], 1.0f);
       textureSizeRight_ = ovrHmd_GetFovTextureSize(hmd_, ovrEye_Right, hmdDesc_.DefaultEyeFov[1], 1.0f);
@@ -3,10 +3,11 @@
 #include "Include/glm/gtc/type_ptr.hpp"
 
 Plane::Plane(float x, float y, float z, float width, float height, float repeatWidth, float repeatHeight, std::string const & vertexShader, std::string const & fragmentShader, std::string const &  textureFile):
-  GraphicObject(x, y, z, width, vertexShader, fragmentShader),
+  GraphicObject(x, y, z, width),
   texture_ (nullptr)
   {
-    shader_->load();
+    shader_ = ShaderFactory::createShader(vertexShader, fragmentShader);
+    modelLocation_ = shader_->uniformLocation("model");
     texture_ = TextureFactory::createTexture(textureFile);
 
     width /= 2;
@@ -26,33 +27,21 @@ Plane::Plane(float x, float y, float z, float width, float height, float repeatW
 
   }
 
-  void Plane::draw(glm::mat4 &projection, glm::mat4 &modelview)
+  void Plane::draw()
   {
-    modelview = glm::translate(modelview, position_);
+    // Activation du shader, laissé actif après le rendu, voir GLState
+    shader_->use();
 
-    glUseProgram(shader_->programID());
+    GLState::bindVertexArray(VAOId_);
 
-    glBindVertexArray(VAOId_);
-
-    // Envoi des matrices
-    glUniformMatrix4fv(glGetUniformLocation(shader_->programID(), "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    glUniformMatrix4fv(glGetUniformLocation(shader_->programID(), "modelview"), 1, GL_FALSE, glm::value_ptr(modelview));
+    // Envoi de la matrice de l'objet, la vue et la projection sont dans le buffer de la caméra
+    glUniformMatrix4fv(modelLocation_, 1, GL_FALSE, glm::value_ptr(glm::translate(position_)));
 
     // Verrouillage de la texture
-    glBindTexture(GL_TEXTURE_2D, texture_->id());
+    texture_->bind();
 
     // Rendu
     glDrawArrays(GL_TRIANGLES, 0, 6);
-
-    // Déverrouillage de la texture
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glBindVertexArray(0);
-
-    // Désactivation du shader
-    glUseProgram(0);
-
-    modelview = glm::translate(modelview, - position_);
   }
 
   void Plane::load()
@@ -60,26 +49,26 @@ Plane::Plane(float x, float y, float z, float width, float height, float repeatW
     //VBO
     if (glIsBuffer(VBOId_))
     {
-      glDeleteBuffers(1, &VBOId_);
+      GLState::deleteBuffer(VBOId_);
     }
 
     glGenBuffers(1, &VBOId_);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOId_);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBOId_);
 
     glBufferData(GL_ARRAY_BUFFER, nbVerticesBytes() + nbTextureBytes(), 0, GL_STATIC_DRAW);
     glBufferSubData(GL_ARRAY_BUFFER, 0, nbVerticesBytes(), &vertices_[0]);
     glBufferSubData(GL_ARRAY_BUFFER, nbVerticesBytes(), nbTextureBytes(), &textureCoord_[0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     //VAO
     if (glIsVertexArray(VAOId_))
-    glDeleteVertexArrays(1, &VAOId_);
+    GLState::deleteVertexArray(VAOId_);
 
     glGenVertexArrays(1, &VAOId_);
-    glBindVertexArray(VAOId_);
+    GLState::bindVertexArray(VAOId_);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBOId_);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBOId_);
 
     // Envoi des vertices
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0,  BUFFER_OFFSET(0));
@@ -89,9 +78,9 @@ Plane::Plane(float x, float y, float z, float width, float height, float repeatW
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0,  BUFFER_OFFSET(nbVerticesBytes()));
     glEnableVertexAttribArray(2);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
   }
 
   int Plane::nbTextureBytes()
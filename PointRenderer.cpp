@@ -0,0 +1,107 @@
+#include "PointRenderer.h"
+#include "GraphicObject.h"
+#include "Log.h"
+
+PointRenderer::PointRenderer(std::string const & vertexShader, std::string const & fragmentShader):
+  shader_ {nullptr},
+  VBOId_ {0},
+  VAOId_ {0},
+  pointsCount_ {0}
+  {
+    //Shared shader pool
+    shader_ = ShaderFactory::createShader(vertexShader, fragmentShader);
+
+    load();
+  }
+
+  PointRenderer::PointRenderer():
+    PointRenderer("../Shaders/point.vert", "../Shaders/point.frag")
+    {
+    }
+
+    PointRenderer::~PointRenderer()
+    {
+      if (glIsBuffer(VBOId_))
+      {
+        GLState::deleteBuffer(VBOId_);
+      }
+
+      if (glIsVertexArray(VAOId_))
+      {
+        GLState::deleteVertexArray(VAOId_);
+      }
+    }
+
+    void PointRenderer::load()
+    {
+      //Points VBO, filled every frame
+      if (glIsBuffer(VBOId_))
+      {
+        GLState::deleteBuffer(VBOId_);
+      }
+
+      glGenBuffers(1, &VBOId_);
+
+      //VAO
+      if (glIsVertexArray(VAOId_))
+      {
+        GLState::deleteVertexArray(VAOId_);
+      }
+
+      glGenVertexArrays(1, &VAOId_);
+      GLState::bindVertexArray(VAOId_);
+
+      GLState::bindBuffer(GL_ARRAY_BUFFER, VBOId_);
+
+      //(x, y, z, diameter) then (r, g, b, 1), interleaved
+      glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec4), BUFFER_OFFSET(0));
+      glEnableVertexAttribArray(3);
+
+      glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec4), BUFFER_OFFSET(sizeof(glm::vec4)));
+      glEnableVertexAttribArray(1);
+
+      GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+      GLState::bindVertexArray(0);
+    }
+
+    void PointRenderer::add(glm::vec3 const & position, glm::vec3 const & color, float diameter)
+    {
+      points_.push_back(glm::vec4(position, diameter));
+      points_.push_back(glm::vec4(color, 1.0));
+    }
+
+    void PointRenderer::draw()
+    {
+      pointsCount_ = points_.size() / 2;
+
+      if (points_.empty())
+      {
+        return;
+      }
+
+      shader_->use();
+
+      GLState::bindVertexArray(VAOId_);
+
+      //Orphan the previous buffer so that the driver does not wait for the previous frame
+      GLState::bindBuffer(GL_ARRAY_BUFFER, VBOId_);
+      glBufferData(GL_ARRAY_BUFFER, points_.size() * sizeof(glm::vec4), 0, GL_STREAM_DRAW);
+      glBufferSubData(GL_ARRAY_BUFFER, 0, points_.size() * sizeof(glm::vec4), points_.data());
+
+      //The vertex shader sets the size of each point
+      glEnable(GL_PROGRAM_POINT_SIZE);
+
+      glDrawArrays(GL_POINTS, 0, pointsCount_);
+
+      glDisable(GL_PROGRAM_POINT_SIZE);
+
+      points_.clear();
+
+      LOG_DEBUG("Point rendering: " << pointsCount_ << " points");
+    }
+
+    unsigned long PointRenderer::pointsCount() const
+    {
+      return pointsCount_;
+    }
@@ -0,0 +1,80 @@
+#ifndef POINTRENDERER_H
+#define POINTRENDERER_H
+
+/** @file
+* @brief Rendering of the distant octants as points
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include "Include/glm/glm.hpp"
+#include "Shader.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+* @brief The PointRenderer class
+* @details Draws the objects and octants which are too far to be drawn as crates, in a single GL_POINTS draw call. A
+* point smaller than 2 pixels is drawn as a plain point, a bigger one as a round sprite fading out towards its edge.
+*/
+class PointRenderer
+{
+public:
+  PointRenderer(std::string const & vertexShader, std::string const & fragmentShader);
+  PointRenderer();
+  ~PointRenderer();
+
+  /**
+  * @brief Creates the OpenGL resources (point buffer & VAO)
+  */
+  void load();
+
+  /**
+  * @brief Queues a point to be drawn in the current frame
+  * @param position The position of the center of the point
+  * @param color The RGB colour of the point
+  * @param diameter The diameter of the point on screen, in pixels
+  */
+  void add(glm::vec3 const & position, glm::vec3 const & color, float diameter);
+
+  /**
+  * @brief Draws all the queued points and empties the queue
+  * @details The view and projection matrices are read from the camera uniform buffer, see CameraUniforms
+  */
+  void draw();
+
+  /**
+  * @brief Gives the number of points drawn during the last call to draw()
+  */
+  unsigned long pointsCount() const;
+
+private:
+  /**
+  * @brief The shader program, shared through the ShaderFactory
+  */
+  std::shared_ptr<Shader> shader_;
+
+  /**
+  * @brief The OpenGL id of the VBO storing the points, rewritten every frame
+  */
+  GLuint VBOId_;
+
+  /**
+  * @brief The OpenGL id of the VAO binding the point buffer
+  */
+  GLuint VAOId_;
+
+  /**
+  * @brief The queued points
+  * @details Each point is stored as (x, y, z, diameter) followed by (r, g, b, 1). The vector is cleared but not freed
+  * between frames.
+  */
+  std::vector<glm::vec4> points_;
+
+  unsigned long pointsCount_;
+};
+
+#endif // POINTRENDERER_H
@@ -0,0 +1,90 @@
+#include "Profiler.h"
+#include "spdlog/include/spdlog/spdlog.h"
+
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+
+std::atomic<bool> Profiler::enabled_ {false};
+std::string Profiler::traceFile_;
+Profiler::Clock::time_point Profiler::origin_;
+std::vector<Profiler::Event> Profiler::events_;
+std::mutex Profiler::mutex_;
+
+void Profiler::enable(std::string const & traceFile)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  traceFile_ = traceFile;
+  origin_ = Clock::now();
+  events_.clear();
+  //A few seconds of frames without reallocation
+  events_.reserve(1 << 16);
+  enabled_ = true;
+}
+
+bool Profiler::enabled()
+{
+  return enabled_;
+}
+
+void Profiler::record(const char* name, Clock::time_point start, Clock::time_point end)
+{
+  //Microseconds, the unit of the trace event format
+  double startUs = std::chrono::duration<double, std::micro>(start - origin_).count();
+  double durationUs = std::chrono::duration<double, std::micro>(end - start).count();
+  unsigned long threadId = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.push_back({name, startUs, durationUs, threadId});
+}
+
+void Profiler::writeTrace()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!enabled_)
+  {
+    return;
+  }
+
+  std::ofstream out(traceFile_.c_str());
+  if (!out)
+  {
+    throw std::runtime_error("Profiler: cannot write the trace file " + traceFile_);
+  }
+
+  //Complete events ("ph": "X"), one per timed scope
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  for (unsigned long i = 0; i < events_.size(); i++)
+  {
+    Event const & event = events_[i];
+    out << "{\"name\": \"" << event.name << "\", \"cat\": \"frame\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+    << event.threadId % 100000 << ", \"ts\": " << event.start << ", \"dur\": " << event.duration << "}"
+    << (i + 1 < events_.size() ? ",\n" : "\n");
+  }
+  out << "]}\n";
+
+  spdlog::get("console")->info() << "Trace of " << events_.size() << " events written to " << traceFile_;
+}
+
+ProfileScope::ProfileScope(const char* name):
+  name_ {name},
+  enabled_ {Profiler::enabled()}
+  {
+    if (enabled_)
+    {
+      start_ = Profiler::Clock::now();
+    }
+  }
+
+  ProfileScope::~ProfileScope()
+  {
+    if (enabled_)
+    {
+      Profiler::record(name_, start_, Profiler::Clock::now());
+    }
+  }
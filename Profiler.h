@@ -0,0 +1,100 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/** @file
+* @brief Scoped timers of the frame stages, exported in the Chrome trace event format
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+* @brief The Profiler class
+* @details Records the start and the duration of the timed stages and writes them as a Chrome trace
+* (chrome://tracing or ui.perfetto.dev). Nothing is recorded until a trace file is given to enable(), so the timers only
+* cost a branch when no trace is requested. Without SIMULATION_PROFILING, PROFILE_SCOPE expands to nothing.
+*/
+class Profiler
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+  * @brief Starts recording
+  * @param traceFile The JSON file the trace is written to by writeTrace()
+  */
+  static void enable(std::string const & traceFile);
+
+  /**
+  * @brief Tells if the stages are currently recorded
+  */
+  static bool enabled();
+
+  /**
+  * @brief Records a stage
+  * @param name The name of the stage, must be a string literal (only the pointer is kept)
+  * @param start The beginning of the stage
+  * @param end The end of the stage
+  */
+  static void record(const char* name, Clock::time_point start, Clock::time_point end);
+
+  /**
+  * @brief Writes all the recorded stages to the trace file, if enabled
+  */
+  static void writeTrace();
+
+private:
+  struct Event
+  {
+    const char* name;
+    double start;
+    double duration;
+    unsigned long threadId;
+  };
+
+  static std::atomic<bool> enabled_;
+  static std::string traceFile_;
+
+  /**
+  * @brief The time origin of the trace
+  */
+  static Clock::time_point origin_;
+
+  static std::vector<Event> events_;
+  static std::mutex mutex_;
+};
+
+/**
+* @brief The ProfileScope class
+* @details Times the enclosing scope and records it in the Profiler when it ends
+*/
+class ProfileScope
+{
+public:
+  explicit ProfileScope(const char* name);
+  ~ProfileScope();
+
+private:
+  const char* name_;
+  bool enabled_;
+  Profiler::Clock::time_point start_;
+};
+
+#ifdef SIMULATION_PROFILING
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+/**
+* @brief Times the enclosing scope under the given name
+*/
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__) (name)
+#else
+#define PROFILE_SCOPE(name) do {} while (0)
+#endif
+
+#endif // PROFILER_H
@@ -2,23 +2,47 @@
 
 #include "Cube.h"
 #include "Input.h"
-#include "Crate.h"
+#include "Profiler.h"
+#include "InstancedRenderer.h"
+#include "PointRenderer.h"
+#include "ThreadPool.h"
+#include "CameraUniforms.h"
+#include "GLState.h"
+#include "NBody.h"
+#include "BarnesHut.h"
+#include "DirectSummation.h"
+#include "SimulationThread.h"
+#include "StarCatalog.h"
 #include "Texture.h"
 #include "Camera.h"
-#include "GraphicObject.h"
 #include "Plane.h"
 #include "Utils.h"
 #include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
 
 #include <numeric>
 #include <random>
+#include <tuple>
 #include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
 
 using namespace std;
 
 std::unique_ptr<NullOculus> nullOculus(new NullOculus);
 
-Scene::Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oculusRender, bool fullscreen, std::string textureName, unsigned long objectsCount, int size, int octantSize, int  octantsDrawnCount):
+void OctreeSummaryTraits<ObjectHandle>::color(ObjectHandle const & handle, float color[3])
+{
+  glm::vec3 c = ObjectStore::color(handle);
+  color[0] = c.r;
+  color[1] = c.g;
+  color[2] = c.b;
+}
+
+Scene::Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oculusRender, bool fullscreen, bool headless, std::string textureName, unsigned long objectsCount, int size, int octantSize, int  octantsDrawnCount, bool gravity, float openingAngle, bool directGravity, std::string const & catalogFile):
   gObjectsCount_ {objectsCount},
   size_ {size},
   //1 to only draw the octant the camera is in, 2 to draw the immediate neighbours, etc. Power of 2
@@ -28,48 +52,88 @@ Scene::Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oc
   windowWidth_ {windowWidth},
   windowHeight_ {windowHeight},
   window_ {nullptr},
+  context_ {nullptr},
   gObjects_ {size_},
   fullscreen_ {fullscreen},
   oculusRender_ {oculusRender},
-  fps_ {0},
+  headless_ {headless},
+  frameStats_ {},
   frameCount_ {0},
-  textureName_ {textureName}
+  lastCameraMove_ {FrameStats::Clock::now()},
+  textureName_ {textureName},
+  catalogFile_ {catalogFile},
+  simulationThread_ {nullptr},
+  firstBody_ {},
+  bodyCells_ {},
+  moves_ {}
   {
     input_ = std::unique_ptr<Input>(new Input(this));
-    input_->showCursor(false);
-    input_->capturePointer(true);
+
+    if (!headless_)
+    {
+      input_->showCursor(false);
+      input_->capturePointer(true);
+    }
 
     camera_ = std::unique_ptr<Camera>(new Camera(
     glm::vec3(size_/2, size_/2, size_/2),
     glm::vec3(0, 0, 0), glm::vec3(0, 1, 0),
     0.5,
-    0.2,
+    12,
     *(input_.get()))
     );
 
-    gObjects_.setEmptyValue(std::shared_ptr<NullGraphicObject>(new NullGraphicObject));
-
-    assert(initWindow());
-    spdlog::get("console")->debug() << "Window was initialized";
+    if (headless_)
+    {
+      assert(initHeadless());
+      LOG_DEBUG("Offscreen context was initialized");
+    }
+    else
+    {
+      assert(initWindow());
+      LOG_DEBUG("Window was initialized");
+    }
 
     assert(initGL());
-    spdlog::get("console")->debug() << "OpenGL was initialized";
+    LOG_DEBUG("OpenGL was initialized");
+
+    cameraUniforms_ = std::unique_ptr<CameraUniforms>(new CameraUniforms);
+    renderer_ = std::unique_ptr<InstancedRenderer>(new InstancedRenderer);
+    pointRenderer_ = std::unique_ptr<PointRenderer>(new PointRenderer);
+    threadPool_ = std::unique_ptr<ThreadPool>(new ThreadPool);
 
     if (oculusRender_)
     {
       input_->setOculus(std::unique_ptr<GenericOculus>(new Oculus<Scene>(*this)));
-      spdlog::get("console")->debug() << "Oculus view";
+      LOG_DEBUG("Oculus view");
     }
 
     initGObjects();
+
+    if (gravity)
+    {
+      initSimulation(openingAngle, directGravity);
+    }
   }
 
   Scene::~Scene()
   {
+    renderer_.reset();
+    pointRenderer_.reset();
+    cameraUniforms_.reset();
+    ObjectStore::clear();
     TextureFactory::destroyTextures();
+    ShaderFactory::destroyShaders();
+
+#ifdef SIMULATION_HEADLESS
+    headlessContext_.reset();
+#endif
 
-    SDL_GL_DeleteContext(context_);
-    SDL_DestroyWindow(window_);
+    if (window_)
+    {
+      SDL_GL_DeleteContext(context_);
+      SDL_DestroyWindow(window_);
+    }
     SDL_Quit();
   }
 
@@ -123,11 +187,29 @@ Scene::Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oc
     return true;
   }
 
+  bool Scene::initHeadless()
+  {
+#ifdef SIMULATION_HEADLESS
+    headlessContext_ = std::unique_ptr<HeadlessContext>(new HeadlessContext(windowWidth_, windowHeight_));
+
+    return headlessContext_->initContext();
+#else
+    spdlog::get("console")->error() << "Error: this build does not support the headless mode";
+
+    return false;
+#endif
+  }
+
   bool Scene::initGL()
   {
     glewExperimental = GL_TRUE;
     GLenum initGLEW( glewInit() );
-    if (initGLEW != GLEW_OK)
+    if (initGLEW != GLEW_OK && headless_)
+    {
+      //GLEW may be built for GLX only, the core functions are still available through libGL
+      spdlog::get("console")->warn() << "GLEW could not be initialized in headless mode: " << glewGetErrorString(initGLEW);
+    }
+    else if (initGLEW != GLEW_OK)
     {
       spdlog::get("console")->error() << "Error opening GLEW : " << glewGetErrorString(initGLEW);
 
@@ -140,53 +222,328 @@ Scene::Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oc
 
     glEnable(GL_DEPTH_TEST);
 
+#ifdef SIMULATION_HEADLESS
+    if (headless_)
+    {
+      return headlessContext_->initFBO();
+    }
+#endif
+
     return true;
   }
 
   void Scene::initGObjects()
   {
-    std::default_random_engine generator;
-    std::uniform_int_distribution<> distribution(0, size_ - 1);
+    //Fixed, so that the chunks do not depend on the number of threads
+    const unsigned long chunkSize = 1 << 14;
 
     auto startGeneration = std::chrono::high_resolution_clock::now();
 
-    for (ulong i=1; i <= gObjectsCount_; i++)
+    //The material loads its texture, it has to be done on the OpenGL thread, before the workers need its id
+    std::uint16_t material = ObjectStore::addMaterial(textureName_);
+
+    //CPU phase, on the thread pool
+    std::vector<Point> points;
+    std::vector<float> sizes;
+    if (catalogFile_.empty())
+    {
+      generatePoints(points);
+    }
+    else
     {
-      int x = distribution(generator);
-      int y = distribution(generator);
-      int z = distribution(generator);
+      loadCatalog(points, sizes);
+    }
 
-      auto startCrateGeneration = std::chrono::high_resolution_clock::now();
-      gObjects_(x, y, z) = std::shared_ptr<Crate>(new Crate(x, y, z, 1.0, textureName_));
-      auto endCrateGeneration = std::chrono::high_resolution_clock::now();
+    //The crates are added to the store in Morton order, the order in which the octree is traversed, so that the
+    //traversals read the store sequentially. The stars of a binary catalog already are: the sort only checks them
+    std::vector<Morton::Entry> entries = Morton::sortPoints(points.begin(), points.end());
 
-      spdlog::get("console")->debug() << "Generated crate n°" << i << " at position ("
-      << x << ", " << y << ", " << z << ") in "
-      << chrono::duration_cast<std::chrono::milliseconds>(endCrateGeneration - startCrateGeneration).count() << " ms";
+    //A cell holds a single object: of the stars falling in the same cell, only the largest, i.e. the brightest, is kept
+    if (!sizes.empty())
+    {
+      unsigned long kept = 0;
+      for (unsigned long i=0; i < entries.size(); i++)
+      {
+        if (kept > 0 && entries[kept - 1].code == entries[i].code)
+        {
+          if (sizes[entries[i].index] > sizes[entries[kept - 1].index])
+          {
+            entries[kept - 1] = entries[i];
+          }
+        }
+        else
+        {
+          entries[kept++] = entries[i];
+        }
+      }
+      entries.resize(kept);
     }
+    gObjectsCount_ = entries.size();
+
+    ObjectHandle first = ObjectStore::allocate(entries.size());
+    firstBody_ = first;
+    threadPool_->parallelFor(entries.size(), chunkSize, [&points, &sizes, &entries, first, material] (unsigned long begin, unsigned long end, unsigned long) {
+      for (unsigned long i=begin; i < end; i++)
+      {
+        auto & point = points[entries[i].index];
+        ObjectHandle handle(first.index() + i);
+        float size = sizes.empty() ? 1.0f : sizes[entries[i].index];
+        ObjectStore::set(handle, glm::vec3(std::get<0>(point), std::get<1>(point), std::get<2>(point)), size, material);
+        std::get<3>(point) = handle;
+      }
+    });
+
+    //The objects not kept are left out of the octree
+    if (entries.size() < points.size())
+    {
+      std::vector<Point> kept(entries.size());
+      threadPool_->parallelFor(entries.size(), chunkSize, [&points, &entries, &kept] (unsigned long begin, unsigned long end, unsigned long) {
+        for (unsigned long i=begin; i < end; i++)
+        {
+          kept[i] = points[entries[i].index];
+        }
+      });
+      points.swap(kept);
+    }
+
+    //Inserted in one pass
+    gObjects_.buildFromPoints(points.begin(), points.end());
+
+    auto endCPUGeneration = std::chrono::high_resolution_clock::now();
+
+    //GPU phase, on the OpenGL thread. The objects have no GPU resources of their own: the buffers shared by all the
+    //objects are allocated once, for the most objects a frame can draw
+    unsigned long boxSize = 2 * octantSize_ * octantsDrawnCount_ + 1;
+    renderer_->reserve(std::min(gObjectsCount_, boxSize * boxSize * boxSize));
+
     auto endGeneration = std::chrono::high_resolution_clock::now();
     auto generationTime = std::chrono::duration_cast<std::chrono::milliseconds>(endGeneration - startGeneration).count();
+    auto cpuTime = std::chrono::duration_cast<std::chrono::milliseconds>(endCPUGeneration - startGeneration).count();
+    auto gpuTime = std::chrono::duration_cast<std::chrono::milliseconds>(endGeneration - endCPUGeneration).count();
+
+    spdlog::get("console")->info() << "Summary: the generation of " << gObjectsCount_ << " graphic objects took " << generationTime << " ms ("
+    << cpuTime << " ms on " << threadPool_->threadsCount() << " threads, " << gpuTime << " ms of GPU uploads)";
+    spdlog::get("console")->info() << "Memory: " << (gObjects_.bytes() + ObjectStore::bytes()) / std::max(ObjectStore::objectsCount(), 1ul)
+    << " bytes per object (octree " << gObjects_.bytes() << " bytes, object store " << ObjectStore::bytes() << " bytes)";
+    spdlog::get("console")->info() << "Shader programs: " << ShaderFactory::compilationsCount() << " compiled, "
+    << ShaderFactory::compilationsAvoidedCount() << " compilations avoided";
+  }
+
+  void Scene::generatePoints(std::vector<Point> & points)
+  {
+    //Fixed, so that the chunks do not depend on the number of threads
+    const unsigned long chunkSize = 1 << 14;
+    const unsigned int seed = 0;
+
+    //Each chunk draws its positions from its own random stream, seeded with the index of the chunk, so that the scene
+    //is the same whatever the number of threads
+    points.resize(gObjectsCount_);
+    threadPool_->parallelFor(points.size(), chunkSize, [this, &points, seed] (unsigned long begin, unsigned long end, unsigned long chunk) {
+      std::seed_seq chunkSeed {static_cast<unsigned long>(seed), chunk};
+      std::mt19937 generator(chunkSeed);
+      std::uniform_int_distribution<> distribution(0, size_ - 1);
+
+      for (unsigned long i=begin; i < end; i++)
+      {
+        int x = distribution(generator);
+        int y = distribution(generator);
+        int z = distribution(generator);
 
-    spdlog::get("console")->info() << "Summary: the generation of " << gObjectsCount_ << " graphic objects took " << generationTime << " ms";
+        points[i] = std::make_tuple(x, y, z, ObjectHandle());
+      }
+    });
+  }
+
+  void Scene::loadCatalog(std::vector<Point> & points, std::vector<float> & sizes)
+  {
+    //The faintest stars are drawn a quarter of a cell wide
+    const float minSize = 0.25f;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    StarCatalog catalog(catalogFile_, *threadPool_);
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    Stars const & stars = catalog.stars();
+    spdlog::get("console")->info() << "Catalog: " << stars.size() << " stars read from " << catalogFile_ << " ("
+    << catalog.fileBytes() / 1e6 << " MB) in " << seconds * 1e3 << " ms, " << catalog.fileBytes() / 1e6 / std::max(seconds, 1e-9)
+    << " MB/s on " << threadPool_->threadsCount() << " threads; " << catalog.skippedRowsCount() << " of "
+    << catalog.rowsCount() << " rows skipped for lack of a distance";
+
+    //The bounding cube of the stars is the data cube
+    int bits = 0;
+    while ((1 << bits) < size_)
+    {
+      bits++;
+    }
+
+    //The apparent radius of a star follows the square root of its flux, 10^(-0.4 m), 1 cell for the brightest
+    float brightest = stars.size() ? *std::min_element(stars.magnitude.begin(), stars.magnitude.end()) : 0;
+
+    points.resize(stars.size());
+    sizes.resize(stars.size());
+    threadPool_->parallelFor(stars.size(), 1 << 14, [&] (unsigned long begin, unsigned long end, unsigned long) {
+      for (unsigned long i=begin; i < end; i++)
+      {
+        glm::ivec3 cell = catalog.cell(glm::vec3(stars.x[i], stars.y[i], stars.z[i]), bits);
+
+        points[i] = std::make_tuple(cell.x, cell.y, cell.z, ObjectHandle());
+        sizes[i] = std::max(std::pow(10.0f, -0.2f * (stars.magnitude[i] - brightest)), minSize);
+      }
+    });
+
+    //The camera starts at the Sun
+    camera_->setPosition(glm::vec3(catalog.cell(glm::vec3(0), bits)));
+  }
+
+  void Scene::initSimulation(float openingAngle, bool direct)
+  {
+    //Simulation units: the cell, the second and G = 1
+    const float pi = 3.14159265358979f;
+    const float timestep = 1.0f / 60;
+    const float softening = 0.5f;
+    const float period = 60;
+
+    std::unique_ptr<GravitySolver> solver;
+    if (direct)
+    {
+      solver = std::unique_ptr<GravitySolver>(new DirectSummation(*threadPool_, softening));
+    }
+    else
+    {
+      solver = std::unique_ptr<GravitySolver>(new BarnesHut(*threadPool_, openingAngle, softening));
+    }
+
+    std::unique_ptr<NBodySimulation> simulation(new NBodySimulation(std::move(solver), *threadPool_, timestep));
+
+    Bodies & bodies = simulation->bodies();
+    bodies.resize(gObjectsCount_);
+    bodyCells_.resize(gObjectsCount_);
+
+    //The angular speed is the circular speed at the surface of a uniform sphere of radius size/2 and of the total mass
+    const float omega = 2 * pi / period;
+    const float radius = size_ / 2.0f;
+    const float mass = omega * omega * radius * radius * radius / std::max(gObjectsCount_, 1ul);
+    const glm::vec3 center(size_ / 2.0f);
+
+    threadPool_->parallelFor(gObjectsCount_, 1 << 14, [&] (unsigned long begin, unsigned long end, unsigned long) {
+      for (unsigned long i=begin; i < end; i++)
+      {
+        glm::vec3 position = ObjectStore::position(ObjectHandle(firstBody_.index() + i));
+
+        bodies.x[i] = position.x;
+        bodies.y[i] = position.y;
+        bodies.z[i] = position.z;
+        bodies.vx[i] = omega * (position.z - center.z);
+        bodies.vy[i] = 0;
+        bodies.vz[i] = - omega * (position.x - center.x);
+        bodies.mass[i] = mass;
+
+        bodyCells_[i] = cellOf(position);
+      }
+    });
+
+    if (direct)
+    {
+      spdlog::get("console")->info() << "Gravity: " << gObjectsCount_ << " bodies, " << simulation->solver().name();
+    }
+    else
+    {
+      spdlog::get("console")->info() << "Gravity: " << gObjectsCount_ << " bodies, " << simulation->solver().name()
+      << " with an opening angle of " << openingAngle;
+    }
+
+    simulationThread_ = std::unique_ptr<SimulationThread>(new SimulationThread(std::move(simulation)));
+    simulationThread_->start();
+  }
+
+  void Scene::updateSimulation()
+  {
+    if (!simulationThread_)
+    {
+      return;
+    }
+
+    PROFILE_SCOPE("Scene::moveBodies");
+
+    SimulationThread::State const & state = simulationThread_->latest();
+    const float alpha = simulationThread_->alpha(state);
+
+    for (unsigned long i=0; i < state.x.size(); i++)
+    {
+      ObjectHandle handle(firstBody_.index() + i);
+      glm::vec3 position = glm::mix(glm::vec3(state.previousX[i], state.previousY[i], state.previousZ[i]),
+      glm::vec3(state.x[i], state.y[i], state.z[i]), alpha);
+      ObjectStore::setPosition(handle, position);
+
+      //The octree holds 1 object per cell: the body waits for its new cell to be free
+      glm::ivec3 cell = cellOf(position);
+      if (cell != bodyCells_[i] && gObjects_.at(cell.x, cell.y, cell.z) == ObjectHandle())
+      {
+        moves_.emplace_back(handle, bodyCells_[i], cell);
+      }
+    }
+
+    //Several bodies may enter the same free cell in a frame: the first one gets it, the others wait
+    std::sort(moves_.begin(), moves_.end(), [] (Move const & a, Move const & b) {
+      Morton::Code codeA = Morton::encode(std::get<2>(a).x, std::get<2>(a).y, std::get<2>(a).z);
+      Morton::Code codeB = Morton::encode(std::get<2>(b).x, std::get<2>(b).y, std::get<2>(b).z);
+      return codeA < codeB || (codeA == codeB && std::get<0>(a).index() < std::get<0>(b).index());
+    });
+    moves_.erase(std::unique(moves_.begin(), moves_.end(), [] (Move const & a, Move const & b) {
+      return std::get<2>(a) == std::get<2>(b);
+    }), moves_.end());
+
+    {
+      PROFILE_SCOPE("SceneOctree::relocate");
+      gObjects_.relocate(moves_.begin(), moves_.end());
+    }
+
+    for (Move const & move : moves_)
+    {
+      bodyCells_[std::get<0>(move).index() - firstBody_.index()] = std::get<2>(move);
+    }
+
+    LOG_DEBUG("Gravity step " << state.step << " interpolated at " << alpha << ", " << moves_.size() << " bodies changed cell");
+    moves_.clear();
+  }
+
+  glm::ivec3 Scene::cellOf(glm::vec3 const & position) const
+  {
+    return glm::clamp(glm::ivec3(glm::floor(position)), glm::ivec3(0), glm::ivec3(size_ - 1));
   }
 
   void Scene::mainLoop()
   {
     int fpsDesired = 60;
     unsigned int frameRate = 1000 / fpsDesired;
-    Uint32 start (0);
-    Uint32 end  (0);
-    Uint32 elapsedTime (0);
+    bool statsKeyDown = false;
+    lastCameraMove_ = FrameStats::Clock::now();
 
     while( ! input_->isOver())
     {
-      start = SDL_GetTicks();
+      PROFILE_SCOPE("frame");
+
+      auto start = FrameStats::Clock::now();
 
-      input_->updateEvent();
+      {
+        PROFILE_SCOPE("Input::updateEvent");
+        input_->updateEvent();
+      }
 
       if (input_->isKeyboardKeyDown(SDL_SCANCODE_ESCAPE))
       break;
 
+      //Statistics on demand, once per key press
+      if (input_->isKeyboardKeyDown(SDL_SCANCODE_P) && !statsKeyDown)
+      {
+        spdlog::get("console")->info() << "Frame times: " << FrameStats::toString(frameStats_.summary());
+        spdlog::get("console")->info() << "GL binds of the last frame: " << GLState::issuedCount() << " issued, "
+        << GLState::elidedCount() << " elided";
+      }
+      statsKeyDown = input_->isKeyboardKeyDown(SDL_SCANCODE_P);
+
+      updateSimulation();
+
       if (oculusRender_)
       {
         input_->oculus()->render();
@@ -199,28 +556,101 @@ Scene::Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oc
         render();
       }
 
-      SDL_GL_SwapWindow(window_);
+      {
+        PROFILE_SCOPE("SDL_GL_SwapWindow");
+        SDL_GL_SwapWindow(window_);
+      }
 
       //Wait for FPS
-      end = SDL_GetTicks();
-      elapsedTime = end - start;
+      auto elapsedTime = FrameStats::Clock::now() - start;
+
+      GLState::newFrame();
+      updateFrameStats(elapsedTime);
+
+      auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count();
+      if (elapsedMs < frameRate)
+      {
+        SDL_Delay(frameRate - elapsedMs);
+      }
+
+      frameCount_++;
+    }
+
+    doEnd();
+  }
 
-      updateFPS(elapsedTime);
+  void Scene::benchmarkLoop(unsigned long framesCount, std::string const & statsFile)
+  {
+    //Deterministic path: a loop around the center of the data cube, going up and down twice per turn
+    const float pi = 3.14159265358979f;
+    glm::vec3 center(size_ / 2, size_ / 2, size_ / 2);
+    float radius = size_ / 4;
+
+    for (unsigned long i = 0; i < framesCount; i++)
+    {
+      float t = 2 * pi * i / framesCount;
+
+      glm::vec3 position = center + glm::vec3(radius * cos(t), radius / 2 * sin(2 * t), radius * sin(t));
+      glm::vec3 direction(- radius * sin(t), radius * cos(2 * t), radius * cos(t));
+
+      PROFILE_SCOPE("frame");
+
+      auto start = FrameStats::Clock::now();
 
-      if (elapsedTime < frameRate)
+      camera_->setPosition(position);
+      camera_->setOrientation(glm::normalize(direction));
+
+      updateSimulation();
+
+      glClearColor(0, 0, 0, 1);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+      render();
+
+      //Wait for the GPU so that the frame time includes the rendering itself
       {
-        SDL_Delay(frameRate - elapsedTime);
+        PROFILE_SCOPE("glFinish");
+        glFinish();
       }
 
+      frameStats_.record(FrameStats::Clock::now() - start);
+      GLState::newFrame();
       frameCount_++;
     }
 
+    std::ofstream out(statsFile.c_str());
+    if (!out)
+    {
+      throw std::runtime_error("Scene: cannot write the statistics file " + statsFile);
+    }
+
+    out << "{\n"
+    << "  \"objects\": " << gObjectsCount_ << ",\n"
+    << "  \"size\": " << size_ << ",\n"
+    << "  \"width\": " << windowWidth_ << ",\n"
+    << "  \"height\": " << windowHeight_ << ",\n"
+    << "  \"frame_times\": " << FrameStats::toJSON(frameStats_.summary()) << ",\n"
+    << "  \"gl_binds_per_frame\": {\"issued\": " << GLState::totalIssuedCount() / std::max(frameCount_, 1ull)
+    << ", \"elided\": " << GLState::totalElidedCount() / std::max(frameCount_, 1ull) << "}\n"
+    << "}\n";
+
+    spdlog::get("console")->info() << "Headless benchmark written to " << statsFile;
+
     doEnd();
   }
 
   void Scene::doEnd()
   {
-    spdlog::get("console")->info() << "Mean fps: " << fps_;
+    spdlog::get("console")->info() << "Frame times: " << FrameStats::toString(frameStats_.summary());
+    spdlog::get("console")->info() << "GL binds per frame: " << GLState::totalIssuedCount() / std::max(frameCount_, 1ull)
+    << " issued, " << GLState::totalElidedCount() / std::max(frameCount_, 1ull) << " elided";
+
+    if (simulationThread_)
+    {
+      simulationThread_->stop();
+      spdlog::get("console")->info() << "Gravity: " << simulationThread_->latest().step << " steps, "
+      << simulationThread_->skippedStepsCount() << " skipped to keep up with real time";
+    }
   }
 
   void Scene::render()
@@ -230,7 +660,8 @@ Scene::Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oc
 
     double ratio = static_cast<double>(windowWidth_ / windowHeight_);
 
-    projection = glm::perspective(90.0, ratio, 0.01, 100.0);
+    //The whole data cube is in range, its distant octants are drawn as points
+    projection = glm::perspective(90.0, ratio, 0.01, 2.0 * size_);
     modelview = glm::mat4(2.0);
 
     Scene::render(modelview, projection);
@@ -241,18 +672,102 @@ Scene::Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oc
     int sizeToRender = octantSize_ * octantsDrawnCount_;
 
     double e = std::numeric_limits<double>::epsilon();
-    camera_->move(glm::vec3(sizeToRender + e, sizeToRender + e, sizeToRender + e) , glm::vec3(size_ - sizeToRender -e, size_ - sizeToRender -e, size_ - sizeToRender -e));
-    camera_->lookAt(MV);
+    {
+      PROFILE_SCOPE("Camera::move");
+
+      //In Oculus mode the second eye moves by the time since the first one, i.e. almost nothing
+      FrameStats::Clock::time_point now = FrameStats::Clock::now();
+      float elapsed = std::chrono::duration<float>(now - lastCameraMove_).count();
+      lastCameraMove_ = now;
+
+      camera_->move(glm::vec3(sizeToRender + e, sizeToRender + e, sizeToRender + e) , glm::vec3(size_ - sizeToRender -e, size_ - sizeToRender -e, size_ - sizeToRender -e), elapsed);
+      camera_->lookAt(MV);
+    }
 
-    for (int z=camera_->position().z - sizeToRender; z<camera_->position().z + sizeToRender; z++)
+    //Once for all the objects of this eye
+    cameraUniforms_->update(proj, MV);
+
+    glm::vec3 position = camera_->position();
+    glm::ivec3 boxMin = glm::ivec3(position) - sizeToRender;
+    glm::ivec3 boxMax = glm::ivec3(glm::ceil(position)) + sizeToRender;
+
+    //The view frustum, followed by the box around the camera
+    //The cell i is tested as [i - 0.5, i + 1.5], the box planes keep the cells boxMin <= i < boxMax like visitBox
+    float planes[12][4];
+    Utils::frustumPlanes(proj * MV, planes);
+    for (int i=0; i<3; i++)
     {
-      for (int y=camera_->position().y - sizeToRender; y<camera_->position().y + sizeToRender; y++)
+      float* minPlane = planes[6 + 2 * i];
+      float* maxPlane = planes[7 + 2 * i];
+      for (int j=0; j<3; j++)
       {
-        for (int x=camera_->position().x - sizeToRender; x<camera_->position().x + sizeToRender; x++)
+        minPlane[j] = i == j ? 1 : 0;
+        maxPlane[j] = i == j ? -1 : 0;
+      }
+      minPlane[3] = - (boxMin[i] + 1);
+      maxPlane[3] = boxMax[i] - 1;
+    }
+
+    //The crates are batched in the instanced renderer, straight from the object store
+    auto drawObject = [this] (ObjectHandle handle) {
+      renderer_->add(ObjectStore::textureId(ObjectStore::material(handle)), ObjectStore::position(handle), ObjectStore::size(handle));
+    };
+
+#ifdef SIMULATION_LINEAR_OCTREE
+    //Only the allocated cells in the frustum and the box are visited, the subtrees entirely inside are not tested further
+    {
+      PROFILE_SCOPE("Octree::visitFrustum");
+      gObjects_.visitFrustum(planes, 12, 0.5f,
+      [&drawObject] (int, int, int, ObjectHandle handle) {
+        drawObject(handle);
+      });
+    }
+#else
+    //The whole frustum is visited: the objects in the box are drawn as crates, the other ones as points, and the octants
+    //appearing smaller than lodPixels as a single point, from the summary cached in their branch. The number of octants
+    //visited depends on the view, not on the number of objects
+    //Pixels per unit of length at a distance of 1, proj[1][1] being the cotangent of half the vertical field of view
+    float pixelsPerUnit = windowHeight_ / 2.0f * proj[1][1];
+    const float lodPixels = 4;
+    //Never summarize an octant of the box, all its cells are closer than 2 * sizeToRender
+    float lodRatio = std::min(lodPixels / pixelsPerUnit, 1.0f / sizeToRender);
+    float eye[3] = {position.x, position.y, position.z};
+
+    {
+      PROFILE_SCOPE("Octree::visitLOD");
+      gObjects_.visitLOD(planes, 6, 0.5f, eye, lodRatio,
+      [&] (int x, int y, int z, ObjectHandle handle) {
+        glm::ivec3 cell(x, y, z);
+        if (glm::all(glm::greaterThanEqual(cell, boxMin)) && glm::all(glm::lessThan(cell, boxMax)))
         {
-          gObjects_.at(x, y, z)->draw(proj, MV);
+          drawObject(handle);
         }
-      }
+        else
+        {
+          glm::vec3 center = ObjectStore::position(handle);
+          pointRenderer_->add(center, ObjectStore::color(handle), pixelsPerUnit / glm::distance(center, position));
+        }
+      },
+      [&] (int, int, int, int size, OctreeSummary const & summary) {
+        glm::vec3 centroid(summary.centroid(0), summary.centroid(1), summary.centroid(2));
+        glm::vec3 color = glm::vec3(summary.color(0), summary.color(1), summary.color(2)) / static_cast<float>(summary.count());
+
+        //The sprite covers the part of the octant filled with objects, sparse octants end up as plain points
+        float fill = std::cbrt(summary.count() / std::pow(static_cast<float>(size), 3.0f));
+        float distance = std::max(glm::distance(centroid, position), 1.0f);
+        pointRenderer_->add(centroid, color, size * fill * pixelsPerUnit / distance);
+      });
+    }
+#endif
+
+    {
+      PROFILE_SCOPE("InstancedRenderer::draw");
+      renderer_->draw();
+    }
+
+    {
+      PROFILE_SCOPE("PointRenderer::draw");
+      pointRenderer_->draw();
     }
   }
 
@@ -280,18 +795,21 @@ Scene::Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oc
     windowHeight_ = windowHeight;
   }
 
-  void Scene::updateFPS(int elapsedTime)
+  void Scene::updateFrameStats(FrameStats::Clock::duration frameTime)
   {
-    //Avoid dividing by zero
-    elapsedTime == 0 ? elapsedTime = 1 : elapsedTime;
-    int newFps = 1000 / elapsedTime;
+    LOG_DEBUG("Frame time: " << std::chrono::duration<double, std::milli>(frameTime).count() << " ms, GL binds: "
+    << GLState::issuedCount() << " issued, " << GLState::elidedCount() << " elided");
 
-    //Cumulative moving average
-    fps_ = fps_ + (newFps - fps_) / (frameCount_ + 1.0);
+    //The title is only refreshed when a rolling window is completed
+    if (!frameStats_.record(frameTime))
+    {
+      return;
+    }
 
-    spdlog::get("console")->debug() << "Current fps: " << newFps;
-    spdlog::get("console")->debug() << "Current cumulated mean fps: " << fps_;
+    FrameStats::Summary rolling = frameStats_.rollingSummary();
 
-    std::string newTitle = windowTitle_ + " (" + std::to_string(newFps) + "FPS)";
-    SDL_SetWindowTitle(window_, newTitle.c_str());
+    std::ostringstream newTitle;
+    newTitle << windowTitle_ << std::fixed << std::setprecision(1)
+    << " (p50 " << rolling.p50 << " ms, p99 " << rolling.p99 << " ms, max " << rolling.max << " ms)";
+    SDL_SetWindowTitle(window_, newTitle.str().c_str());
   }
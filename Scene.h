@@ -18,22 +18,57 @@
 #include "Include/glm/gtc/type_ptr.hpp"
 
 #include "Shader.h"
+#include "ObjectStore.h"
 #include "SDL2/SDL.h"
 #include "Include/Octree/octree.h"
+#include "Include/Octree/linearoctree.h"
 
 #include <iostream>
 #include <string>
 #include <vector>
 #include <memory>
+#include <tuple>
 
 #define WINDOW_WIDTH 1280
 #define WINDOW_HEIGHT 800
 
+/**
+* @brief The branches of the scene octree cache the count, centroid and summed colour of their objects
+* @details The distant octants are drawn as a single point from them, see Scene::render
+*/
+template <>
+class OctreeSummaryTraits<ObjectHandle>
+{
+public:
+  typedef OctreeSummary Summary;
+
+  static void color(ObjectHandle const & handle, float color[3]);
+};
+
+/**
+* @brief The octree backend of the scene, chosen at compile time
+* @details Octree is the pointer based tree, LinearOctree stores the occupied cells in a sorted Morton array
+* (cmake -DSIMULATION_LINEAR_OCTREE=ON). They share the operations the scene uses to build, update and cull the tree,
+* but LinearOctree has neither visitLOD() nor atBatch() and caches no summaries: with it, render() keeps the hard cut at
+* the render distance, without the level-of-detail points of the far cells.
+*/
+#ifdef SIMULATION_LINEAR_OCTREE
+template <typename T> using SceneOctree = LinearOctree<T>;
+#else
+template <typename T> using SceneOctree = Octree<T>;
+#endif
+
 #include "Oculus.h"
+#include "HeadlessContext.h"
+#include "FrameStats.h"
 
 class Input;
 class Camera;
-class GraphicObject;
+class InstancedRenderer;
+class PointRenderer;
+class ThreadPool;
+class CameraUniforms;
+class SimulationThread;
 
 /**
 * @brief The Scene class
@@ -44,7 +79,7 @@ class Scene
 
 public:
 
-  Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oculusRender, bool fullscreen, std::string textureName, unsigned long objectsCount, int size, int octantSize, int  octantsDrawnCount);
+  Scene(std::string windowTitle, int windowWidth, int windowHeight, bool oculusRender, bool fullscreen, bool headless, std::string textureName, unsigned long objectsCount, int size, int octantSize, int  octantsDrawnCount, bool gravity = false, float openingAngle = 0.5f, bool directGravity = false, std::string const & catalogFile = "");
   ~Scene();
 
   /**
@@ -52,6 +87,15 @@ public:
   */
   void mainLoop();
 
+  /**
+  * @brief The benchmark loop of the headless mode
+  * @details Flies the camera along a deterministic path through the octree, renders the given number of frames and
+  * writes the frame time statistics in JSON
+  * @param framesCount The number of frames to render
+  * @param statsFile The JSON file the statistics are written to
+  */
+  void benchmarkLoop(unsigned long framesCount, std::string const & statsFile);
+
   /**
   * @brief The graphical rendering
   */
@@ -77,6 +121,12 @@ private:
   */
   bool initWindow();
 
+  /**
+  * @brief Creates an offscreen OpenGL context, without any window
+  * @return true if successful, else false
+  */
+  bool initHeadless();
+
   /**
   * @brief Inits OpenGL
   * @return true if successful, else false
@@ -84,15 +134,53 @@ private:
   bool initGL();
 
   /**
-  * @brief Generates graphical objects at random positions
+  * @brief An object to insert in the octree: its cell and its handle
+  */
+  typedef std::tuple<int, int, int, ObjectHandle> Point;
+
+  /**
+  * @brief Generates graphical objects at random positions, or loads the stars of the catalog
+  * @details The positions and the object data are computed on the thread pool, then the GPU resources are created on
+  * the OpenGL thread in one go
   */
   void initGObjects();
 
   /**
-  * @brief Update the current FPS
-  * @param elapsedTime The time the main loop took to render 1 frame
+  * @brief Draws the cells of gObjectsCount_ objects at random
+  */
+  void generatePoints(std::vector<Point> & points);
+
+  /**
+  * @brief Loads the stars of the catalog, gives their cells and their sizes, and moves the camera to the Sun
+  * @details The stars are scaled to fit the data cube
   */
-  void updateFPS(int elapsedTime);
+  void loadCatalog(std::vector<Point> & points, std::vector<float> & sizes);
+
+  /**
+  * @brief Turns the objects into bodies of the gravity simulation and starts its thread
+  * @details The bodies start in a solid rotation around the vertical axis of the center of the scene, with a total
+  * mass such that the rotation takes about a minute
+  * @param openingAngle The opening angle of the Barnes-Hut solver
+  * @param direct Whether the gravity is computed exactly by DirectSummation instead of Barnes-Hut
+  */
+  void initSimulation(float openingAngle, bool direct);
+
+  /**
+  * @brief Moves the objects to the positions of their bodies, interpolated at the current time between the 2 latest
+  * states of the simulation thread
+  */
+  void updateSimulation();
+
+  /**
+  * @brief Gives the cell of the octree containing a position, clamped to the scene
+  */
+  glm::ivec3 cellOf(glm::vec3 const & position) const;
+
+  /**
+  * @brief Records the time of the last frame and shows the rolling statistics in the window title
+  * @param frameTime The time the main loop took to render 1 frame
+  */
+  void updateFrameStats(FrameStats::Clock::duration frameTime);
 
   /**
   * @brief Perform final actions at the end of the scene/program
@@ -101,8 +189,9 @@ private:
 
   /**
   * @brief Number of graphical object present in the scene
+  * @details With a catalog, the number of stars kept, 1 per cell
   */
-  const unsigned long gObjectsCount_;
+  unsigned long gObjectsCount_;
 
   /**
   * @brief Size of the edge of the cubic scene.
@@ -124,7 +213,7 @@ private:
 
   /**
   * @brief The window title
-  * @details It contains the FPS number and is therefore updated every frame
+  * @details It contains the frame time statistics of the last frames and is therefore updated regularly
   */
   std::string windowTitle_;
 
@@ -148,6 +237,13 @@ private:
   */
   SDL_GLContext context_;
 
+#ifdef SIMULATION_HEADLESS
+  /**
+  * @brief The offscreen OpenGL context and framebuffer of the headless mode
+  */
+  std::unique_ptr<HeadlessContext> headlessContext_;
+#endif
+
   /**
   * @brief The input manager
   */
@@ -155,11 +251,32 @@ private:
 
   /**
   * @brief The octree containing all graphical objects in the scene
+  * @details It stores the handles of the objects, which live in the ObjectStore
   */
-  Octree<std::shared_ptr<GraphicObject>> gObjects_;
+  SceneOctree<ObjectHandle> gObjects_;
 
   std::vector<glm::vec3> livingGObjects_;
 
+  /**
+  * @brief The renderer batching the crates of the current frame into instanced draw calls
+  */
+  std::unique_ptr<InstancedRenderer> renderer_;
+
+  /**
+  * @brief The renderer drawing the objects and octants beyond the octants drawn, as points
+  */
+  std::unique_ptr<PointRenderer> pointRenderer_;
+
+  /**
+  * @brief The uniform buffer of the view and projection matrices, written once per frame and per eye
+  */
+  std::unique_ptr<CameraUniforms> cameraUniforms_;
+
+  /**
+  * @brief The worker threads of the CPU heavy tasks, like the generation of the objects
+  */
+  std::unique_ptr<ThreadPool> threadPool_;
+
   /**
   * @brief The camera manager
   */
@@ -176,9 +293,14 @@ private:
   bool oculusRender_;
 
   /**
-  * @brief Current frame per second for the application
+  * @brief Boolean showing if we render offscreen, without any window
   */
-  float fps_;
+  bool headless_;
+
+  /**
+  * @brief The frame time statistics of the application
+  */
+  FrameStats frameStats_;
 
   /**
   * @brief Number of frames since the start of the application
@@ -186,7 +308,44 @@ private:
   */
   unsigned long long frameCount_;
 
+  /**
+  * @brief The time of the last move of the camera, which moves by its speed times the time elapsed since
+  */
+  FrameStats::Clock::time_point lastCameraMove_;
+
   std::string textureName_;
+
+  /**
+  * @brief The star catalog, CSV or binary, the objects are loaded from, empty to generate them at random
+  */
+  std::string catalogFile_;
+
+  /**
+  * @brief The thread advancing the gravity simulation moving the objects, null if the objects do not move
+  */
+  std::unique_ptr<SimulationThread> simulationThread_;
+
+  /**
+  * @brief The handle of the object of the body 0, the body i being the object firstBody_ + i
+  */
+  ObjectHandle firstBody_;
+
+  /**
+  * @brief The cell each body is stored in, in the octree
+  * @details A body only moves to a new cell if it is free, so it may lag behind its position while it crosses other
+  * objects
+  */
+  std::vector<glm::ivec3> bodyCells_;
+
+  /**
+  * @brief A body changing cell: its object, its old cell and its new cell, as SceneOctree::relocate() takes them
+  */
+  typedef std::tuple<ObjectHandle, glm::ivec3, glm::ivec3> Move;
+
+  /**
+  * @brief The bodies changing cell in the current frame, kept to reuse the memory
+  */
+  std::vector<Move> moves_;
 };
 
 
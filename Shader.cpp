@@ -1,8 +1,14 @@
 #include "Shader.h"
-#include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
+#include "GLState.h"
+#include <algorithm>
 #include <exception>
 #include <string>
 
+std::vector<std::shared_ptr<Shader>> ShaderFactory::shaders_;
+unsigned long ShaderFactory::compilationsAvoidedCount_ = 0;
+const GLuint Shader::cameraBinding;
+
 Shader::Shader() :
   vertexID_ {0},
   fragmentID_ {0},
@@ -35,7 +41,7 @@ Shader::Shader() :
     {
       glDeleteShader(vertexID_);
       glDeleteShader(fragmentID_);
-      glDeleteProgram(programID_);
+      GLState::deleteProgram(programID_);
     }
 
     Shader& Shader::operator=(Shader const &copy)
@@ -55,7 +61,7 @@ Shader::Shader() :
 
       if (glIsShader(fragmentID_)) glDeleteShader(fragmentID_);
 
-      if (glIsProgram(programID_)) glDeleteProgram(programID_);
+      if (glIsProgram(programID_)) GLState::deleteProgram(programID_);
 
       if (!compile(vertexID_, GL_VERTEX_SHADER, vertexSource_))
         throw std::runtime_error("Shader vertex compilation error: " + vertexSource_);
@@ -73,6 +79,7 @@ Shader::Shader() :
       glBindAttribLocation(programID_, 0, "in_Vertex");
       glBindAttribLocation(programID_, 1, "in_Color");
       glBindAttribLocation(programID_, 2, "in_TexCoord0");
+      glBindAttribLocation(programID_, 3, "in_Instance");
 
       // Link
       glLinkProgram(programID_);
@@ -95,6 +102,37 @@ Shader::Shader() :
         throw std::runtime_error("Shader link error: " + std::string(error));
       }
 
+      //The view and projection are shared by all the programs through the camera uniform buffer
+      GLuint cameraBlock = glGetUniformBlockIndex(programID_, "Camera");
+      if (cameraBlock != GL_INVALID_INDEX)
+      {
+        glUniformBlockBinding(programID_, cameraBlock, cameraBinding);
+      }
+
+      //Locations of the other uniforms, queried once
+      uniformLocations_.clear();
+
+      GLint uniformsCount = 0;
+      glGetProgramiv(programID_, GL_ACTIVE_UNIFORMS, &uniformsCount);
+
+      GLint nameLength = 0;
+      glGetProgramiv(programID_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &nameLength);
+      std::vector<GLchar> name(nameLength + 1);
+
+      for (GLint i=0; i < uniformsCount; i++)
+      {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(programID_, i, name.size(), &length, &size, &type, name.data());
+
+        GLint location = glGetUniformLocation(programID_, name.data());
+        if (location != -1)
+        {
+          uniformLocations_[std::string(name.data(), length)] = location;
+        }
+      }
+
       return true;
     }
 
@@ -140,6 +178,18 @@ Shader::Shader() :
       return true;
     }
 
+    GLint Shader::uniformLocation(std::string const & name) const
+    {
+      auto location = uniformLocations_.find(name);
+
+      return location == uniformLocations_.end() ? -1 : location->second;
+    }
+
+    void Shader::use() const
+    {
+      GLState::useProgram(programID_);
+    }
+
     GLuint Shader::programID() const
     {
       return programID_;
@@ -167,3 +217,54 @@ Shader::Shader() :
     {
       fragmentSource_ = fragmentSource;
     }
+
+    std::shared_ptr<Shader> & ShaderFactory::createShader(std::string const & vertexSource, std::string const & fragmentSource)
+    {
+      LOG_DEBUG("Looking for shader " << vertexSource << ", " << fragmentSource);
+
+      auto find_it = find_if(ShaderFactory::shaders_.begin(), ShaderFactory::shaders_.end(), [&vertexSource, &fragmentSource] (std::shared_ptr<Shader> const & s) -> bool {
+        return s->vertexSource() == vertexSource && s->fragmentSource() == fragmentSource;
+      });
+
+      // Found
+      if (find_it != ShaderFactory::shaders_.end())
+      {
+        compilationsAvoidedCount_++;
+        return *find_it;
+      }
+
+      //Shader not found
+      std::shared_ptr<Shader> shader(new Shader(vertexSource, fragmentSource));
+      shader->load();
+      ShaderFactory::shaders_.push_back(shader);
+      LOG_DEBUG("Created shader: " << vertexSource << ", " << fragmentSource);
+
+      return ShaderFactory::shaders_.back();
+    }
+
+    std::string ShaderFactory::toString()
+    {
+      std::string res = "Shader factory = ";
+
+      for (const auto & s : shaders_)
+      {
+        res += s->vertexSource() + " + " + s->fragmentSource() + ": " + std::to_string(s.use_count()) + "\n";
+      }
+
+      return res;
+    }
+
+    unsigned long ShaderFactory::compilationsCount()
+    {
+      return shaders_.size();
+    }
+
+    unsigned long ShaderFactory::compilationsAvoidedCount()
+    {
+      return compilationsAvoidedCount_;
+    }
+
+    void ShaderFactory::destroyShaders()
+    {
+      shaders_.clear();
+    }
@@ -32,6 +32,9 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <vector>
+#include <memory>
+#include <map>
 
 /**
 * @brief The Shader class
@@ -40,6 +43,10 @@
 class Shader
 {
 public:
+  /**
+  * @brief The uniform buffer binding point of the Camera block, see CameraUniforms
+  */
+  static const GLuint cameraBinding = 0;
 
   Shader();
   Shader(Shader const &copy);
@@ -64,6 +71,20 @@ public:
   */
   bool compile(GLuint &shader, GLenum type, std::string const &fileSource);
 
+  /**
+  * @brief Gives the location of a uniform of the program
+  * @details The locations are queried once, when the program is linked, so this is no driver call. Still a string
+  * lookup: the objects keep the locations they need when they are created rather than calling it every draw.
+  * @param name The name of the uniform
+  * @return The location, -1 if the program has no such active uniform
+  */
+  GLint uniformLocation(std::string const & name) const;
+
+  /**
+  * @brief Makes the program current, through the GLState cache
+  */
+  void use() const;
+
   GLuint programID() const;
   void setProgramID(const GLuint &programID);
 
@@ -98,6 +119,59 @@ private:
   * @brief The fragment shader source file
   */
   std::string fragmentSource_;
+
+  /**
+  * @brief The locations of the active uniforms outside of the blocks, by name
+  */
+  std::map<std::string, GLint> uniformLocations_;
+};
+
+/**
+* @brief The ShaderFactory class
+* @details Implements a shared shader program pool used by all graphical objects
+* Part of the Flyweight pattern, like the TextureFactory
+*/
+class ShaderFactory
+{
+public:
+  /**
+  * @brief Gives a pointer to the shader program queried by a graphical object
+  * @details Under the hood, it checks wether a program with the same vertex and fragment source files has already been
+  * queried. If it is the case, it simply gives a pointer to the existing program. Else it creates a new program, compiles
+  * and links it, and adds it to the pool.
+  * @param vertexSource The vertex shader source file
+  * @param fragmentSource The fragment shader source file
+  * @return A pointer to the queried shader program
+  */
+  static std::shared_ptr<Shader> & createShader(std::string const & vertexSource, std::string const & fragmentSource);
+
+  static std::string toString();
+
+  /**
+  * @brief Gives the number of shader programs compiled and linked so far
+  */
+  static unsigned long compilationsCount();
+
+  /**
+  * @brief Gives the number of shader programs which were found in the pool instead of being compiled again
+  */
+  static unsigned long compilationsAvoidedCount();
+
+  /**
+  * @brief Clears the shader pool
+  */
+  static void destroyShaders();
+
+private:
+  /**
+  * @brief The pool of shader programs shared by all graphical objects
+  */
+  static std::vector<std::shared_ptr<Shader>> shaders_;
+
+  /**
+  * @brief Number of queries answered with an existing program
+  */
+  static unsigned long compilationsAvoidedCount_;
 };
 
 #endif
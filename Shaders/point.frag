@@ -0,0 +1,28 @@
+// Version du GLSL
+
+#version 150 core
+
+in vec3 color;
+flat in int sprite;
+
+out vec4 out_Color;
+
+void main()
+{
+    if (sprite == 1)
+    {
+        // Distance to the center of the sprite, 1 on its edge
+        float radius = 2.0 * length(gl_PointCoord - vec2(0.5));
+
+        if (radius > 1.0)
+        {
+            discard;
+        }
+
+        out_Color = vec4(color * (1.0 - radius * radius), 1.0);
+    }
+    else
+    {
+        out_Color = vec4(color, 1.0);
+    }
+}
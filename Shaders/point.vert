@@ -0,0 +1,29 @@
+// Version du GLSL
+
+#version 150 core
+
+// Position of the center (xyz) and diameter in pixels (w)
+in vec4 in_Instance;
+in vec3 in_Color;
+
+// View and projection of the current eye, written once per frame, see CameraUniforms
+layout(std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
+
+out vec3 color;
+flat out int sprite;
+
+void main()
+{
+    gl_Position = projection * view * vec4(in_Instance.xyz, 1.0);
+
+    gl_PointSize = max(in_Instance.w, 1.0);
+
+    color = in_Color;
+
+    // Plain point below 2 pixels, round sprite above
+    sprite = in_Instance.w < 2.0 ? 0 : 1;
+}
@@ -5,14 +5,21 @@
 in vec3 in_Vertex;
 in vec2 in_TexCoord0;
 
-uniform mat4 projection;
-uniform mat4 modelview;
+// View and projection of the current eye, written once per frame, see CameraUniforms
+layout(std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
+
+// Per object
+uniform mat4 model;
 
 out vec2 coordTexture;
 
 void main()
 {
-    gl_Position = projection * modelview * vec4(in_Vertex, 1.0);
+    gl_Position = projection * view * model * vec4(in_Vertex, 1.0);
 
     coordTexture = in_TexCoord0;
 }
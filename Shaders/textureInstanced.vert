@@ -0,0 +1,27 @@
+// Version du GLSL
+
+#version 150 core
+
+in vec3 in_Vertex;
+in vec2 in_TexCoord0;
+
+// Per instance: position of the center (xyz) and size of the edge (w)
+in vec4 in_Instance;
+
+// View and projection of the current eye, written once per frame, see CameraUniforms
+layout(std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
+
+out vec2 coordTexture;
+
+void main()
+{
+    vec3 position = in_Vertex * (in_Instance.w / 2.0) + in_Instance.xyz;
+
+    gl_Position = projection * view * vec4(position, 1.0);
+
+    coordTexture = in_TexCoord0;
+}
@@ -1,15 +1,29 @@
 SOURCES += \
+    BarnesHut.cpp \
     Camera.cpp \
+    CameraUniforms.cpp \
     Crate.cpp \
     Cube.cpp \
+    DirectSummation.cpp \
+    FrameStats.cpp \
+    GLState.cpp \
     GraphicObject.cpp \
+    HeadlessContext.cpp \
     Input.cpp \
+    InstancedRenderer.cpp \
     main.cpp \
+    NBody.cpp \
+    ObjectStore.cpp \
     Oculus.cpp \
     Plane.cpp \
+    PointRenderer.cpp \
+    Profiler.cpp \
     Scene.cpp \
+    SimulationThread.cpp \
     Shader.cpp \
+    StarCatalog.cpp \
     Texture.cpp \
+    ThreadPool.cpp \
     Utils.cpp \
     build/CMakeFiles/3.2.2/CompilerIdCXX/CMakeCXXCompilerId.cpp \
     build/CMakeFiles/feature_tests.cxx \
@@ -230,7 +244,13 @@ HEADERS += \
     Include/Octree/array.h \
     Include/Octree/array2d.h \
     Include/Octree/numtraits.h \
+    Include/Octree/linearoctree.h \
+    Include/Octree/mappedoctree.h \
+    Include/Octree/morton.h \
     Include/Octree/octree.h \
+    Include/Octree/octreefrustum.h \
+    Include/Octree/octreepool.h \
+    Include/Octree/octreesummary.h \
     Include/Octree/point3d.h \
     Include/Octree/shareddata.h \
     Include/Octree/tinyvector.h \
@@ -310,16 +330,31 @@ HEADERS += \
     Include/OVR/LibOVR/Src/OVR_Win32_HIDDevice.h \
     Include/OVR/LibOVR/Src/OVR_Win32_HMDDevice.h \
     Include/OVR/LibOVR/Src/OVR_Win32_SensorDevice.h \
+    BarnesHut.h \
     Camera.h \
+    CameraUniforms.h \
     Crate.h \
     Cube.h \
+    DirectSummation.h \
+    FrameStats.h \
+    GLState.h \
     GraphicObject.h \
+    HeadlessContext.h \
     Input.h \
+    InstancedRenderer.h \
+    Log.h \
+    NBody.h \
+    ObjectStore.h \
     Oculus.h \
     Plane.h \
+    PointRenderer.h \
+    Profiler.h \
     Scene.h \
+    SimulationThread.h \
     Shader.h \
+    StarCatalog.h \
     Texture.h \
+    ThreadPool.h \
     Utils.h \
     Include/OVR/OVR/LibOVR/Include/OVR.h \
     Include/OVR/OVR/LibOVR/Include/OVRVersion.h \
@@ -456,8 +491,11 @@ DISTFILES += \
     Shaders/basique2D.frag \
     Shaders/couleur2D.frag \
     Shaders/couleur3D.frag \
+    Shaders/point.frag \
     Shaders/texture.frag \
     Shaders/basique2D.vert \
     Shaders/couleur2D.vert \
     Shaders/couleur3D.vert \
-    Shaders/texture.vert
+    Shaders/point.vert \
+    Shaders/texture.vert \
+    Shaders/textureInstanced.vert
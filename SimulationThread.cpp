@@ -0,0 +1,154 @@
+#include "SimulationThread.h"
+#include "NBody.h"
+#include "Profiler.h"
+#include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cassert>
+
+const unsigned int SimulationThread::maxCatchUpSteps;
+
+SimulationThread::SimulationThread(std::unique_ptr<NBodySimulation> simulation):
+  simulation_ {std::move(simulation)},
+  timestep_ {},
+  states_ {},
+  back_ {0},
+  middle_ {1},
+  front_ {2},
+  fresh_ {false},
+  stop_ {false},
+  skippedStepsCount_ {0}
+  {
+    assert(simulation_);
+    timestep_ = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(simulation_->timestep()));
+    assert(timestep_.count() > 0);
+
+    //The initial state does not move
+    Bodies const & bodies = simulation_->bodies();
+    State & state = states_[front_];
+    state.previousX = state.x = bodies.x;
+    state.previousY = state.y = bodies.y;
+    state.previousZ = state.z = bodies.z;
+    state.step = simulation_->stepsCount();
+    state.due = Clock::now();
+  }
+
+  SimulationThread::~SimulationThread()
+  {
+    stop();
+  }
+
+  void SimulationThread::start()
+  {
+    assert(!thread_.joinable());
+
+    Clock::time_point origin = Clock::now();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = false;
+      states_[front_].due = origin;
+    }
+
+    thread_ = std::thread(&SimulationThread::run, this, origin);
+  }
+
+  void SimulationThread::stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wakeUp_.notify_all();
+
+    if (thread_.joinable())
+    {
+      thread_.join();
+    }
+  }
+
+  SimulationThread::State const & SimulationThread::latest()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fresh_)
+    {
+      std::swap(front_, middle_);
+      fresh_ = false;
+    }
+
+    return states_[front_];
+  }
+
+  float SimulationThread::alpha(State const & state) const
+  {
+    //The render time lags 1 timestep behind: the previous positions are due 1 timestep before the current ones
+    float elapsed = std::chrono::duration<float>(Clock::now() - (state.due - timestep_)).count();
+    float alpha = elapsed / std::chrono::duration<float>(timestep_).count();
+
+    return std::min(std::max(alpha, 0.0f), 1.0f);
+  }
+
+  unsigned long long SimulationThread::skippedStepsCount() const
+  {
+    return skippedStepsCount_;
+  }
+
+  void SimulationThread::run(Clock::time_point origin)
+  {
+    //The state due at next is computed 1 timestep ahead, while the render thread interpolates towards the previous one
+    Clock::time_point next = origin + timestep_;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wakeUp_.wait_until(lock, next - timestep_, [this] () { return stop_; }))
+    {
+      lock.unlock();
+
+      unsigned int steps = 0;
+      while (next - timestep_ <= Clock::now() && steps < maxCatchUpSteps)
+      {
+        stepAndPublish(next);
+        next += timestep_;
+        steps++;
+      }
+
+      //Too slow for real time: the missed steps are skipped
+      Clock::time_point now = Clock::now();
+      if (next - timestep_ <= now)
+      {
+        auto skipped = (now - (next - timestep_)) / timestep_ + 1;
+        next += skipped * timestep_;
+        skippedStepsCount_ += skipped;
+        LOG_DEBUG("Simulation thread: " << skipped << " steps skipped to keep up with real time");
+      }
+
+      lock.lock();
+    }
+  }
+
+  void SimulationThread::stepAndPublish(Clock::time_point due)
+  {
+    //Only this thread writes the back buffer
+    State & state = states_[back_];
+    Bodies const & bodies = simulation_->bodies();
+
+    state.previousX = bodies.x;
+    state.previousY = bodies.y;
+    state.previousZ = bodies.z;
+
+    {
+      PROFILE_SCOPE("NBodySimulation::step");
+      simulation_->step();
+    }
+
+    state.x = bodies.x;
+    state.y = bodies.y;
+    state.z = bodies.z;
+    state.step = simulation_->stepsCount();
+    state.due = due;
+
+    LOG_DEBUG("Gravity step " << state.step << ": " << simulation_->solver().interactionsCount() << " interactions");
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(back_, middle_);
+    fresh_ = true;
+  }
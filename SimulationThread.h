@@ -0,0 +1,146 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+/** @file
+* @brief Fixed timestep simulation thread
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class NBodySimulation;
+
+/**
+* @brief The SimulationThread class
+* @details Advances an NBodySimulation on its own thread, 1 timestep of simulation time per timestep of real time,
+* whatever the frame rate, so that a slow frame neither slows down nor distorts the motion.
+* After each step the positions are published in a triple buffer: the simulation thread fills the back buffer, the
+* render thread reads the front one, and the middle one is swapped with either of them under a mutex, so that neither
+* thread waits for the other. A state holds the positions before and after its step, and the render thread
+* interpolates between them, 1 timestep behind the simulation.
+* When the steps take longer than the timestep, the simulation falls behind real time: it then skips the missed time,
+* after at most maxCatchUpSteps steps in a row, instead of trying to catch up forever.
+*/
+class SimulationThread
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+  * @brief The positions of the bodies after a step, and before it
+  */
+  struct State
+  {
+    std::vector<float> previousX, previousY, previousZ;
+    std::vector<float> x, y, z;
+
+    /**
+    * @brief The number of steps since the start
+    */
+    unsigned long long step;
+
+    /**
+    * @brief The real time at which the positions are reached on screen, the previous ones being reached 1 timestep
+    * before
+    */
+    Clock::time_point due;
+  };
+
+  /**
+  * @brief The maximum number of steps in a row to catch up with real time
+  */
+  static const unsigned int maxCatchUpSteps = 4;
+
+  /**
+  * @brief Takes the simulation over and publishes its initial state
+  * @details The simulation must not be accessed from the outside any more
+  */
+  explicit SimulationThread(std::unique_ptr<NBodySimulation> simulation);
+
+  /**
+  * @brief Stops the thread
+  */
+  ~SimulationThread();
+
+  SimulationThread(SimulationThread const &) = delete;
+  SimulationThread & operator=(SimulationThread const &) = delete;
+
+  /**
+  * @brief Starts stepping, the latest state being due now
+  * @details Called from the render thread
+  */
+  void start();
+
+  /**
+  * @brief Stops stepping and waits for the current step to finish
+  */
+  void stop();
+
+  /**
+  * @brief Gives the latest state published, for the render thread
+  * @details The state stays unchanged until the next call
+  */
+  State const & latest();
+
+  /**
+  * @brief Gives the interpolation factor between the previous and the current positions of a state now: 0 at the
+  * previous ones, 1 at the current ones, and 1 as long as the next state is late
+  */
+  float alpha(State const & state) const;
+
+  /**
+  * @brief Gives the number of steps skipped since the start to keep up with real time
+  */
+  unsigned long long skippedStepsCount() const;
+
+private:
+  /**
+  * @brief The loop of the simulation thread
+  * @param origin The time the front state is due
+  */
+  void run(Clock::time_point origin);
+
+  /**
+  * @brief Fills the back buffer with the positions before the step, steps, fills it with the new positions and
+  * publishes it
+  */
+  void stepAndPublish(Clock::time_point due);
+
+  std::unique_ptr<NBodySimulation> simulation_;
+
+  Clock::duration timestep_;
+
+  /**
+  * @brief The 3 buffers and the roles they currently have
+  */
+  State states_[3];
+  int back_;
+  int middle_;
+  int front_;
+
+  /**
+  * @brief Whether the middle buffer is newer than the front one
+  */
+  bool fresh_;
+
+  /**
+  * @brief Guards the swaps of the buffers, the stop flag and the sleep of the thread
+  */
+  std::mutex mutex_;
+  std::condition_variable wakeUp_;
+  bool stop_;
+
+  std::atomic<unsigned long long> skippedStepsCount_;
+
+  std::thread thread_;
+};
+
+#endif // SIMULATIONTHREAD_H
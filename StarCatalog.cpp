@@ -0,0 +1,958 @@
+#include "StarCatalog.h"
+#include "ThreadPool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Include/Octree/morton.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+  //Bytes per task of the thread pool
+  const unsigned long chunkBytes = 1 << 22;
+
+  //Bytes scanned for separators at a time
+  const unsigned long blockBytes = 64;
+
+  const char binaryMagic[8] = {'S', 'T', 'A', 'R', 'C', 'A', 'T', '\0'};
+  const std::uint32_t binaryVersion = 1;
+
+  //Alignment of the parts of a binary catalog
+  const unsigned long binaryAlignment = 64;
+
+  /**
+  * @brief The header of a binary catalog, at the start of the file
+  * @details The offsets are from the start of the file
+  */
+  struct BinaryHeader
+  {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t fileBytes;
+    std::uint64_t starsCount;
+    std::uint64_t rowsCount;
+    std::uint64_t skippedRowsCount;
+    std::uint64_t blocksCount;
+    std::uint32_t blockSize;
+    std::uint32_t gridBits;
+    float min[3];
+    float max[3];
+    std::uint64_t blocks;
+    std::uint64_t x;
+    std::uint64_t y;
+    std::uint64_t z;
+    std::uint64_t magnitude;
+  };
+
+  /**
+  * @brief A block of stars of a binary catalog: the Morton codes of its first and last stars, and its bounding box
+  */
+  struct BinaryBlock
+  {
+    std::uint64_t firstCode;
+    std::uint64_t lastCode;
+    float min[3];
+    float max[3];
+  };
+
+  static_assert(sizeof(BinaryHeader) == 128 && sizeof(BinaryBlock) == 40, "The binary catalog layout has no padding");
+
+  unsigned long align(unsigned long offset)
+  {
+    return (offset + binaryAlignment - 1) / binaryAlignment * binaryAlignment;
+  }
+
+  /**
+  * @brief Converts to a 16-bit half float, rounding to nearest even
+  */
+  std::uint16_t toHalf(float value)
+  {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::uint32_t sign = (bits >> 16) & 0x8000;
+    std::int32_t exponent = static_cast<std::int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    std::uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (((bits >> 23) & 0xFF) == 0xFF)
+    {
+      //Infinity or NaN
+      return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+    }
+    if (exponent >= 31)
+    {
+      return sign | 0x7C00;
+    }
+
+    std::uint32_t half;
+    int shift;
+    if (exponent <= 0)
+    {
+      //Subnormal, or 0 below half the smallest one
+      if (exponent < -10)
+      {
+        return sign;
+      }
+      mantissa |= 0x800000;
+      shift = 14 - exponent;
+      half = mantissa >> shift;
+    }
+    else
+    {
+      shift = 13;
+      half = exponent << 10 | mantissa >> shift;
+    }
+
+    //A carry into the exponent gives the next power of 2, or infinity
+    std::uint32_t rest = mantissa & ((1u << shift) - 1);
+    std::uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half & 1)))
+    {
+      half++;
+    }
+
+    return sign | half;
+  }
+
+  float fromHalf(std::uint16_t half)
+  {
+    std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000) << 16;
+    std::uint32_t exponent = (half >> 10) & 0x1F;
+    std::uint32_t mantissa = half & 0x3FF;
+
+    if (exponent == 0)
+    {
+      float value = mantissa / 16777216.0f;
+      return sign ? -value : value;
+    }
+
+    std::uint32_t bits = sign | (exponent == 31 ? 0xFF << 23 : (exponent + 127 - 15) << 23) | mantissa << 13;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+
+    return value;
+  }
+
+  enum Column
+  {
+    RA,
+    Dec,
+    Parallax,
+    Magnitude,
+    ColumnsCount
+  };
+
+  /**
+  * @brief The stars of a chunk of the file
+  */
+  struct Chunk
+  {
+    Stars stars;
+    glm::vec3 min {std::numeric_limits<float>::max()};
+    glm::vec3 max {std::numeric_limits<float>::lowest()};
+    unsigned long rowsCount = 0;
+    unsigned long skippedRowsCount = 0;
+  };
+
+  /**
+  * @brief A file mapped read only, unmapped at the destruction
+  */
+  class MappedFile
+  {
+  public:
+    explicit MappedFile(std::string const & file):
+      data_ {nullptr},
+      bytes_ {0}
+    {
+      int fd = open(file.c_str(), O_RDONLY);
+      if (fd < 0)
+      {
+        throw std::runtime_error("StarCatalog: cannot open " + file);
+      }
+
+      struct stat st;
+      if (fstat(fd, &st) != 0)
+      {
+        close(fd);
+        throw std::runtime_error("StarCatalog: cannot read " + file);
+      }
+
+      bytes_ = st.st_size;
+      if (bytes_ == 0)
+      {
+        close(fd);
+        return;
+      }
+
+      void* p = mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (p == MAP_FAILED)
+      {
+        throw std::runtime_error("StarCatalog: cannot map " + file);
+      }
+
+      //Read once from start to end
+      madvise(p, bytes_, MADV_SEQUENTIAL | MADV_WILLNEED);
+      data_ = static_cast<const char*>(p);
+    }
+
+    ~MappedFile()
+    {
+      if (data_)
+      {
+        munmap(const_cast<char*>(data_), bytes_);
+      }
+    }
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile & operator=(MappedFile const &) = delete;
+
+    const char* data() const
+    {
+      return data_;
+    }
+
+    unsigned long bytes() const
+    {
+      return bytes_;
+    }
+
+  private:
+    const char* data_;
+    unsigned long bytes_;
+  };
+
+  /**
+  * @brief Gives the bits of the commas and of the line feeds among the 64 bytes at p, bit i for the byte p[i]
+  */
+  inline std::uint64_t separators(const char* p)
+  {
+#ifdef __SSE2__
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i lineFeed = _mm_set1_epi8('\n');
+
+    std::uint64_t bits = 0;
+    for (int i=0; i < 4; i++)
+    {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+      __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, lineFeed));
+      bits |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(matches))) << (16 * i);
+    }
+
+    return bits;
+#else
+    std::uint64_t bits = 0;
+    for (unsigned long i=0; i < blockBytes; i++)
+    {
+      bits |= static_cast<std::uint64_t>(p[i] == ',' || p[i] == '\n') << i;
+    }
+
+    return bits;
+#endif
+  }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define STARCATALOG_SWAR
+  /**
+  * @brief Whether the 8 bytes loaded in a register are all digits
+  */
+  inline bool areEightDigits(std::uint64_t bytes)
+  {
+    return ((bytes & 0xF0F0F0F0F0F0F0F0) | (((bytes + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+  }
+
+  /**
+  * @brief Gives the value of 8 digits loaded in a register, the first one being the most significant
+  * @details The digits are combined by pairs, then by 4, then all 8, with 3 multiplications
+  */
+  inline std::uint32_t eightDigits(std::uint64_t bytes)
+  {
+    const std::uint64_t mask = 0x000000FF000000FF;
+    const std::uint64_t mul1 = 0x000F424000000064; //100 + (1000000 << 32)
+    const std::uint64_t mul2 = 0x0000271000000001; //1 + (10000 << 32)
+
+    bytes -= 0x3030303030303030;
+    bytes = bytes * 10 + (bytes >> 8);
+    bytes = (((bytes & mask) * mul1) + (((bytes >> 16) & mask) * mul2)) >> 32;
+
+    return static_cast<std::uint32_t>(bytes);
+  }
+#endif
+
+  /**
+  * @brief Accumulates the digits at p in the mantissa, at most 19 significant ones, the next ones being dropped
+  * @param p The first character, moved past the digits
+  * @param droppedDigits Incremented for each digit dropped
+  * @return The number of digits read, the dropped ones included
+  */
+  inline int readDigits(const char* & p, const char* last, std::uint64_t & mantissa, int & significantDigits, int & droppedDigits)
+  {
+    const char* first = p;
+
+#ifdef STARCATALOG_SWAR
+    while (last - p >= 8 && significantDigits + 8 <= 19)
+    {
+      std::uint64_t bytes;
+      std::memcpy(&bytes, p, 8);
+      if (!areEightDigits(bytes))
+      {
+        break;
+      }
+
+      mantissa = mantissa * 100000000 + eightDigits(bytes);
+      //The leading zeros are not significant
+      if (mantissa)
+      {
+        significantDigits += 8;
+      }
+      p += 8;
+    }
+#endif
+
+    while (p != last && static_cast<unsigned char>(*p - '0') < 10)
+    {
+      if (significantDigits < 19)
+      {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa)
+        {
+          significantDigits++;
+        }
+      }
+      else
+      {
+        droppedDigits++;
+      }
+      p++;
+    }
+
+    return p - first;
+  }
+
+  /**
+  * @brief Parses a decimal number, e.g. -12.5e-3
+  * @details The missing values are flagged rather than set to NaN, which -Ofast assumes never happens
+  * @param value The number
+  * @return false if the field is empty or is not a number
+  */
+  bool parseFloat(const char* p, const char* last, float & value)
+  {
+    //The powers of 10 exactly represented in a double
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    while (p != last && (*p == ' ' || *p == '"'))
+    {
+      p++;
+    }
+    while (p != last && (last[-1] == ' ' || last[-1] == '\r' || last[-1] == '"'))
+    {
+      last--;
+    }
+
+    bool negative = false;
+    if (p != last && (*p == '-' || *p == '+'))
+    {
+      negative = *p == '-';
+      p++;
+    }
+
+    std::uint64_t mantissa = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+
+    //The integer digits dropped multiply the mantissa by 10, the fraction digits kept divide it by 10
+    int droppedDigits = 0;
+    int digits = readDigits(p, last, mantissa, significantDigits, droppedDigits);
+    exponent += droppedDigits;
+    if (p != last && *p == '.')
+    {
+      p++;
+      droppedDigits = 0;
+      int fractionDigits = readDigits(p, last, mantissa, significantDigits, droppedDigits);
+      digits += fractionDigits;
+      exponent -= fractionDigits - droppedDigits;
+    }
+    if (digits == 0)
+    {
+      return false;
+    }
+
+    if (p != last && (*p == 'e' || *p == 'E'))
+    {
+      p++;
+      bool negativeExponent = false;
+      if (p != last && (*p == '-' || *p == '+'))
+      {
+        negativeExponent = *p == '-';
+        p++;
+      }
+
+      int value = 0;
+      const char* first = p;
+      while (p != last && static_cast<unsigned char>(*p - '0') < 10)
+      {
+        value = std::min(value * 10 + (*p - '0'), 10000);
+        p++;
+      }
+      if (p == first)
+      {
+        return false;
+      }
+      exponent += negativeExponent ? -value : value;
+    }
+
+    if (p != last)
+    {
+      return false;
+    }
+
+    double number = static_cast<double>(mantissa);
+    if (exponent >= 0)
+    {
+      number *= exponent <= 22 ? powers[exponent] : std::pow(10.0, exponent);
+    }
+    else
+    {
+      number /= -exponent <= 22 ? powers[-exponent] : std::pow(10.0, -exponent);
+    }
+
+    value = static_cast<float>(negative ? -number : number);
+    return true;
+  }
+
+  /**
+  * @brief Converts a row to a star of the chunk, or skips it
+  * @param valid Whether each value was given
+  */
+  void addRow(float const values[ColumnsCount], bool const valid[ColumnsCount], Chunk & chunk)
+  {
+    const float degree = 3.14159265358979f / 180;
+
+    chunk.rowsCount++;
+
+    float parallax = values[Parallax];
+    if (!valid[RA] || !valid[Dec] || !valid[Parallax] || !(parallax > 0))
+    {
+      chunk.skippedRowsCount++;
+      return;
+    }
+
+    //The parallax is in milliarcseconds
+    float distance = 1000 / parallax;
+    float ra = values[RA] * degree;
+    float dec = values[Dec] * degree;
+
+    //The north celestial pole is up
+    glm::vec3 position(distance * std::cos(dec) * std::sin(ra), distance * std::sin(dec), distance * std::cos(dec) * std::cos(ra));
+
+    chunk.stars.x.push_back(position.x);
+    chunk.stars.y.push_back(position.y);
+    chunk.stars.z.push_back(position.z);
+    chunk.stars.magnitude.push_back(valid[Magnitude] ? values[Magnitude] : Stars::missingMagnitude);
+    chunk.min = glm::min(chunk.min, position);
+    chunk.max = glm::max(chunk.max, position);
+  }
+
+  /**
+  * @brief Parses the lines of [begin, end)
+  * @param fieldColumns The column of each field of a line, -1 for the fields not read
+  */
+  void parseChunk(const char* data, unsigned long begin, unsigned long end, std::vector<int> const & fieldColumns, Chunk & chunk)
+  {
+    float values[ColumnsCount] = {0, 0, 0, 0};
+    bool valid[ColumnsCount] = {false, false, false, false};
+    unsigned long field = 0;
+    unsigned long fieldBegin = begin;
+    unsigned long lineBegin = begin;
+
+    for (unsigned long block=begin; block < end; block += blockBytes)
+    {
+      std::uint64_t bits;
+      if (end - block >= blockBytes)
+      {
+        bits = separators(data + block);
+      }
+      else
+      {
+        //The end of the chunk can be the end of the mapping: the last bytes are copied, followed by zeros
+        char last[blockBytes] = {};
+        std::memcpy(last, data + block, end - block);
+        bits = separators(last);
+      }
+
+      while (bits)
+      {
+        unsigned long separator = block + __builtin_ctzll(bits);
+        bits &= bits - 1;
+
+        if (field < fieldColumns.size() && fieldColumns[field] >= 0)
+        {
+          valid[fieldColumns[field]] = parseFloat(data + fieldBegin, data + separator, values[fieldColumns[field]]);
+        }
+        field++;
+        fieldBegin = separator + 1;
+
+        if (data[separator] == '\n')
+        {
+          //The empty lines are not rows
+          if (separator > lineBegin && !(separator == lineBegin + 1 && data[lineBegin] == '\r'))
+          {
+            addRow(values, valid, chunk);
+          }
+          std::fill(valid, valid + ColumnsCount, false);
+          field = 0;
+          lineBegin = fieldBegin;
+        }
+      }
+    }
+
+    //The last line of the file may not end with a line feed
+    if (lineBegin < end)
+    {
+      if (field < fieldColumns.size() && fieldColumns[field] >= 0)
+      {
+        valid[fieldColumns[field]] = parseFloat(data + fieldBegin, data + end, values[fieldColumns[field]]);
+      }
+      addRow(values, valid, chunk);
+    }
+  }
+
+  /**
+  * @brief Gives the column of each field of the header line
+  */
+  std::vector<int> parseHeader(const char* first, const char* last)
+  {
+    std::vector<int> fieldColumns;
+    bool found[ColumnsCount] = {false, false, false, false};
+
+    while (true)
+    {
+      const char* separator = std::find(first, last, ',');
+
+      std::string name;
+      for (const char* p=first; p != separator; p++)
+      {
+        if (*p != ' ' && *p != '"' && *p != '\r')
+        {
+          name += std::tolower(static_cast<unsigned char>(*p));
+        }
+      }
+
+      int column = -1;
+      if (name == "ra" || name == "raj2000")
+      {
+        column = RA;
+      }
+      else if (name == "dec" || name == "dej2000")
+      {
+        column = Dec;
+      }
+      else if (name == "parallax" || name == "plx")
+      {
+        column = Parallax;
+      }
+      else if (name == "phot_g_mean_mag" || name == "mag" || name == "gmag" || name == "vmag")
+      {
+        column = Magnitude;
+      }
+
+      //The first column of a kind is read
+      if (column >= 0 && found[column])
+      {
+        column = -1;
+      }
+      if (column >= 0)
+      {
+        found[column] = true;
+      }
+      fieldColumns.push_back(column);
+
+      if (separator == last)
+      {
+        break;
+      }
+      first = separator + 1;
+    }
+
+    if (!found[RA] || !found[Dec] || !found[Parallax])
+    {
+      throw std::runtime_error("StarCatalog: the header lacks the ra, dec or parallax column");
+    }
+
+    return fieldColumns;
+  }
+
+  /**
+  * @brief Gives the beginning of the first line starting at or after offset
+  */
+  unsigned long lineStart(const char* data, unsigned long bytes, unsigned long offset)
+  {
+    if (offset == 0 || offset >= bytes)
+    {
+      return std::min(offset, bytes);
+    }
+
+    const void* lineFeed = std::memchr(data + offset - 1, '\n', bytes - offset + 1);
+    return lineFeed ? static_cast<const char*>(lineFeed) - data + 1 : bytes;
+  }
+}
+
+constexpr float Stars::missingMagnitude;
+
+unsigned long Stars::size() const
+{
+  return x.size();
+}
+
+void Stars::resize(unsigned long starsCount)
+{
+  for (std::vector<float>* array : {&x, &y, &z, &magnitude})
+  {
+    array->resize(starsCount);
+  }
+}
+
+StarCatalog::StarCatalog(std::string const & file, ThreadPool & threadPool):
+  stars_ {},
+  min_ {0},
+  max_ {0},
+  fileBytes_ {0},
+  rowsCount_ {0},
+  skippedRowsCount_ {0}
+  {
+    MappedFile mapping(file);
+    fileBytes_ = mapping.bytes();
+
+    if (mapping.bytes() >= sizeof(binaryMagic) && std::memcmp(mapping.data(), binaryMagic, sizeof(binaryMagic)) == 0)
+    {
+      readBinary(mapping.data(), mapping.bytes(), threadPool);
+    }
+    else
+    {
+      readCsv(mapping.data(), mapping.bytes(), threadPool);
+    }
+  }
+
+  const int StarCatalog::gridBits;
+  const unsigned long StarCatalog::blockSize;
+
+  void StarCatalog::writeBinary(std::string const & file) const
+  {
+    const unsigned long starsCount = stars_.size();
+    const unsigned long blocksCount = (starsCount + blockSize - 1) / blockSize;
+
+    //The order of the stars
+    std::vector<std::tuple<int, int, int>> cells(starsCount);
+    for (unsigned long i=0; i < starsCount; i++)
+    {
+      glm::ivec3 c = cell(glm::vec3(stars_.x[i], stars_.y[i], stars_.z[i]), gridBits);
+      cells[i] = std::make_tuple(c.x, c.y, c.z);
+    }
+    const std::vector<Morton::Entry> entries = Morton::sortPoints(cells.begin(), cells.end());
+    cells = std::vector<std::tuple<int, int, int>>();
+
+    BinaryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+    header.version = binaryVersion;
+    header.byteOrder = 0x01020304;
+    header.starsCount = starsCount;
+    header.rowsCount = rowsCount_;
+    header.skippedRowsCount = skippedRowsCount_;
+    header.blocksCount = blocksCount;
+    header.blockSize = blockSize;
+    header.gridBits = gridBits;
+    for (int i=0; i < 3; i++)
+    {
+      header.min[i] = min_[i];
+      header.max[i] = max_[i];
+    }
+    header.blocks = align(sizeof(header));
+    header.x = align(header.blocks + blocksCount * sizeof(BinaryBlock));
+    header.y = align(header.x + starsCount * sizeof(float));
+    header.z = align(header.y + starsCount * sizeof(float));
+    header.magnitude = align(header.z + starsCount * sizeof(float));
+    header.fileBytes = header.magnitude + starsCount * sizeof(std::uint16_t);
+
+    std::vector<BinaryBlock> blocks(blocksCount);
+    for (unsigned long b=0; b < blocksCount; b++)
+    {
+      const unsigned long begin = b * blockSize;
+      const unsigned long end = std::min(begin + blockSize, starsCount);
+
+      BinaryBlock & block = blocks[b];
+      block.firstCode = entries[begin].code;
+      block.lastCode = entries[end - 1].code;
+
+      glm::vec3 min(std::numeric_limits<float>::max());
+      glm::vec3 max(std::numeric_limits<float>::lowest());
+      for (unsigned long i=begin; i < end; i++)
+      {
+        unsigned long star = entries[i].index;
+        glm::vec3 position(stars_.x[star], stars_.y[star], stars_.z[star]);
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+      }
+      for (int i=0; i < 3; i++)
+      {
+        block.min[i] = min[i];
+        block.max[i] = max[i];
+      }
+    }
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+      throw std::runtime_error("StarCatalog: cannot write " + file);
+    }
+
+    unsigned long offset = 0;
+    auto write = [&out, &offset] (unsigned long at, const void* data, unsigned long bytes) {
+      static const char padding[binaryAlignment] = {};
+      assert(offset <= at && at - offset < binaryAlignment);
+      out.write(padding, at - offset);
+      out.write(static_cast<const char*>(data), bytes);
+      offset = at + bytes;
+    };
+
+    write(0, &header, sizeof(header));
+    write(header.blocks, blocks.data(), blocks.size() * sizeof(BinaryBlock));
+
+    //The columns, gathered in Morton order a block at a time
+    std::vector<float> floats(blockSize);
+    std::vector<std::uint16_t> halves(blockSize);
+    for (std::vector<float> const * column : {&stars_.x, &stars_.y, &stars_.z, &stars_.magnitude})
+    {
+      for (unsigned long begin=0; begin < starsCount; begin += blockSize)
+      {
+        const unsigned long end = std::min(begin + blockSize, starsCount);
+        if (column == &stars_.magnitude)
+        {
+          for (unsigned long i=begin; i < end; i++)
+          {
+            halves[i - begin] = toHalf((*column)[entries[i].index]);
+          }
+          write(begin == 0 ? header.magnitude : offset, halves.data(), (end - begin) * sizeof(std::uint16_t));
+        }
+        else
+        {
+          for (unsigned long i=begin; i < end; i++)
+          {
+            floats[i - begin] = (*column)[entries[i].index];
+          }
+          std::uint64_t columnOffset = column == &stars_.x ? header.x : column == &stars_.y ? header.y : header.z;
+          write(begin == 0 ? columnOffset : offset, floats.data(), (end - begin) * sizeof(float));
+        }
+      }
+    }
+
+    if (!out)
+    {
+      throw std::runtime_error("StarCatalog: cannot write " + file);
+    }
+  }
+
+  glm::ivec3 StarCatalog::cell(glm::vec3 const & position, int bits) const
+  {
+    assert(0 <= bits && bits <= gridBits);
+
+    glm::vec3 size = max_ - min_;
+    float extent = std::max(std::max(size.x, size.y), size.z);
+    float scale = extent > 0 ? (1 << gridBits) / extent : 0;
+
+    //Clamped as floats first: a position outside of the cube, e.g. the Sun, may not fit in an int
+    glm::ivec3 finest(glm::clamp((position - min_) * scale, 0.0f, static_cast<float>((1 << gridBits) - 1)));
+    int shift = gridBits - bits;
+
+    return glm::ivec3(finest.x >> shift, finest.y >> shift, finest.z >> shift);
+  }
+
+  Stars const & StarCatalog::stars() const
+  {
+    return stars_;
+  }
+
+  glm::vec3 const & StarCatalog::min() const
+  {
+    return min_;
+  }
+
+  glm::vec3 const & StarCatalog::max() const
+  {
+    return max_;
+  }
+
+  unsigned long StarCatalog::fileBytes() const
+  {
+    return fileBytes_;
+  }
+
+  unsigned long StarCatalog::rowsCount() const
+  {
+    return rowsCount_;
+  }
+
+  unsigned long StarCatalog::skippedRowsCount() const
+  {
+    return skippedRowsCount_;
+  }
+
+  void StarCatalog::readCsv(const char* data, unsigned long bytes, ThreadPool & threadPool)
+  {
+    if (bytes == 0)
+    {
+      throw std::runtime_error("StarCatalog: empty catalog");
+    }
+
+    const char* headerEnd = static_cast<const char*>(std::memchr(data, '\n', bytes));
+    if (!headerEnd)
+    {
+      headerEnd = data + bytes;
+    }
+    const std::vector<int> fieldColumns = parseHeader(data, headerEnd);
+
+    //The rows, after the header
+    const char* rows = std::min(headerEnd + 1, data + bytes);
+    const unsigned long rowsBytes = data + bytes - rows;
+
+    //A chunk parses the lines starting in its range of bytes
+    std::vector<Chunk> chunks((rowsBytes + chunkBytes - 1) / chunkBytes);
+    threadPool.parallelFor(chunks.size(), 1, [&] (unsigned long begin, unsigned long, unsigned long) {
+      Chunk & chunk = chunks[begin];
+
+      unsigned long first = lineStart(rows, rowsBytes, begin * chunkBytes);
+      unsigned long last = lineStart(rows, rowsBytes, (begin + 1) * chunkBytes);
+
+      //About 1 star per 64 bytes, e.g. 3 angles, a parallax and a magnitude
+      unsigned long capacity = (last - first) / 64 + 1;
+      for (std::vector<float>* array : {&chunk.stars.x, &chunk.stars.y, &chunk.stars.z, &chunk.stars.magnitude})
+      {
+        array->reserve(capacity);
+      }
+
+      parseChunk(rows, first, last, fieldColumns, chunk);
+    });
+
+    //The chunks are concatenated in the order of the file
+    std::vector<unsigned long> offsets(chunks.size() + 1, 0);
+    min_ = glm::vec3(std::numeric_limits<float>::max());
+    max_ = glm::vec3(std::numeric_limits<float>::lowest());
+    for (unsigned long i=0; i < chunks.size(); i++)
+    {
+      offsets[i + 1] = offsets[i] + chunks[i].stars.size();
+      rowsCount_ += chunks[i].rowsCount;
+      skippedRowsCount_ += chunks[i].skippedRowsCount;
+      min_ = glm::min(min_, chunks[i].min);
+      max_ = glm::max(max_, chunks[i].max);
+    }
+
+    if (offsets.back() == 0)
+    {
+      min_ = max_ = glm::vec3(0);
+    }
+
+    stars_.resize(offsets.back());
+    threadPool.parallelFor(chunks.size(), 1, [&] (unsigned long begin, unsigned long, unsigned long) {
+      Stars & stars = chunks[begin].stars;
+      std::copy(stars.x.begin(), stars.x.end(), stars_.x.begin() + offsets[begin]);
+      std::copy(stars.y.begin(), stars.y.end(), stars_.y.begin() + offsets[begin]);
+      std::copy(stars.z.begin(), stars.z.end(), stars_.z.begin() + offsets[begin]);
+      std::copy(stars.magnitude.begin(), stars.magnitude.end(), stars_.magnitude.begin() + offsets[begin]);
+
+      //Freed as soon as copied
+      stars = Stars();
+    });
+  }
+
+  void StarCatalog::readBinary(const char* data, unsigned long bytes, ThreadPool & threadPool)
+  {
+    if (bytes < sizeof(BinaryHeader))
+    {
+      throw std::runtime_error("StarCatalog: truncated header");
+    }
+
+    BinaryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.version != binaryVersion)
+    {
+      throw std::runtime_error("StarCatalog: unsupported version");
+    }
+    if (header.byteOrder != 0x01020304)
+    {
+      throw std::runtime_error("StarCatalog: wrong byte order");
+    }
+    if (header.gridBits != gridBits || header.blockSize != blockSize)
+    {
+      throw std::runtime_error("StarCatalog: written with another grid or block size");
+    }
+
+    //Each count and offset checked on its own, so that no sum of them overflows
+    const unsigned long starsCount = header.starsCount;
+    const unsigned long blocksCount = header.blocksCount;
+    if (header.fileBytes != bytes || starsCount > bytes / sizeof(float)
+    || blocksCount != (starsCount + blockSize - 1) / blockSize || blocksCount > bytes / sizeof(BinaryBlock)
+    || header.blocks > bytes - blocksCount * sizeof(BinaryBlock)
+    || header.x > bytes - starsCount * sizeof(float) || header.y > bytes - starsCount * sizeof(float)
+    || header.z > bytes - starsCount * sizeof(float) || header.magnitude > bytes - starsCount * sizeof(std::uint16_t))
+    {
+      throw std::runtime_error("StarCatalog: truncated file");
+    }
+
+    //The blocks must follow each other in Morton order, for the cells to be in the order in which the octree is built
+    const Morton::Code codesCount = Morton::Code(1) << (3 * gridBits);
+    Morton::Code previousCode = 0;
+    for (unsigned long b=0; b < blocksCount; b++)
+    {
+      BinaryBlock block;
+      std::memcpy(&block, data + header.blocks + b * sizeof(BinaryBlock), sizeof(block));
+      if (block.firstCode < previousCode || block.lastCode < block.firstCode || block.lastCode >= codesCount)
+      {
+        throw std::runtime_error("StarCatalog: not sorted in Morton order");
+      }
+      previousCode = block.lastCode;
+    }
+
+    rowsCount_ = header.rowsCount;
+    skippedRowsCount_ = header.skippedRowsCount;
+    min_ = glm::vec3(header.min[0], header.min[1], header.min[2]);
+    max_ = glm::vec3(header.max[0], header.max[1], header.max[2]);
+
+    //Copied in place, as the file is sorted
+    stars_.resize(starsCount);
+    threadPool.parallelFor(blocksCount, 1, [&] (unsigned long block, unsigned long, unsigned long) {
+      const unsigned long begin = block * blockSize;
+      const unsigned long end = std::min(begin + blockSize, starsCount);
+
+      std::memcpy(&stars_.x[begin], data + header.x + begin * sizeof(float), (end - begin) * sizeof(float));
+      std::memcpy(&stars_.y[begin], data + header.y + begin * sizeof(float), (end - begin) * sizeof(float));
+      std::memcpy(&stars_.z[begin], data + header.z + begin * sizeof(float), (end - begin) * sizeof(float));
+
+      const char* magnitudes = data + header.magnitude + begin * sizeof(std::uint16_t);
+      for (unsigned long i=begin; i < end; i++)
+      {
+        std::uint16_t half;
+        std::memcpy(&half, magnitudes + (i - begin) * sizeof(half), sizeof(half));
+        stars_.magnitude[i] = fromHalf(half);
+      }
+    });
+  }
@@ -0,0 +1,143 @@
+#ifndef STARCATALOG_H
+#define STARCATALOG_H
+
+/** @file
+* @brief Star catalog loading
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include "Include/glm/glm.hpp"
+
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/**
+* @brief The Stars struct
+* @details The stars of a catalog as a structure of arrays. The positions are heliocentric and equatorial, in parsecs,
+* with the north celestial pole up like the y axis of the scene: x points to RA 90 degrees, y to the north celestial
+* pole and z to the vernal equinox (RA 0, Dec 0). The magnitude is the apparent magnitude.
+*/
+struct Stars
+{
+  /**
+  * @brief The magnitude of the stars whose magnitude the catalog does not give
+  */
+  static constexpr float missingMagnitude = 99;
+
+  std::vector<float> x, y, z;
+  std::vector<float> magnitude;
+
+  unsigned long size() const;
+
+  void resize(unsigned long starsCount);
+};
+
+/**
+* @brief The StarCatalog class
+* @details Loads the stars of a CSV catalog, e.g. an export of the Gaia archive, or of a binary catalog written by
+* writeBinary(), the format being recognised from the start of the file.
+*
+* CSV: the first line names the columns, in any order and among others: the right ascension and the declination in degrees
+* (ra and dec, or raj2000 and dej2000), the parallax in milliarcseconds (parallax or plx) and optionally the apparent
+* magnitude (phot_g_mean_mag, mag, gmag or vmag). The fields are not quoted, the empty ones are missing values, and the
+* rows without a positive parallax, i.e. without a distance, are skipped.
+* The file is mapped and split in chunks of a few MiB, each one starting at the first line starting in it, and the
+* chunks are parsed on the thread pool. The separators are found 64 bytes at a time with SSE2 compares, and the digits
+* of the numbers 8 at a time in a 64-bit register. Each chunk converts its rows to positions on the fly, and the chunks
+* are then copied into the columns in the order of the file.
+*
+* Binary: a header with the counts, the bounding box and the offsets of the other parts, then a table of the blocks
+* and 1 column per field, each one aligned on 64 bytes: x, y and z as 32-bit floats and the magnitude as a 16-bit half
+* float (to about 0.01 magnitude), i.e. 14 bytes per star. The stars are sorted by the Morton code of their cell in the
+* finest grid (see cell()) and split in blocks of blockSize stars, each block with the range of its codes and its
+* bounding box. Loading it only validates the header, checks from the ranges of codes of the table that the blocks are in
+* Morton order, and copies the columns, a block per task of the thread pool: the cells are already in the order in which
+* the octree is built. The files written with another gridBits or blockSize are rejected.
+*/
+class StarCatalog
+{
+public:
+  /**
+  * @brief Loads a catalog
+  * @details Throws std::runtime_error if the file cannot be read or lacks a position column
+  * @param file The CSV or binary catalog
+  * @param threadPool The threads the chunks are parsed on
+  */
+  StarCatalog(std::string const & file, ThreadPool & threadPool);
+
+  /**
+  * @brief The number of bits per axis of the finest grid of cells, the grid in which the binary catalogs are sorted
+  */
+  static const int gridBits = 21;
+
+  /**
+  * @brief The number of stars per block of the binary catalogs
+  */
+  static const unsigned long blockSize = 1 << 16;
+
+  /**
+  * @brief Writes the catalog in the binary format, sorted in Morton order
+  * @details Throws std::runtime_error if the file cannot be written
+  */
+  void writeBinary(std::string const & file) const;
+
+  /**
+  * @brief Gives the cell of a position in a grid of 2^bits cells per edge over the bounding cube of the stars
+  * @details The cube has the lower corner min() and the largest edge of the bounding box. The cell of a grid is the
+  * cell of the finest grid shifted right, so that the stars sorted in Morton order in the finest grid are also sorted in
+  * any coarser grid
+  * @param bits At most gridBits
+  */
+  glm::ivec3 cell(glm::vec3 const & position, int bits) const;
+
+  Stars const & stars() const;
+
+  /**
+  * @brief Gives the lower corner of the bounding box of the stars, in parsecs
+  */
+  glm::vec3 const & min() const;
+
+  /**
+  * @brief Gives the upper corner of the bounding box of the stars, in parsecs
+  */
+  glm::vec3 const & max() const;
+
+  /**
+  * @brief Gives the size of the file read in bytes
+  */
+  unsigned long fileBytes() const;
+
+  /**
+  * @brief Gives the number of rows of data read, the skipped ones included
+  */
+  unsigned long rowsCount() const;
+
+  /**
+  * @brief Gives the number of rows skipped for lack of a valid position
+  */
+  unsigned long skippedRowsCount() const;
+
+private:
+  /**
+  * @brief Parses the whole CSV file in memory
+  */
+  void readCsv(const char* data, unsigned long bytes, ThreadPool & threadPool);
+
+  /**
+  * @brief Validates the binary catalog in memory and copies its columns
+  */
+  void readBinary(const char* data, unsigned long bytes, ThreadPool & threadPool);
+
+  Stars stars_;
+  glm::vec3 min_;
+  glm::vec3 max_;
+  unsigned long fileBytes_;
+  unsigned long rowsCount_;
+  unsigned long skippedRowsCount_;
+};
+
+#endif // STARCATALOG_H
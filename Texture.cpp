@@ -1,6 +1,8 @@
 #include "Texture.h"
 #include "Utils.h"
+#include "GLState.h"
 #include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
 
 #include <algorithm>
 #include <exception>
@@ -10,14 +12,15 @@ std::vector<std::shared_ptr<Texture>> TextureFactory::textures_;
 
 Texture::Texture(std::string const & file):
   file_ {file},
-  id_ {0}
+  id_ {0},
+  averageColor_ {1, 1, 1}
   {
     load();
   }
 
   Texture::~Texture()
   {
-    glDeleteTextures(1, &id_);
+    GLState::deleteTexture(id_);
   }
 
   bool Texture::load()
@@ -31,13 +34,13 @@ Texture::Texture(std::string const & file):
 
     //Delete former texture
     if (glIsTexture(id_))
-    glDeleteTextures(1, &id_);
+    GLState::deleteTexture(id_);
 
     //Generate id
     glGenTextures(1, &id_);
 
     //Lock
-    glBindTexture(GL_TEXTURE_2D, id_);
+    GLState::bindTexture(GL_TEXTURE_2D, id_);
 
     //Image format
     GLenum internalFormat(0);
@@ -77,6 +80,28 @@ Texture::Texture(std::string const & file):
       return false;
     }
 
+    //Mean colour, for the objects seen from afar
+    unsigned long long sums[3] = {0, 0, 0};
+    int bytesPerPixel = invertedImage->format->BytesPerPixel;
+    bool bgr = invertedImage->format->Rmask != 0xff;
+    for (int i=0; i < invertedImage->h; i++)
+    {
+      unsigned char* row = static_cast<unsigned char*>(invertedImage->pixels) + i * invertedImage->pitch;
+      for (int j=0; j < invertedImage->w; j++)
+      {
+        for (int k=0; k < 3; k++)
+        {
+          sums[bgr ? 2 - k : k] += row[j * bytesPerPixel + k];
+        }
+      }
+    }
+
+    unsigned long long pixelsCount = static_cast<unsigned long long>(invertedImage->w) * invertedImage->h;
+    if (pixelsCount)
+    {
+      averageColor_ = glm::vec3(sums[0], sums[1], sums[2]) / (255.0f * pixelsCount);
+    }
+
     //PixelCopy
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, invertedImage->w, invertedImage->h, 0, format, GL_UNSIGNED_BYTE, invertedImage->pixels);
 
@@ -85,13 +110,18 @@ Texture::Texture(std::string const & file):
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
     //Unlock
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
 
     SDL_FreeSurface(invertedImage);
 
     return true;
   }
 
+  void Texture::bind() const
+  {
+    GLState::bindTexture(GL_TEXTURE_2D, id_);
+  }
+
   GLuint Texture::id() const
   {
     return id_;
@@ -144,9 +174,14 @@ Texture::Texture(std::string const & file):
     return file_;
   }
 
+  glm::vec3 Texture::averageColor() const
+  {
+    return averageColor_;
+  }
+
   std::shared_ptr<Texture> & TextureFactory::createTexture(std::string const & file)
   {
-    spdlog::get("console")->debug() << "Looking for texture " << file;
+    LOG_DEBUG("Looking for texture " << file);
 
     auto find_it = find_if(TextureFactory::textures_.begin(), TextureFactory::textures_.end(), [&file] (std::shared_ptr<Texture> const & t) -> bool {
       return t->file() == file;
@@ -155,13 +190,13 @@ Texture::Texture(std::string const & file):
     // Found
     if (find_it != TextureFactory::textures_.end())
     {
-      spdlog::get("console")->debug() << "Found texture: " << file;
+      LOG_DEBUG("Found texture: " << file);
       return *find_it;
     }
 
     //Texture not found
     TextureFactory::textures_.push_back(std::shared_ptr<Texture>(new Texture(file)));
-    spdlog::get("console")->debug() << "Created texture: " << file;
+    LOG_DEBUG("Created texture: " << file);
 
 
     return TextureFactory::textures_.back();
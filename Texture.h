@@ -21,6 +21,7 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include "Include/glm/glm.hpp"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -70,9 +71,21 @@ public:
   bool load();
 
   GLuint id() const;
+
+  /**
+  * @brief Binds the texture to GL_TEXTURE_2D, through the GLState cache
+  */
+  void bind() const;
   void setFile(const std::string &file);
   const std::string & file() const;
 
+  /**
+  * @brief Gives the mean colour of the texture image
+  * @details It is computed when the image is read and stands for the textured objects drawn as points from afar
+  * @return The RGB colour, each channel in [0, 1]
+  */
+  glm::vec3 averageColor() const;
+
   /**
   * @brief Inverts the pixels of the texture image to comply to the OpenGL format
   * @param source The image in memory in SDL format
@@ -91,6 +104,11 @@ private:
   */
   GLuint id_;
 
+  /**
+  * @brief The mean colour of the texture image
+  */
+  glm::vec3 averageColor_;
+
 };
 
 /**
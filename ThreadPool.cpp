@@ -0,0 +1,157 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+ThreadPool::ThreadPool(unsigned int threadsCount):
+  queuedCount_ {0},
+  stealsCount_ {0},
+  stop_ {false}
+  {
+    if (threadsCount == 0)
+    {
+      threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    for (unsigned int i=0; i < threadsCount; i++)
+    {
+      queues_.push_back(std::unique_ptr<Queue>(new Queue));
+    }
+
+    //The calling thread is the last one
+    for (unsigned int i=0; i + 1 < threadsCount; i++)
+    {
+      workers_.push_back(std::thread(&ThreadPool::work, this, i));
+    }
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+      stop_ = true;
+    }
+    wakeUp_.notify_all();
+
+    for (auto & worker : workers_)
+    {
+      worker.join();
+    }
+  }
+
+  void ThreadPool::parallelFor(unsigned long count, unsigned long chunkSize, Body const & body)
+  {
+    assert(chunkSize > 0);
+
+    const unsigned long chunksCount = (count + chunkSize - 1) / chunkSize;
+    if (chunksCount == 0)
+    {
+      return;
+    }
+
+    //Nothing to share
+    if (chunksCount == 1 || workers_.empty())
+    {
+      for (unsigned long chunk=0; chunk < chunksCount; chunk++)
+      {
+        body(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk);
+      }
+      return;
+    }
+
+    std::atomic<unsigned long> remaining {chunksCount};
+
+    for (unsigned long chunk=0; chunk < chunksCount; chunk++)
+    {
+      Queue & queue = *queues_[chunk % queues_.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back([&body, &remaining, chunk, chunkSize, count] () {
+        body(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk);
+        remaining--;
+      });
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+      queuedCount_ += chunksCount;
+    }
+    wakeUp_.notify_all();
+
+    //Help until the last chunk is done, it may be running on another thread
+    while (remaining > 0)
+    {
+      if (!runTask(queues_.size() - 1))
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  unsigned int ThreadPool::threadsCount() const
+  {
+    return queues_.size();
+  }
+
+  unsigned long ThreadPool::stealsCount() const
+  {
+    return stealsCount_;
+  }
+
+  void ThreadPool::work(unsigned int index)
+  {
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeUp_.wait(lock, [this] () { return stop_ || queuedCount_ > 0; });
+
+        if (stop_)
+        {
+          return;
+        }
+      }
+
+      while (runTask(index))
+      {
+      }
+    }
+  }
+
+  bool ThreadPool::runTask(unsigned int index)
+  {
+    std::function<void()> task;
+
+    //Own queue first, newest task
+    {
+      Queue & queue = *queues_[index];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty())
+      {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      }
+    }
+
+    //Else the oldest task of another queue
+    for (unsigned int i=1; !task && i < queues_.size(); i++)
+    {
+      Queue & queue = *queues_[(index + i) % queues_.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty())
+      {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        stealsCount_++;
+      }
+    }
+
+    if (!task)
+    {
+      return false;
+    }
+
+    queuedCount_--;
+    task();
+
+    return true;
+  }
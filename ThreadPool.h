@@ -0,0 +1,112 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/** @file
+* @brief Work stealing thread pool
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* @brief The ThreadPool class
+* @details A fixed set of worker threads, each with its own queue of tasks. A thread takes its tasks from the back of its
+* queue and, when it is empty, steals from the front of the other queues, so that the threads which finish early help the
+* others. The thread calling parallelFor() works as well until all its chunks are done, so a pool of N threads starts
+* N - 1 workers.
+*/
+class ThreadPool
+{
+public:
+  /**
+  * @brief The body of a parallel loop
+  * @details Called with the range [begin, end) of a chunk and the index of the chunk
+  */
+  typedef std::function<void(unsigned long begin, unsigned long end, unsigned long chunk)> Body;
+
+  /**
+  * @brief Starts the workers
+  * @param threadsCount The number of threads working on a loop, the calling thread included. 0 means 1 per core
+  */
+  explicit ThreadPool(unsigned int threadsCount = 0);
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const &) = delete;
+  ThreadPool & operator=(ThreadPool const &) = delete;
+
+  /**
+  * @brief Runs the body over [0, count) split in chunks, in parallel, and returns when all the chunks are done
+  * @details The chunks only depend on count and chunkSize, never on the number of threads, so a body whose result only
+  * depends on its chunk (e.g. a random generator seeded with the chunk index) gives the same result with any number of
+  * threads. The chunks are spread over the queues in turn and the idle threads steal them.
+  * @param count The number of elements
+  * @param chunkSize The number of elements of a chunk, the last one can be smaller
+  * @param body The body, called once per chunk, possibly concurrently
+  */
+  void parallelFor(unsigned long count, unsigned long chunkSize, Body const & body);
+
+  /**
+  * @brief Gives the number of threads working on a loop, the calling thread included
+  */
+  unsigned int threadsCount() const;
+
+  /**
+  * @brief Gives the number of tasks run by another thread than the one they were queued to, since the start
+  */
+  unsigned long stealsCount() const;
+
+private:
+  /**
+  * @brief The tasks queued to a thread
+  */
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  /**
+  * @brief The loop of a worker thread
+  * @param index The index of its queue
+  */
+  void work(unsigned int index);
+
+  /**
+  * @brief Runs 1 task, from the back of the given queue or else stolen from the front of another queue
+  * @param index The index of the queue of the calling thread
+  * @return false if all the queues were empty
+  */
+  bool runTask(unsigned int index);
+
+  /**
+  * @brief The queues, 1 per worker and the last one for the threads calling parallelFor()
+  */
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  std::vector<std::thread> workers_;
+
+  /**
+  * @brief The number of tasks in all the queues, the workers sleep when it is 0
+  */
+  std::atomic<unsigned long> queuedCount_;
+
+  std::atomic<unsigned long> stealsCount_;
+
+  /**
+  * @brief Guards the sleep of the workers
+  */
+  std::mutex sleepMutex_;
+  std::condition_variable wakeUp_;
+  bool stop_;
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,132 @@
+/** @file
+* @brief Conversion of a CSV star catalog to the binary format
+* @author Philippe Gaultier
+* @version 1.0
+* @date 17/10/26
+* @details Usage: catalog_convert input.csv output.bin [--threads=T]
+* Parses the CSV catalog, writes it in the binary format of StarCatalog, sorted in Morton order, then loads the binary
+* catalog back to check it against the CSV one, star by star, and prints the time of each stage: the binary catalog is what Simulation --catalog should be
+* given, the CSV parsing being the largest part of the loading.
+*/
+
+#include "StarCatalog.h"
+#include "ThreadPool.h"
+#include "Include/Octree/morton.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  double secondsSince(Clock::time_point start)
+  {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  /**
+  * @brief Compares the binary catalog with the CSV one it was written from
+  * @details The stars of the CSV catalog are taken in Morton order, as writeBinary() sorts them. The positions must be
+  * the same and the magnitudes within the rounding of writeBinary() to a half float, at most half a step of its 11
+  * significant bits, i.e. 2^-11 relative to the magnitude, or absolute below 1
+  * @return Whether the catalogs match
+  */
+  bool matches(StarCatalog const & catalog, StarCatalog const & binary)
+  {
+    Stars const & stars = catalog.stars();
+    Stars const & binaryStars = binary.stars();
+    if (binaryStars.size() != stars.size() || binary.min() != catalog.min() || binary.max() != catalog.max())
+    {
+      return false;
+    }
+
+    std::vector<std::tuple<int, int, int>> cells(stars.size());
+    for (unsigned long i=0; i < stars.size(); i++)
+    {
+      glm::ivec3 c = catalog.cell(glm::vec3(stars.x[i], stars.y[i], stars.z[i]), StarCatalog::gridBits);
+      cells[i] = std::make_tuple(c.x, c.y, c.z);
+    }
+    const std::vector<Morton::Entry> entries = Morton::sortPoints(cells.begin(), cells.end());
+
+    for (unsigned long i=0; i < stars.size(); i++)
+    {
+      unsigned long star = entries[i].index;
+      if (binaryStars.x[i] != stars.x[star] || binaryStars.y[i] != stars.y[star] || binaryStars.z[i] != stars.z[star]
+      || std::fabs(binaryStars.magnitude[i] - stars.magnitude[star])
+      > std::max(std::fabs(stars.magnitude[star]), 1.0f) / 2048)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> files;
+  unsigned threadsCount = 0;
+
+  for (int i=1; i < argc; i++)
+  {
+    if (std::strncmp(argv[i], "--threads=", 10) == 0)
+    {
+      threadsCount = std::strtoul(argv[i] + 10, nullptr, 10);
+    }
+    else
+    {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if (files.size() != 2)
+  {
+    std::fprintf(stderr, "Usage: %s input.csv output.bin [--threads=T]\n", argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    ThreadPool threadPool(threadsCount);
+
+    auto start = Clock::now();
+    StarCatalog catalog(files[0], threadPool);
+    double readTime = secondsSince(start);
+    std::printf("%s: %lu stars, %lu of %lu rows skipped, %.1f MB read in %.1f ms (%.1f MB/s on %u threads)\n",
+    files[0].c_str(), catalog.stars().size(), catalog.skippedRowsCount(), catalog.rowsCount(), catalog.fileBytes() / 1e6,
+    1e3 * readTime, catalog.fileBytes() / 1e6 / readTime, threadPool.threadsCount());
+
+    start = Clock::now();
+    catalog.writeBinary(files[1]);
+    double writeTime = secondsSince(start);
+
+    start = Clock::now();
+    StarCatalog binary(files[1], threadPool);
+    double loadTime = secondsSince(start);
+    std::printf("%s: %.1f MB written in %.1f ms, loaded in %.1f ms (%.1f times faster)\n", files[1].c_str(),
+    binary.fileBytes() / 1e6, 1e3 * writeTime, 1e3 * loadTime, readTime / loadTime);
+
+    if (!matches(catalog, binary))
+    {
+      std::fprintf(stderr, "%s: the binary catalog does not match\n", files[1].c_str());
+      return 1;
+    }
+  }
+  catch (std::exception & e)
+  {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+
+  return 0;
+}
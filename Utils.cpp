@@ -1,5 +1,6 @@
 #include "Utils.h"
 #include "spdlog/include/spdlog/spdlog.h"
+#include "Log.h"
 
 #include <iostream>
 #include <fstream>
@@ -79,11 +80,11 @@ namespace Utils
 
     if (phi != res)
     {
-      spdlog::get("console")->debug() << "Clamped the angle from " << phi << " to " << res;
+      LOG_DEBUG("Clamped the angle from " << phi << " to " << res);
     }
     else
     {
-      spdlog::get("console")->debug() << "No need to clamp the angle";
+      LOG_DEBUG("No need to clamp the angle");
     }
 
     return res;
@@ -109,6 +110,21 @@ namespace Utils
     return res;
   }
 
+  void frustumPlanes(glm::mat4 const & projectionModelview, float planes[6][4])
+  {
+    //GLM matrices are column major: m[column][row]
+    glm::mat4 const & m = projectionModelview;
+
+    for (int i=0; i<3; i++)
+    {
+      for (int j=0; j<4; j++)
+      {
+        planes[2 * i][j] = m[j][3] + m[j][i];
+        planes[2 * i + 1][j] = m[j][3] - m[j][i];
+      }
+    }
+  }
+
   std::string toString(glm::vec3 const & vec)
   {
     return "(" + std::to_string(vec.x) + ", " + std::to_string(vec.y) + ", " + std::to_string(vec.z) + ")";
@@ -148,12 +164,12 @@ namespace Utils
 
     if (oldVec != vecToClamp)
     {
-      spdlog::get("console")->debug() << "Clamped the vec3 from " << Utils::toString(oldVec)
-      << " to " << Utils::toString(vecToClamp);
+      LOG_DEBUG("Clamped the vec3 from " << Utils::toString(oldVec)
+      << " to " << Utils::toString(vecToClamp));
     }
     else
     {
-      spdlog::get("console")->debug() << "No need to clamp the vector";
+      LOG_DEBUG("No need to clamp the vector");
     }
   }
 }
@@ -85,6 +85,15 @@ namespace Utils
   */
   glm::mat4 ovr2glmMat(OVR::Matrix4f const & mat);
 
+  /**
+  * @brief Extracts the 6 planes of the view frustum from the projection x modelview matrix
+  * The planes are given as (a, b, c, d) in world coordinates, the visible points being those where
+  * a*x + b*y + c*z + d >= 0, in the order left, right, bottom, top, near, far
+  * @param projectionModelview The product of the projection matrix by the modelview matrix
+  * @param planes The 6 planes
+  */
+  void frustumPlanes(glm::mat4 const & projectionModelview, float planes[6][4]);
+
   /**
   * @brief Converts a 3 dimensional vector to a pretty string
   * ready to be printed
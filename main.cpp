@@ -1,5 +1,6 @@
 #include "spdlog/include/spdlog/spdlog.h"
 #include "Scene.h"
+#include "Profiler.h"
 
 #include <boost/program_options.hpp>
 namespace po = boost::program_options;
@@ -26,6 +27,18 @@ int main(int argc, char** argv)
     ("size,s", po::value<int>()->default_value(128), "Set the size of the data cube. Must be a power of 2")
     ("octantSize", po::value<int>()->default_value(8), "Set the size of an octant. Must be a power of 2")
     ("octantDrawnCount,d", po::value<int>()->default_value(2), "Set the number of octant drawn count. 1 to only draw the octant the camera is currently in, 2 to draw the immediate neighbors, ...")
+    ("gravity,g", "Move the objects under their mutual gravity, computed with the Barnes-Hut algorithm")
+    ("theta", po::value<float>()->default_value(0.5), "Set the opening angle of the Barnes-Hut algorithm: 0 is exact, larger is faster and less accurate")
+    ("direct", "Compute the gravity exactly by direct summation, in O(N^2), instead of Barnes-Hut: for up to about 20000 objects")
+    ("catalog", po::value<std::string>()->default_value(""), "Load the stars of a catalog instead of generating random objects: a CSV file with ra and dec in degrees, parallax in mas and optionally a magnitude (e.g. phot_g_mean_mag), or a binary catalog written by catalog_convert, much faster to load. The brightest star of each cell is kept")
+#ifdef SIMULATION_PROFILING
+    ("trace", po::value<std::string>(), "Write the timings of the frame stages to the given file, in the Chrome trace event format")
+#endif
+#ifdef SIMULATION_HEADLESS
+    ("headless", "Headless benchmark mode: renders offscreen along a scripted camera path")
+    ("frames", po::value<unsigned long>()->default_value(1000), "Set the number of frames rendered in headless mode")
+    ("stats", po::value<std::string>()->default_value("stats.json"), "Set the file the headless frame time statistics are written to")
+#endif
     ;
 
     po::variables_map vm;
@@ -40,16 +53,40 @@ int main(int argc, char** argv)
 
     if (vm.count("verbose")) spdlog::set_level(spdlog::level::debug);
 
+    if (vm.count("trace")) Profiler::enable(vm["trace"].as<std::string>());
+
+    bool headless = vm.count("headless");
+    if (headless && vm.count("oculus"))
+    {
+      throw std::invalid_argument("The Oculus mode is not available in headless mode");
+    }
+
     Scene scene("Simulation", WINDOW_WIDTH, WINDOW_HEIGHT,
     vm.count("oculus"),
     vm.count("fullscreen"),
+    headless,
     vm["texture"].as<std::string>(),
     vm["number"].as<unsigned long>(),
     vm["size"].as<int>(),
     vm["octantSize"].as<int>(),
-    vm["octantDrawnCount"].as<int>()
+    vm["octantDrawnCount"].as<int>(),
+    vm.count("gravity"),
+    vm["theta"].as<float>(),
+    vm.count("direct"),
+    vm["catalog"].as<std::string>()
     );
+
+#ifdef SIMULATION_HEADLESS
+    if (headless)
+    {
+      scene.benchmarkLoop(vm["frames"].as<unsigned long>(), vm["stats"].as<std::string>());
+      Profiler::writeTrace();
+      return 0;
+    }
+#endif
+
     scene.mainLoop();
+    Profiler::writeTrace();
   }
   catch (exception& e) {
     spdlog::get("console")->error() << e.what();